@@ -0,0 +1 @@
+const masterspools = [ { id: 'bambu_grey', label: 'BambuLab Grey', weight: 210, image: 'img/bambu_grey.png' }, { id: 'bambu_transp', label: 'BambuLab Transparent', weight: 215, image: 'img/bambu_transp.png' }, { id: 'r3d_grey', label: 'R3D Grey', weight: 239, image: 'img/r3d_grey.png' }, { id: 'custom', label: 'Custom', weight: 0, image: 'img/custom.png' } ]; const translations = { fr: { waiting: 'Attente du TigerTag...', quickActions: 'Actions rapides', tare: 'TARE', apiKey: 'Clé API', user: 'Utilisateur', newApiKey: 'Nouvelle clé API', update: 'Mettre à jour', delete: 'Supprimer', calibration: 'Calibration Magique', currentFactor: 'Facteur actuel', autoCalc: 'Calcul automatique', knownWeight: 'Poids connu (g)', compute: 'Calculer', manual: 'Manuel', newFactor: 'Nouveau facteur', apply: 'Appliquer', advanced: 'Avancé', reconfigWifi: 'Reconfigurer Wi‑Fi', factoryReset: 'Réinitialisation', uptime: 'Durée de fonctionnement', liveChart: 'Graphique temps réel', streamRate: 'Débit', streamStart: 'Démarrer', streamStop: 'Arrêter', step1Title: 'Step 1', step1Instruction: 'Laissez la balance vide puis appuyez sur le bouton', step1Button: 'GO →', step2Title: 'Step 2', step2Instruction: 'Sélectionnez votre Masterspool vide et placez-la sur la balance', selectMasterspool: 'Sélectionnez votre Masterspool', step2Button: 'Calibrer ✓', step3Title: 'Calibré !', step3Instruction: 'La balance est maintenant calibrée', currentReading: 'Lecture actuelle', calibKnownWeight: 'Poids réel (g)', newFactor: 'Nouveau facteur', back: '← Retour', calibAgain: 'Restart', manualCalib: 'Calibration manuelle', cloud: 'Cloud', offline: 'Hors ligne', validated: 'Validé', invalid: 'Invalide', notConfigured: 'Non configuré', configureApiKey: 'Configurer la clé API', apiKeyInvalid: 'Clé API invalide', alertEnterKey: 'Veuillez saisir une clé API', alertUpdateError: 'Erreur lors de la mise à jour', alertDeleteConfirm: 'Supprimer la clé API ?', alertDeleteError: 'Erreur lors de la suppression', alertInvalidFactor: 'Facteur invalide', alertNegativeFactor: '⚠️ Le coefficient doit être positif', alertError: 'Erreur', alertInvalidWeight: 'Poids connu invalide', alertDataUnavailable: 'Données non disponibles', alertWeightTooLight: '⚠️ Poids trop léger (min. 200g)\nVérifiez que le filament est bien sur la balance.', errorWeightRequired: '⚠️ Veuillez entrer un poids valide (min. 200g)', modalWeightTooLightTitle: 'Poids insuffisant', modalWeightTooLightMessage: 'Le poids est trop léger pour une calibration. Utilisez une Masterspool ou un filament d\'au moins 200g.', modalWeightInvalidTitle: 'Poids invalide', modalWeightInvalidMessage: 'Veuillez entrer un poids valide', modalOk: 'OK', alertReconfigConfirm: 'Reconfigurer le Wi‑Fi ? L\'appareil redémarrera.', alertResetConfirm: '⚠️ ATTENTION : Cette action effacera toutes les données. Continuer ?', sending: '⏳ Envoi...', sent: '✓ Envoyé', sendError: '✗ Erreur', sendIn: 'Envoi dans' }, en: { waiting: 'Waiting TigerTag...', quickActions: 'Quick Actions', tare: 'TARE', apiKey: 'API Key', user: 'User', newApiKey: 'New API Key', update: 'Update', delete: 'Delete', calibration: 'Wizard Calibration', currentFactor: 'Current factor', autoCalc: 'Auto calculation', knownWeight: 'Known weight (g)', compute: 'Compute', manual: 'Manual', newFactor: 'New factor', apply: 'Apply', advanced: 'Advanced', reconfigWifi: 'Reconfigure Wi‑Fi', factoryReset: 'Factory Reset', uptime: 'Uptime', liveChart: 'Live chart', streamRate: 'Rate', streamStart: 'Start', streamStop: 'Stop', step1Title: 'Step 1', step1Instruction: 'Leave the scale empty then press the button', step1Button: 'GO →', step2Title: 'Step 2', step2Instruction: 'Select your empty Masterspool and place it on the scale', selectMasterspool: 'Select your Masterspool', step2Button: 'Calibrate ✓', step3Title: 'Calibrated!', step3Instruction: 'The scale is now calibrated', currentReading: 'Current reading', calibKnownWeight: 'Real weight (g)', newFactor: 'New factor', back: '← Back', calibAgain: 'Restart', manualCalib: 'Manual calibration', cloud: 'Cloud', offline: 'Offline', validated: 'Validated', invalid: 'Invalid', notConfigured: 'Not configured', configureApiKey: 'Setup API Key', apiKeyInvalid: 'Invalid API Key', alertEnterKey: 'Please enter an API key', alertUpdateError: 'Update error', alertDeleteConfirm: 'Delete API key?', alertDeleteError: 'Delete error', alertInvalidFactor: 'Invalid factor', alertNegativeFactor: '⚠️ Coefficient must be positive', alertError: 'Error', alertInvalidWeight: 'Invalid known weight', alertDataUnavailable: 'Data unavailable', alertWeightTooLight: '⚠️ Weight too light (min. 200g)\nCheck that the filament is on the scale.', errorWeightRequired: '⚠️ Please enter a valid weight (min. 200g)', modalWeightTooLightTitle: 'Insufficient weight', modalWeightTooLightMessage: 'The weight is too light for calibration. Use a Masterspool or filament of at least 200g.', modalWeightInvalidTitle: 'Invalid weight', modalWeightInvalidMessage: 'Please enter a valid weight', modalOk: 'OK', alertReconfigConfirm: 'Reconfigure Wi‑Fi? Device will restart.', alertResetConfirm: '⚠️ WARNING: This will erase all data. Continue?', sending: '⏳ Sending...', sent: '✓ Sent', sendError: '✗ Error', sendIn: 'Sending in' } }; let currentLang = localStorage.getItem('tigertag_lang') || 'en'; function t(key) { return translations[currentLang][key] || key; } function setLanguage(lang) { currentLang = lang; localStorage.setItem('tigertag_lang', lang); document.documentElement.lang = lang; document.querySelectorAll('.lang-btn').forEach(btn => { btn.classList.toggle('active', btn.dataset.lang === lang); }); document.querySelectorAll('[data-i18n]').forEach(el => { const key = el.dataset.i18n; el.textContent = t(key); }); document.querySelectorAll('[data-i18n-placeholder]').forEach(el => { const key = el.dataset.i18nPlaceholder; el.placeholder = t(key); }); updateCloudText(); updateApiText(); } const cloudDot = document.getElementById('cloudDot'); const cloudText = document.getElementById('cloudText'); const apiDot = document.getElementById('apiDot'); const apiText = document.getElementById('apiText'); const weightEl = document.getElementById('weight'); const uidEl = document.getElementById('uid'); const calFactorEl = document.getElementById('calFactor'); const userDisplayEl = document.getElementById('userDisplay'); const sendStateEl = document.getElementById('sendState'); const userNameEl = document.getElementById('userName'); let currentWeight = null; let currentUid = null; let calFactor = null; let apiKey = ''; let apiValid = false; let apiDisplayName = ''; let cloudStatus = 'unknown'; let apiStatus = 'none'; function setTextIfChanged(el, txt) { if (!el || el.textContent === txt) return; el.textContent = txt; } function toggleSection(el) { el.classList.toggle('active'); const content = el.nextElementSibling; content.classList.toggle('active'); } function updateCloudText() { const txt = cloudStatus === 'up' || cloudStatus === 'ok' ? t('cloud') : t('offline'); setTextIfChanged(cloudText, txt); } function updateApiText() { let txt = t('user') + ': '; if (apiStatus === 'valid') { txt = userDisplayEl.textContent; } else if (apiStatus === 'invalid') { txt += t('invalid'); } else { txt += t('notConfigured'); } setTextIfChanged(userDisplayEl, txt.replace(t('user') + ': ', '')); } function setCloudStatus(state) { const s = String(state || '').toLowerCase(); cloudStatus = (s === 'up' || s === 'ok') ? 'up' : 'down'; updateCloudText(); if (cloudStatus === 'up') { cloudDot.className = 'status-dot active'; } else { cloudDot.className = 'status-dot error'; } } function setApiStatus(state, displayName) { apiStatus = state; const name = displayName ? displayName.trim() : ''; if (state === 'valid') { apiDot.className = 'status-dot active'; setTextIfChanged(userDisplayEl, name || t('validated')); if (name && userNameEl) { setTextIfChanged(userNameEl, name); userNameEl.classList.remove('hidden'); userNameEl.style.color = 'rgba(255,255,255,0.9)'; userNameEl.style.background = 'transparent'; } } else if (state === 'invalid') { apiDot.className = 'status-dot error'; setTextIfChanged(userDisplayEl, t('invalid')); if (userNameEl) { setTextIfChanged(userNameEl, '⚠️ ' + t('apiKeyInvalid')); userNameEl.classList.remove('hidden'); userNameEl.style.color = '#fff'; userNameEl.style.background = 'rgba(245,101,101,0.3)'; } } else { apiDot.className = 'status-dot warning'; setTextIfChanged(userDisplayEl, t('notConfigured')); if (userNameEl) { setTextIfChanged(userNameEl, '🚨 ' + t('configureApiKey')); userNameEl.classList.remove('hidden'); userNameEl.style.color = '#fff'; userNameEl.style.background = 'rgba(237,137,54,0.3)'; } } } function setSendState(msg, color) { if (!msg) { sendStateEl.classList.add('hidden'); return; } setTextIfChanged(sendStateEl, msg); if (color) sendStateEl.style.background = color; sendStateEl.classList.remove('hidden'); } function formatHMS(secs) { if (!isFinite(secs)) return '--:--:--'; const h = Math.floor(secs / 3600); const m = Math.floor((secs % 3600) / 60); const s = Math.floor(secs % 60); return [h,m,s].map(x => String(x).padStart(2,'0')).join(':'); } function updateApiKey() { const input = document.getElementById('newApiKey'); const key = (input.value || '').trim(); if (!key) { alert(t('alertEnterKey')); return; } const btns = document.querySelectorAll('button[onclick="updateApiKey()"]'); btns.forEach(b => { b.disabled = true; b.textContent = t('update') + '…'; }); fetch('/api/apikey', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify({ key: key }) }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .then(res => waitForJob(res.job)) .then(res => { const ok = !!res.ok; const name = (res.detail || '').trim(); if (ok) { apiKey = key; setApiStatus('valid', name); } else { setApiStatus('invalid'); alert(t('alertUpdateError')); } }) .catch(() => { setApiStatus('invalid'); alert(t('alertUpdateError')); }) .finally(() => btns.forEach(b => { b.disabled = false; b.textContent = t('update'); })); } function deleteApiKey() { if (!confirm(t('alertDeleteConfirm'))) return; const delBtn = document.querySelector('button.danger[onclick="deleteApiKey()"]'); if (delBtn) { delBtn.disabled = true; delBtn.textContent = t('delete') + '…'; } fetch('/apikeydelete', { method: 'GET', cache: 'no-store' }) .then(async r => { if (!r.ok) throw new Error('http ' + r.status); const raw = await r.text(); let ok = raw && raw.trim().toLowerCase() === 'ok'; if (!ok) { try { const j = JSON.parse(raw); ok = !!j.success; } catch(_) {} } return ok; }) .then(ok => { if (ok) { apiKey = ''; const input = document.getElementById('newApiKey'); if (input) input.value = ''; setApiStatus('none'); } else { alert(t('alertDeleteError')); } }) .catch(() => alert(t('alertDeleteError'))) .finally(() => { if (delBtn) { delBtn.disabled = false; delBtn.textContent = t('delete'); } }); } const pendingJobs = new Map(); const finishedJobs = new Map(); function settleJob(msg) { if (msg.state !== 'done' && msg.state !== 'failed') return; const job = pendingJobs.get(msg.id); if (!job) { finishedJobs.set(msg.id, msg); if (finishedJobs.size > 8) finishedJobs.delete(finishedJobs.keys().next().value); return; } pendingJobs.delete(msg.id); clearInterval(job.poll); clearTimeout(job.timer); job.resolve(msg); } function waitForJob(id) { if (!id) return Promise.reject('no job'); if (finishedJobs.has(id)) { const msg = finishedJobs.get(id); finishedJobs.delete(id); return Promise.resolve(msg); } return new Promise((resolve, reject) => { const job = { resolve }; job.poll = setInterval(() => { if (statusSocket && statusSocket.readyState === WebSocket.OPEN) return; fetch('/api/job?id=' + id, { cache: 'no-store' }) .then(r => r.ok ? r.json() : null) .then(msg => { if (msg) settleJob(msg); }) .catch(() => {}); }, 1000); job.timer = setTimeout(() => { pendingJobs.delete(id); clearInterval(job.poll); reject('timeout'); }, 20000); pendingJobs.set(id, job); }); } function toggleApiKeyVisibility() { const input = document.getElementById('newApiKey'); const icon = document.getElementById('eyeIcon'); if (!input || !icon) return; if (input.type === 'password') { input.type = 'text'; icon.src = 'img/visibility.svg'; } else { input.type = 'password'; icon.src = 'img/visibility_off.svg'; } } function tareScale() { fetch('/api/tare', { method: 'POST' }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .catch(() => {}); } let tareTimer = null; let tareBtn = null; function startTare() { if (!tareBtn) tareBtn = document.getElementById('tareBtn'); tareBtn.classList.add('holding'); tareTimer = setTimeout(() => { tareScale(); tareBtn.classList.remove('holding'); tareBtn.classList.add('success'); setTimeout(() => { tareBtn.classList.remove('success'); const progress = tareBtn.querySelector('.tare-progress'); if (progress) progress.style.width = '0'; }, 500); }, 1000); } function cancelTare() { if (!tareBtn) tareBtn = document.getElementById('tareBtn'); if (tareTimer) { clearTimeout(tareTimer); tareTimer = null; } tareBtn.classList.remove('holding'); const progress = tareBtn.querySelector('.tare-progress'); if (progress) { progress.style.width = '0'; } } let tareBtnCalib = null; let tareTimerCalib = null; function startTareCalib() { if (!tareBtnCalib) tareBtnCalib = document.getElementById('tareBtnCalib'); tareBtnCalib.classList.add('holding'); tareTimerCalib = setTimeout(() => { tareScale(); tareBtnCalib.classList.remove('holding'); tareBtnCalib.classList.add('success'); setTimeout(() => { tareBtnCalib.classList.remove('success'); const progress = tareBtnCalib.querySelector('.tare-progress'); if (progress) progress.style.width = '0'; }, 500); }, 1000); } function cancelTareCalib() { if (!tareBtnCalib) tareBtnCalib = document.getElementById('tareBtnCalib'); if (tareTimerCalib) { clearTimeout(tareTimerCalib); tareTimerCalib = null; } tareBtnCalib.classList.remove('holding'); const progress = tareBtnCalib.querySelector('.tare-progress'); if (progress) { progress.style.width = '0'; } } function updateCalibration() { const factor = parseFloat(document.getElementById('newCalFactor').value); if (isNaN(factor)) { alert(t('alertInvalidFactor')); return; } if (factor <= 0) { alert(t('alertNegativeFactor')); return; } fetch('/api/calibration', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify({ value: factor }) }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .catch(() => alert(t('alertError'))); } function computeFactor() { const known = parseFloat(document.getElementById('knownWeight').value); if (isNaN(known) || known <= 0) { alert(t('alertInvalidWeight')); return; } if (currentWeight === null || calFactor === null) { alert(t('alertDataUnavailable')); return; } const newFactor = calFactor * (currentWeight / known); document.getElementById('newCalFactor').value = newFactor.toFixed(3); fetch('/api/calibration', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify({ value: newFactor }) }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .catch(() => alert(t('alertError'))); } function resetWiFi() { if (!confirm(t('alertReconfigConfirm'))) return; fetch('/api/reset-wifi', { method: 'POST' }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .catch(() => {}); } function factoryReset() { if (!confirm(t('alertResetConfirm'))) return; fetch('/api/factory-reset', { method: 'POST' }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .catch(() => {}); } function populateMasterspoolSelect() { const select = document.getElementById('masterspoolSelect'); if (!select) return; select.innerHTML = ''; masterspools.forEach(spool => { const option = document.createElement('option'); option.value = spool.id; option.textContent = spool.label; select.appendChild(option); }); onMasterspoolChange(); } function onMasterspoolChange() { const select = document.getElementById('masterspoolSelect'); const customInput = document.getElementById('calibKnownWeight'); const img = document.getElementById('masterspoolImg'); const errorMsg = document.getElementById('calibWeightError'); if (!select) return; const selectedId = select.value; const selectedSpool = masterspools.find(s => s.id === selectedId); if (!selectedSpool) return; if (customInput) customInput.classList.remove('error'); if (errorMsg) errorMsg.style.display = 'none'; if (selectedId === 'custom') { customInput.style.display = 'block'; customInput.value = ''; customInput.focus(); customInput.oninput = function() { if (this.classList.contains('error')) { this.classList.remove('error'); if (errorMsg) errorMsg.style.display = 'none'; } }; } else { customInput.style.display = 'none'; customInput.value = selectedSpool.weight; } if (selectedSpool.image && img) { img.src = selectedSpool.image; img.style.display = 'block'; img.onerror = function() { this.style.display = 'none'; }; } } function updateProgressDots(activeStep) { document.querySelectorAll('.progress-dots .dot').forEach((dot, index) => { const step = index + 1; dot.classList.remove('active', 'completed'); if (step === activeStep) { dot.classList.add('active'); } else if (step < activeStep) { dot.classList.add('completed'); } }); } function calibStep1() { fetch('/api/tare', { method: 'POST' }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .then(() => { document.getElementById('step1').classList.remove('active'); document.getElementById('step2').classList.add('active'); updateProgressDots(2); populateMasterspoolSelect(); }) .catch(() => alert(t('alertError'))); } function calibStep2() { const knownWeight = parseFloat(document.getElementById('calibKnownWeight').value); if (isNaN(knownWeight) || knownWeight <= 0) { showWeightInvalidModal(); return; } if (knownWeight < 200) { showWeightErrorModal(); return; } if (currentWeight === null || calFactor === null) { alert(t('alertDataUnavailable')); return; } const newFactor = calFactor * (currentWeight / knownWeight); if (newFactor <= 0) { alert(t('alertNegativeFactor')); return; } fetch('/api/calibration', { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify({ value: newFactor }) }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .then(() => { document.getElementById('step2').classList.remove('active'); document.getElementById('step3').classList.add('active'); updateProgressDots(3); }) .catch(() => alert(t('alertError'))); } function calibBack(step) { document.getElementById('step2').classList.remove('active'); document.getElementById('step' + step).classList.add('active'); updateProgressDots(step); document.getElementById('calibKnownWeight').value = ''; } function calibReset() { document.getElementById('step3').classList.remove('active'); document.getElementById('step1').classList.add('active'); updateProgressDots(1); document.getElementById('calibKnownWeight').value = ''; } function showWeightErrorModal() { const modal = document.getElementById('weightErrorModal'); if (modal) { modal.classList.add('show'); } } function closeWeightErrorModal() { const modal = document.getElementById('weightErrorModal'); if (modal) { modal.classList.remove('show'); } } function showWeightInvalidModal() { const modal = document.getElementById('weightInvalidModal'); if (modal) { modal.classList.add('show'); } } function closeWeightInvalidModal() { const modal = document.getElementById('weightInvalidModal'); if (modal) { modal.classList.remove('show'); } } document.addEventListener('DOMContentLoaded', function() { const errorModal = document.getElementById('weightErrorModal'); const invalidModal = document.getElementById('weightInvalidModal'); if (errorModal) { errorModal.addEventListener('click', function(e) { if (e.target === errorModal) { closeWeightErrorModal(); } }); } if (invalidModal) { invalidModal.addEventListener('click', function(e) { if (e.target === invalidModal) { closeWeightInvalidModal(); } }); } }); let uptimeBaseSecs = null; let uptimeBaseAt = 0; function tickUptime() { if (uptimeBaseSecs === null) return; const secs = uptimeBaseSecs + (Date.now() - uptimeBaseAt) / 1000; setTextIfChanged(document.getElementById('uptime'), formatHMS(secs)); } function applyStatusSnapshot(s) { if (!s || typeof s !== 'object') return; if (typeof s.weight !== 'undefined' && currentWeight !== s.weight) { currentWeight = s.weight; setTextIfChanged(weightEl, String(s.weight)); } if (typeof s.uid !== 'undefined') { const u = s.uid || ''; if (currentUid !== u) { currentUid = u; setTextIfChanged(uidEl, u || t('waiting')); } } if (typeof s.cloud !== 'undefined') { setCloudStatus(s.cloud); } const apiInput = document.getElementById('newApiKey'); if (typeof s.apiKey === 'string' && apiKey !== s.apiKey) { apiKey = s.apiKey; if (apiInput && apiInput.value !== apiKey) apiInput.value = apiKey; } if (typeof s.apiKey === 'string' || typeof s.apiValid !== 'undefined' || typeof s.displayName === 'string') { if (typeof s.apiValid !== 'undefined') apiValid = !!s.apiValid; if (typeof s.displayName === 'string') apiDisplayName = s.displayName; const hasKey = apiKey.trim().length > 0; const state = hasKey ? (apiValid ? 'valid' : 'invalid') : 'none'; setApiStatus(state, apiDisplayName); } if (typeof s.calibrationFactor !== 'undefined') { const n = Number(s.calibrationFactor); const shown = isFinite(n) ? n.toFixed(2) : '—'; setTextIfChanged(calFactorEl, shown); calFactor = n; } if (typeof s.uptime_s !== 'undefined' || typeof s.uptime_ms !== 'undefined') { let secs = (typeof s.uptime_s !== 'undefined') ? Number(s.uptime_s) : Number(s.uptime_ms) / 1000; uptimeBaseSecs = secs; uptimeBaseAt = Date.now(); tickUptime(); } if (typeof s.sendToCloud !== 'undefined') { const v = String(s.sendToCloud || '').trim(); if (v === '' || v === '0') { setSendState(''); } else if (v === 'send') { setSendState(t('sending'), 'rgba(255,255,255,0.2)'); } else if (v === 'success') { setSendState(t('sent'), 'rgba(72,187,120,0.3)'); setTimeout(() => setSendState(''), 1500); } else if (v === 'error') { setSendState(t('sendError'), 'rgba(245,101,101,0.3)'); setTimeout(() => setSendState(''), 2000); } else if (/^\d+$/.test(v)) { setSendState(t('sendIn') + ' ' + v + 's', 'rgba(255,255,255,0.2)'); } } } function pollStatus() { fetch('/api/status', { cache: 'no-store' }) .then(r => r.ok ? r.json() : Promise.reject(r.status)) .then(s => applyStatusSnapshot(s)) .catch(() => {}); } let statusSocket = null; let pollTimer = null; let wsRetryMs = 1000; function startPolling() { if (pollTimer) return; pollStatus(); pollTimer = setInterval(pollStatus, 1000); } function stopPolling() { if (!pollTimer) return; clearInterval(pollTimer); pollTimer = null; } function handleSocketMessage(ev) { let msg; try { msg = JSON.parse(ev.data); } catch (_) { return; } if (!msg || typeof msg !== 'object') return; if (msg.type === 'apiStatus') { applyStatusSnapshot({ apiValid: !!msg.valid, displayName: msg.displayName || apiDisplayName }); return; } if (msg.type === 'job') { settleJob(msg); return; } if (msg.type) return; applyStatusSnapshot(msg); } function connectStatusSocket() { if (!('WebSocket' in window)) { startPolling(); return; } const proto = location.protocol === 'https:' ? 'wss://' : 'ws://'; let sock; try { sock = new WebSocket(proto + location.host + '/ws'); } catch (_) { startPolling(); return; } statusSocket = sock; const openTimeout = setTimeout(startPolling, 3000); sock.onopen = () => { clearTimeout(openTimeout); wsRetryMs = 1000; stopPolling(); }; sock.onmessage = handleSocketMessage; sock.onclose = () => { clearTimeout(openTimeout); if (statusSocket === sock) statusSocket = null; startPolling(); setTimeout(connectStatusSocket, wsRetryMs); wsRetryMs = Math.min(wsRetryMs * 2, 30000); }; sock.onerror = () => sock.close(); } const CHART_WINDOW_US = 10e6; const CHART_CAPACITY = 2048; const STREAM_FLAG_GAP = 8; const chartT = new Uint32Array(CHART_CAPACITY); const chartW = new Float32Array(CHART_CAPACITY); const chartF = new Uint8Array(CHART_CAPACITY); let chartHead = 0; let chartLen = 0; let chartDirty = false; let streamSocket = null; let streamExpectSeq = null; let streamFrames = 0; let streamSamples = 0; let streamRateAt = 0; function onStreamFrame(ev) { if (!(ev.data instanceof ArrayBuffer) || ev.data.byteLength < 8) return; const dv = new DataView(ev.data); if (dv.getUint8(0) !== 1) return; const count = dv.getUint8(1); const size = dv.getUint16(2, true); const seq = dv.getUint32(4, true); if (size < 13 || 8 + count * size > ev.data.byteLength) return; const lost = streamExpectSeq !== null && seq !== streamExpectSeq; streamExpectSeq = (seq + count) >>> 0; for (let i = 0; i < count; i++) { const o = 8 + i * size; chartT[chartHead] = dv.getUint32(o, true); chartW[chartHead] = dv.getFloat32(o + 8, true); chartF[chartHead] = dv.getUint8(o + 12) | (lost && i === 0 ? STREAM_FLAG_GAP : 0); chartHead = (chartHead + 1) % CHART_CAPACITY; if (chartLen < CHART_CAPACITY) chartLen++; } streamFrames++; streamSamples += count; if (!chartDirty) { chartDirty = true; requestAnimationFrame(drawChart); } } function drawChart() { chartDirty = false; const canvas = document.getElementById('liveChart'); if (!canvas || chartLen === 0) return; const ctx = canvas.getContext('2d'); const w = canvas.width, h = canvas.height; const last = (chartHead + CHART_CAPACITY - 1) % CHART_CAPACITY; const tEnd = chartT[last]; const colMin = new Float32Array(w).fill(Infinity); const colMax = new Float32Array(w).fill(-Infinity); const colGap = new Uint8Array(w); let lo = Infinity, hi = -Infinity; for (let n = 0; n < chartLen; n++) { const i = (last + CHART_CAPACITY - n) % CHART_CAPACITY; const age = (tEnd - chartT[i]) >>> 0; if (age > CHART_WINDOW_US) break; const x = Math.min(w - 1, Math.floor((1 - age / CHART_WINDOW_US) * (w - 1))); const v = chartW[i]; if (v < colMin[x]) colMin[x] = v; if (v > colMax[x]) colMax[x] = v; if (chartF[i] & STREAM_FLAG_GAP) colGap[x] = 1; if (v < lo) lo = v; if (v > hi) hi = v; } if (hi - lo < 2) { const mid = (hi + lo) / 2; lo = mid - 1; hi = mid + 1; } const pad = (hi - lo) * 0.1; lo -= pad; hi += pad; const y = v => h - ((v - lo) / (hi - lo)) * h; ctx.clearRect(0, 0, w, h); ctx.fillStyle = '#fc8181'; for (let x = 0; x < w; x++) if (colGap[x]) ctx.fillRect(x, 0, 1, h); ctx.strokeStyle = '#667eea'; ctx.beginPath(); for (let x = 0; x < w; x++) { if (colMin[x] === Infinity) continue; ctx.moveTo(x + 0.5, y(colMax[x])); ctx.lineTo(x + 0.5, y(colMin[x]) + 1); } ctx.stroke(); ctx.fillStyle = '#718096'; ctx.font = '11px sans-serif'; ctx.fillText(hi.toFixed(1) + ' g', 4, 12); ctx.fillText(lo.toFixed(1) + ' g', 4, h - 4); } function updateStreamRate() { const now = performance.now(); if (!streamSocket) return; const secs = (now - streamRateAt) / 1000; if (secs <= 0) return; setTextIfChanged(document.getElementById('streamRate'), (streamSamples / secs).toFixed(0) + ' Hz · ' + (streamFrames / secs).toFixed(1) + ' fps'); streamFrames = 0; streamSamples = 0; streamRateAt = now; } function setStreamButton(running) { const btn = document.getElementById('streamBtn'); if (!btn) return; btn.dataset.i18n = running ? 'streamStop' : 'streamStart'; btn.textContent = t(btn.dataset.i18n); } function toggleLiveStream() { if (streamSocket) { const sock = streamSocket; streamSocket = null; sock.close(); setStreamButton(false); setTextIfChanged(document.getElementById('streamRate'), '--'); return; } const proto = location.protocol === 'https:' ? 'wss://' : 'ws://'; const sock = new WebSocket(proto + location.host + '/ws/stream'); sock.binaryType = 'arraybuffer'; sock.onmessage = onStreamFrame; sock.onclose = () => { if (streamSocket !== sock) return; streamSocket = null; setStreamButton(false); }; streamSocket = sock; streamExpectSeq = null; streamFrames = 0; streamSamples = 0; streamRateAt = performance.now(); setStreamButton(true); } window.onload = () => { setLanguage(currentLang); setTextIfChanged(weightEl, '…'); connectStatusSocket(); setInterval(tickUptime, 1000); setInterval(updateStreamRate, 1000); if ('serviceWorker' in navigator) { navigator.serviceWorker.register('/sw.js') .then(reg => console.log('Service Worker registered')) .catch(err => console.log('Service Worker registration failed')); } };
\ No newline at end of file
@@ -1,63 +1 @@
-const CACHE_NAME = 'tigertag-scale-v1';
-const urlsToCache = [
-  '/',
-  '/index.html',
-  '/favicon.png',
-  '/favicon.ico',
-  '/manifest.json'
-];
-
-// Install Service Worker
-self.addEventListener('install', event => {
-  event.waitUntil(
-    caches.open(CACHE_NAME)
-      .then(cache => cache.addAll(urlsToCache))
-      .catch(err => console.log('Cache failed:', err))
-  );
-  self.skipWaiting();
-});
-
-// Activate Service Worker
-self.addEventListener('activate', event => {
-  event.waitUntil(
-    caches.keys().then(cacheNames => {
-      return Promise.all(
-        cacheNames.map(cacheName => {
-          if (cacheName !== CACHE_NAME) {
-            return caches.delete(cacheName);
-          }
-        })
-      );
-    })
-  );
-  self.clients.claim();
-});
-
-// Fetch strategy: Network first, fallback to cache
-self.addEventListener('fetch', event => {
-  // Skip API calls - always fetch from network
-  if (event.request.url.includes('/api/') || 
-      event.request.url.includes('/apikeydelete')) {
-    return;
-  }
-  
-  event.respondWith(
-    fetch(event.request)
-      .then(response => {
-        // Clone the response
-        const responseToCache = response.clone();
-        
-        // Cache the fetched response
-        caches.open(CACHE_NAME)
-          .then(cache => {
-            cache.put(event.request, responseToCache);
-          });
-        
-        return response;
-      })
-      .catch(() => {
-        // If network fails, try cache
-        return caches.match(event.request);
-      })
-  );
-});
\ No newline at end of file
+const CACHE_VERSION = '14234ca5'; const PRECACHE_URLS = ['/', '/script.975985e8.js', '/styles.aeb260a9.css']; const PRECACHE_OPTIONAL = ['/favicon.png', '/img/visibility.svg', '/img/visibility_off.svg', '/manifest.json']; const CACHE_NAME = 'tigertag-scale-' + CACHE_VERSION; const CACHE_PREFIX = 'tigertag-scale-'; const HASHED_URL = /\.[0-9a-f]{8}\.[a-z0-9]+$/; self.addEventListener('install', event => { event.waitUntil( caches.open(CACHE_NAME) .then(cache => cache.addAll(PRECACHE_URLS.map(url => new Request(url, { cache: 'reload' }))) .then(() => Promise.all(PRECACHE_OPTIONAL.map(url => cache.add(new Request(url, { cache: 'reload' })).catch(err => console.log('Precache skipped:', url, err)))))) .then(() => self.skipWaiting()) .catch(err => { console.log('Precache failed:', err); throw err; }) ); }); self.addEventListener('activate', event => { event.waitUntil( caches.keys() .then(names => Promise.all( names .filter(name => name.startsWith(CACHE_PREFIX) && name !== CACHE_NAME) .map(name => caches.delete(name)) )) .then(() => self.clients.claim()) ); }); function isNetworkOnly(url) { return url.pathname.startsWith('/api/') || url.pathname.startsWith('/ws') || url.pathname.startsWith('/apikeydelete') || url.pathname === '/metrics'; } function isShellNavigation(request, url) { return request.mode === 'navigate' && (url.pathname === '/' || url.pathname === '/index.html'); } function putIfOk(request, response) { if (!response || !response.ok || response.type !== 'basic') return response; const copy = response.clone(); caches.open(CACHE_NAME).then(cache => cache.put(request, copy)); return response; } self.addEventListener('fetch', event => { const request = event.request; if (request.method !== 'GET') return; const url = new URL(request.url); if (url.origin !== self.location.origin || isNetworkOnly(url)) return; const shell = isShellNavigation(request, url); if (request.mode === 'navigate' && !shell) return; const key = shell ? '/' : request; event.respondWith( caches.match(key, { ignoreSearch: shell }).then(cached => { const refresh = () => fetch(request).then(response => putIfOk(key, response)); if (!cached) return refresh(); if (!HASHED_URL.test(url.pathname)) { event.waitUntil(refresh().catch(() => {})); } return cached; }) ); });
\ No newline at end of file
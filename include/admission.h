@@ -0,0 +1,34 @@
+/*
+ * @file admission.h
+ * @brief TigerTagScale - Contrôle d'admission HTTP/WebSocket selon la pression mémoire
+ *
+ * Un handler placé en tête de AsyncWebServer voit chaque requête avant les
+ * routes. Il lit le tas libre et le plus grand bloc allouable, en déduit un
+ * niveau de pression et refuse (503 + Retry-After) ce qui coûterait trop.
+ * Les seuils et la décision sont dans admission_policy.h (testés sur le
+ * poste) ; ici ne restent que la lecture du tas et le handler.
+ *
+ * Indépendamment du tas, le nombre de requêtes HTTP en cours et de clients
+ * WebSocket est plafonné : lwIP accepterait bien plus de connexions que le
+ * tas ne peut en servir.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "admission_policy.h"
+
+class AsyncWebServer;
+class AsyncWebSocket;
+
+// Registers the admission handler. Call before any other addHandler()/on();
+// ws is the status socket whose client count is capped.
+void admissionAttach(AsyncWebServer& server, AsyncWebSocket& ws);
+
+// Current level from the heap (cheap enough to call per request).
+AdmitLevel admissionLevel();
+
+// Route cost, static files included (NORMAL when the asset cache holds them).
+AdmitCost admissionCost(const char* url);
+
+// HTTP requests admitted and not yet disconnected.
+uint32_t admissionInflight();
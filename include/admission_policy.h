@@ -0,0 +1,87 @@
+/*
+ * @file admission_policy.h
+ * @brief TigerTagScale - Décision d'admission (niveaux, coût des routes, plafonds), hors serveur
+ *
+ * Ce que admission.cpp décide pour chaque requête, sans AsyncWebServer ni
+ * lecture du tas : le niveau vient des deux chiffres passés en argument,
+ * le compteur de requêtes en cours est tenu par AdmissionGate. Le handler
+ * côté firmware fournit ESP.getFreeHeap(), le plus grand bloc et le nombre
+ * de clients /ws, puis envoie le 503.
+ *
+ *   niveau     condition (tas libre / plus grand bloc)   refusé
+ *   OK         ≥ 48 Ko / ≥ 28 Ko                         -
+ *   LOW        < 48 Ko / < 28 Ko                         routes ADMIT_EXPENSIVE
+ *   CRITICAL   < 28 Ko / < 14 Ko                         tout sauf ADMIT_ESSENTIAL
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define ADMIT_LOW_FREE          49152
+#define ADMIT_LOW_BLOCK         28672
+#define ADMIT_CRITICAL_FREE     28672
+#define ADMIT_CRITICAL_BLOCK    14336
+#define ADMIT_MAX_INFLIGHT      6       // concurrent HTTP requests (WebSocket upgrades excluded)
+#define ADMIT_MAX_WS_CLIENTS    4       // /ws clients accepted while the heap is OK
+#define ADMIT_MAX_WS_CLIENTS_LOW 2      // ... and under pressure
+#define ADMIT_RETRY_BUSY_S      1
+#define ADMIT_RETRY_LOW_S       3
+#define ADMIT_RETRY_CRITICAL_S  10
+
+enum AdmitLevel : uint8_t {
+    ADMIT_LEVEL_OK = 0,
+    ADMIT_LEVEL_LOW,
+    ADMIT_LEVEL_CRITICAL
+};
+
+// Cost class of a route: what is shed first when memory runs short
+enum AdmitCost : uint8_t {
+    ADMIT_ESSENTIAL = 0,    // tiny, static buffers (status, tare, metrics): never shed for heap
+    ADMIT_NORMAL,           // RAM-cached assets, small JSON handlers
+    ADMIT_EXPENSIVE         // TLS round-trips, LittleFS streams, big JSON documents, WS upgrades
+};
+
+enum AdmitVerdict : uint8_t {
+    ADMIT_ACCEPT = 0,
+    ADMIT_REJECT_LOW,         // expensive route while the heap is LOW
+    ADMIT_REJECT_CRITICAL,    // non-essential route while the heap is CRITICAL
+    ADMIT_REJECT_BUSY,        // in-flight cap reached
+    ADMIT_REJECT_WS           // WebSocket client cap reached
+};
+
+AdmitLevel admissionLevelFor(uint32_t freeHeap, uint32_t largestBlock);
+
+// Cost of an API route or page. False for static files: their cost depends
+// on whether the asset cache holds them (see admissionCost()).
+bool admissionRouteCost(const char* url, AdmitCost* cost);
+
+AdmitVerdict admissionDecide(AdmitLevel level, AdmitCost cost, bool websocket,
+                             uint32_t inflight, uint32_t wsClients);
+
+// Verdict reported by a rejection whose request is gone (POST body arriving
+// late): derived from the level alone.
+AdmitVerdict admissionShedVerdict(AdmitLevel level);
+
+// Retry-After (seconds) sent with a rejection.
+uint8_t admissionRetryAfter(AdmitVerdict verdict);
+
+const char* admissionLevelName(AdmitLevel level);
+
+// Decision plus the count of HTTP requests admitted and not yet
+// disconnected. Not locked: the firmware only touches it from the AsyncTCP
+// task (canHandle and the disconnect callbacks).
+class AdmissionGate {
+public:
+    AdmissionGate() : inflight_(0) {}
+
+    // An accepted plain request is counted until release(); upgrades are
+    // capped by client count instead (their disconnect callback never fires).
+    AdmitVerdict admit(AdmitLevel level, AdmitCost cost, bool upgrade, bool statusSocket,
+                       uint32_t wsClients);
+    void release() { if (inflight_) inflight_--; }
+
+    uint32_t inflight() const { return inflight_; }
+
+private:
+    uint32_t inflight_;
+};
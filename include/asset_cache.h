@@ -0,0 +1,94 @@
+/*
+ * @file asset_cache.h
+ * @brief TigerTagScale - Cache RAM des fichiers web (index chargé au boot)
+ *
+ * Au démarrage, les petits fichiers de /www (variantes .br/.gz de préférence)
+ * sont recopiés dans une seule arène contiguë et indexés par URL + encodage
+ * avec leur type MIME et un ETag précalculé. Un handler placé avant les routes
+ * LittleFS choisit la meilleure variante acceptée par le client
+ * (Accept-Encoding : br > gzip > identité) et la sert directement depuis la
+ * RAM (aucun exists()/open() par requête). Ce qui ne tient pas dans le budget
+ * reste servi par LittleFS, avec la même négociation.
+ *
+ * Build "embarqué" (WEB_ASSETS_EMBEDDED, généré par scripts/build_web.py) :
+ * la table pointe directement sur les tableaux PROGMEM du firmware, sans
+ * arène ni lecture LittleFS.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+
+#define ASSET_CACHE_MAX_ENTRIES   40      // one per (URL, encoding) variant
+#define ASSET_CACHE_MAX_FILE      16384   // larger files (images, favicon.ico) stay on LittleFS
+#define ASSET_CACHE_MAX_BYTES     49152   // arena ceiling
+#define ASSET_CACHE_HEAP_RESERVE  65536   // largest free block that must remain after allocation
+#define ASSET_URL_MAX             40
+#define ASSET_IMMUTABLE_CACHE_CONTROL "public, max-age=31536000, immutable"
+
+// Values are also emitted by scripts/build_web.py (ENCODINGS); higher = preferred
+enum AssetEncoding : uint8_t {
+    ASSET_IDENTITY = 0,
+    ASSET_GZIP     = 1,
+    ASSET_BR       = 2
+};
+
+struct AssetEntry {
+    char           url[ASSET_URL_MAX];   // "/index.html", "/img/visibility.svg"
+    uint32_t       urlHash;
+    const uint8_t* data;                 // points into the arena (or flash)
+    uint32_t       len;
+    const char*    mime;
+    AssetEncoding  encoding;             // Content-Encoding of data
+    char           etag[12];             // "\"xxxxxxxx\"" (FNV-1a of the bytes, so per variant)
+    uint32_t       hits;
+};
+
+// Route table emitted by scripts/build_web.py into include/web_assets.h
+struct EmbeddedAsset {
+    const char*    url;
+    const uint8_t* data;
+    uint32_t       len;
+    uint8_t        encoding;             // AssetEncoding
+    const char*    etag;
+};
+
+// Indexes assets compiled into the firmware (no copy, no filesystem).
+void assetCacheBeginEmbedded(const EmbeddedAsset* assets, size_t count);
+
+// Indexes and loads <root> of fs into RAM. Call once at boot, before the
+// server starts (responses point into the arena).
+void assetCacheBegin(fs::FS& fs, const char* root);
+
+// Registers the RAM handler; call before any other static route.
+void assetCacheAttach(AsyncWebServer& server);
+
+// "/" resolves to "/index.html". Returns the preferred variant among the
+// encodings in acceptMask (bit per AssetEncoding), nullptr when none is cached.
+const AssetEntry* assetCacheFind(const char* url, uint8_t acceptMask);
+
+// Bit mask of the encodings the client accepts (identity always included).
+uint8_t assetAcceptedEncodings(AsyncWebServerRequest* request);
+
+const char* assetEncodingName(AssetEncoding encoding);
+
+// LittleFS fallback with the same negotiation: opens <path>.br, <path>.gz or
+// <path> and sets Content-Encoding/Vary. Files up to ASSET_CACHE_MAX_FILE
+// also get the RAM cache's ETag, and a matching If-None-Match yields a 304.
+// The caller adds Cache-Control. mime defaults to the one of path.
+// Returns nullptr when no acceptable variant exists.
+AsyncWebServerResponse* assetBeginFsResponse(AsyncWebServerRequest* request, fs::FS& fs,
+                                             const char* path, const char* mime = nullptr);
+
+// True for content-hashed names ("script.1a2b3c4d.js") produced by build_web.py.
+bool assetIsHashedUrl(const char* url);
+
+size_t assetCacheCount();
+const AssetEntry* assetCacheEntry(size_t i);
+size_t assetCacheArenaBytes();
+bool assetCacheEmbedded();
+uint32_t assetCacheMisses();   // GETs for files that fell through to LittleFS
@@ -0,0 +1,70 @@
+/*
+ * @file deferred_jobs.h
+ * @brief TigerTagScale - File de travaux différés (hors tâche AsyncTCP)
+ *
+ * Les handlers HTTP/WebSocket tournent dans la tâche AsyncTCP : un appel HTTPS
+ * ou un delay() y bloque toute la pile réseau. Ils se contentent donc de
+ * déposer un travail ici et de répondre 202 avec son identifiant ; loop()
+ * dépile et exécute, puis diffuse le résultat sur le WebSocket
+ * ({"type":"job",...}). Les derniers résultats restent consultables via
+ * GET /api/job?id=N pour les clients sans WebSocket.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define JOB_QUEUE_SLOTS     6
+#define JOB_RESULT_SLOTS    8
+#define JOB_ARG_MAX         96
+#define JOB_DETAIL_MAX      64
+
+enum JobType : uint8_t {
+    JOB_NONE = 0,
+    JOB_VALIDATE_API_KEY,   // arg = key to validate and persist if valid
+    JOB_DELETE_API_KEY,
+    JOB_PUSH_WEIGHT,        // arg = uid, value = grams
+    JOB_RESET_WIFI,
+    JOB_FACTORY_RESET,
+    JOB_TARE                // HX711 averaging (~1 s), shares the ADC with readWeight()
+};
+
+enum JobState : uint8_t {
+    JOB_UNKNOWN = 0,        // id never issued, or evicted from the result ring
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_FAILED
+};
+
+struct Job {
+    uint32_t id;
+    JobType  type;
+    uint32_t wsClient;      // requesting WebSocket client, 0 for HTTP
+    uint32_t notBeforeMs;   // lets a 202 reach the client before a reboot
+    int32_t  value;
+    char     arg[JOB_ARG_MAX];
+};
+
+struct JobResult {
+    uint32_t id;
+    JobType  type;
+    JobState state;
+    int16_t  code;          // upstream HTTP status when relevant
+    char     detail[JOB_DETAIL_MAX];
+};
+
+// Queues a job (safe from AsyncTCP handlers). Returns its id, or 0 if full.
+uint32_t jobEnqueue(JobType type, const char* arg, int32_t value,
+                    uint32_t wsClient = 0, uint32_t delayMs = 0);
+
+// Pops the oldest job whose delay has elapsed and marks it running (loop task).
+bool jobNext(Job& out);
+
+// Records the outcome of a job popped with jobNext().
+void jobFinish(uint32_t id, bool ok, int code, const char* detail);
+
+// Copies the last known state of a job. Returns false if unknown/evicted.
+bool jobLookup(uint32_t id, JobResult& out);
+
+const char* jobTypeName(JobType type);
+const char* jobStateName(JobState state);
@@ -0,0 +1,116 @@
+/*
+ * @file history_store.h
+ * @brief TigerTagScale - Anneaux min/max/moyenne par paliers et réduction (min/max, LTTB), hors serveur
+ *
+ * Le cœur de weight_history : les trois anneaux, le choix du palier, la
+ * recherche dans le temps, la réduction à `points` points et le rendu JSON
+ * morceau par morceau. Pas de dépendance Arduino : l'horloge (secondes
+ * depuis le démarrage) est passée en argument, et le verrou qui protège un
+ * seau lu depuis la tâche AsyncTCP est fourni par l'appelant (constructeur).
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HISTORY_TIERS           3
+#define HISTORY_T0_SLOTS        300     // 1 s buckets
+#define HISTORY_T1_SLOTS        360     // 1 min buckets
+#define HISTORY_T2_SLOTS        432     // 10 min buckets
+#define HISTORY_MAX_POINTS      1000
+#define HISTORY_DEFAULT_POINTS  200
+
+struct HistoryBucket {
+    uint32_t t;         // start of the period, seconds since boot
+    float    mean;
+    float    min;
+    float    max;
+};
+
+enum HistoryMode : uint8_t {
+    HISTORY_MINMAX = 0,   // envelope: each output point aggregates a group of buckets
+    HISTORY_LTTB          // Largest-Triangle-Three-Buckets on the mean (keeps the shape)
+};
+
+class HistoryStore {
+public:
+    // enter/exit wrap every ring write and every single-bucket read
+    // (nullptr: no lock, single task).
+    explicit HistoryStore(void (*enter)() = nullptr, void (*exit)() = nullptr);
+
+    // One filtered sample (writer side only). NaN is ignored.
+    void addSample(float grams, uint32_t nowS);
+
+    // Bucket at absolute index idx of a tier; false once overwritten or not yet written.
+    bool readBucket(uint8_t level, uint32_t idx, HistoryBucket& out) const;
+
+    // [oldest, head): absolute indices still held by the tier.
+    void bounds(uint8_t level, uint32_t& oldest, uint32_t& head) const;
+
+    // Finest tier that still holds `from` (or has never wrapped since boot).
+    uint8_t pickTier(uint32_t from) const;
+
+    // First absolute index in [oldest, head) whose bucket starts at or after t.
+    uint32_t lowerBound(uint8_t level, uint32_t t) const;
+
+    static const char* tierName(uint8_t level);
+    static uint32_t tierStep(uint8_t level);
+
+private:
+    struct Tier {
+        uint16_t       slots;
+        HistoryBucket* ring;
+        uint32_t       head;     // buckets committed since boot (absolute index of the next one)
+        // Open period, committed once a sample from the next period arrives
+        uint32_t       accT;
+        uint32_t       accN;
+        float          accSum;
+        float          accMin;
+        float          accMax;
+    };
+
+    void accumulate(uint8_t level, uint32_t t, float mean, float mn, float mx);
+    void enter() const { if (enter_) enter_(); }
+    void exit() const { if (exit_) exit_(); }
+
+    HistoryBucket ring0_[HISTORY_T0_SLOTS];
+    HistoryBucket ring1_[HISTORY_T1_SLOTS];
+    HistoryBucket ring2_[HISTORY_T2_SLOTS];
+    Tier tiers_[HISTORY_TIERS];
+    void (*enter_)();
+    void (*exit_)();
+};
+
+enum HistoryQueryPhase : uint8_t { QUERY_HEADER, QUERY_POINTS, QUERY_FOOTER, QUERY_DONE };
+
+// One /api/history response in progress: the tier, the range and where the
+// reduction stands. Read-only towards the store.
+struct HistoryQuery {
+    uint8_t           level;
+    HistoryMode       mode;
+    HistoryQueryPhase phase;
+    bool              decimate;   // false when the range already fits in `points`
+    bool              havePrev;
+    uint16_t          points;
+    uint32_t          lo, n;      // absolute first index, bucket count
+    uint32_t          from, to, now;
+    uint32_t          step;       // next output point
+    uint32_t          emitted;
+    HistoryBucket     prev;       // LTTB: last selected point
+    char              out[128];
+    uint16_t          outLen, outPos;
+};
+
+// Resolves [from, to] (seconds since boot, inclusive) to a tier and a
+// bucket range; points is clamped to [2, HISTORY_MAX_POINTS].
+void historyQueryBegin(const HistoryStore& store, HistoryQuery& q, uint32_t from, uint32_t to,
+                       uint16_t points, HistoryMode mode, uint32_t nowS);
+
+// Next reduced point; false once the range is exhausted.
+bool historyQueryNext(const HistoryStore& store, HistoryQuery& q, HistoryBucket& out);
+
+// Renders the next piece of JSON into q.out (q.outLen bytes); false when the
+// response is complete:
+//   {"tier":"1m","step":60,"now":..,"from":..,"to":..,"mode":"lttb",
+//    "points":[[t,mean,min,max],...],"count":N}
+bool historyQueryRender(const HistoryStore& store, HistoryQuery& q);
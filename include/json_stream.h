@@ -0,0 +1,74 @@
+/*
+ * @file json_stream.h
+ * @brief TigerTagScale - Tokenizer JSON incrémental pour les corps de requêtes REST
+ *
+ * Consomme le corps par morceaux (tels que livrés par AsyncWebServer via
+ * index/total) sans aucune allocation : les tampons de clé et de valeur sont
+ * internes et de taille fixe. Seul l'objet racine est décodé ; les objets et
+ * tableaux imbriqués sont validés puis ignorés. Chaque paire clé/valeur
+ * scalaire est remise à un callback qui remplit une structure typée.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define JSON_STREAM_KEY_MAX    32
+#define JSON_STREAM_VALUE_MAX  128
+
+enum JsonValueType : uint8_t {
+    JSON_VALUE_STRING = 0,
+    JSON_VALUE_NUMBER,
+    JSON_VALUE_BOOL,
+    JSON_VALUE_NULL
+};
+
+// key/value are NUL-terminated and only valid for the duration of the call.
+typedef void (*JsonFieldCallback)(void* ctx, const char* key, JsonValueType type,
+                                  const char* value, size_t len);
+
+// Number value, or a string holding one (older clients send "12.5"). Only
+// finite floats pass: "inf", "nan" and out-of-range values like 1e39 fail.
+bool jsonParseFloat(JsonValueType type, const char* value, float& out);
+
+class JsonStreamParser {
+public:
+    void begin(JsonFieldCallback cb, void* ctx);
+
+    // Feeds the next chunk; returns false as soon as the input is invalid.
+    bool feed(const uint8_t* data, size_t len);
+
+    // True once the root object has been closed (trailing whitespace allowed).
+    bool done() const { return _state == ST_DONE; }
+    bool failed() const { return _state == ST_ERROR; }
+    const char* error() const { return _error; }
+
+private:
+    enum State : uint8_t {
+        ST_START, ST_KEY_OR_END, ST_KEY, ST_COLON, ST_VALUE, ST_STRING,
+        ST_LITERAL, ST_SKIP, ST_COMMA_OR_END, ST_DONE, ST_ERROR
+    };
+
+    bool fail(const char* why);
+    bool appendChar(char c);
+    bool step(char c);
+    bool stringChar(char c, bool isKey);
+    bool endLiteral();
+    void emit(JsonValueType type);
+
+    JsonFieldCallback _cb;
+    void*       _ctx;
+    const char* _error;
+    State       _state;
+    bool        _escape;
+    bool        _skipInString;
+    bool        _skipEscape;
+    bool        _afterComma;
+    uint8_t     _unicodeLeft;   // remaining hex digits of a \uXXXX escape
+    uint16_t    _unicode;
+    uint16_t    _skipDepth;
+    uint16_t    _len;
+    bool        _keyTruncated;
+    char        _key[JSON_STREAM_KEY_MAX];
+    char        _buf[JSON_STREAM_VALUE_MAX];
+};
@@ -0,0 +1,85 @@
+/*
+ * @file metrics.h
+ * @brief TigerTagScale - Compteurs Prometheus (GET /metrics)
+ *
+ * Les compteurs sont des std::atomic<uint32_t> incrémentés sans verrou
+ * depuis n'importe quelle tâche (loop, AsyncTCP, MQTT). Le texte d'exposition
+ * est rendu à la demande dans un tampon fixe ; les jauges (tas, RSSI,
+ * clients) sont lues au moment du rendu. Les compteurs 32 bits repartent de 0
+ * au débordement, ce que rate()/increase() traitent comme un redémarrage.
+ */
+#pragma once
+
+#include <Arduino.h>
+
+#define METRICS_BUFFER_SIZE   8192
+
+enum MetricCounter : uint8_t {
+    MC_SAMPLES = 0,          // HX711 conversions read
+    MC_STREAM_DROPPED,       // samples dropped by /ws/stream backpressure
+    MC_RFID_READS,           // tag UIDs read
+    MC_RFID_POLLS,           // REQA frames sent to look for a tag
+    MC_RFID_SPI,             // RC522 register accesses issued by the detection loop
+    MC_RFID_REMOVALS,        // present tag stopped answering presence probes
+    MC_RFID_SET_FULL,        // tag left out of the inventory (RFID_MAX_TAGS reached)
+    MC_PUSH_ATTEMPTS,        // cloud weight pushes issued
+    MC_PUSH_SUCCESS,
+    MC_PUSH_FAILURE,
+    MC_WS_STATUS_BYTES,      // /ws status payload bytes queued
+    MC_WS_STREAM_BYTES,      // /ws/stream payload bytes queued (per client)
+    MC_WS_DELTAS,            // shared delta frames built
+    MC_WS_KEEPALIVES,
+    MC_WS_COALESCED,         // per-client deltas deferred because the client was slow
+    MC_WS_CATCHUPS,          // per-client catch-up frames sent
+    MC_SHED_LOW,             // requests refused by admission control, per AdmitVerdict
+    MC_SHED_CRITICAL,
+    MC_SHED_BUSY,
+    MC_SHED_WS,
+    MC_OLED_FLUSHES,         // display() calls that sent at least one window
+    MC_OLED_SKIPPED,         // display() calls with a frame identical to the panel
+    MC_OLED_I2C_BYTES,       // bytes put on the I2C bus by OLED flushes
+    MC_OLED_FRAMES,          // frames handed to the OLED flush task
+    MC_OLED_COALESCED,       // frames replaced before the task could send them
+    MC_COUNT
+};
+
+// How the TigerTag pages of a tag were obtained
+enum TagReadPath : uint8_t {
+    TAG_READ_CACHE = 0,      // UID known: pages from tag_cache, no RF exchange
+    TAG_READ_FAST,           // one NTAG FAST_READ over the page range
+    TAG_READ_PAGES,          // READ per 4 pages (tags without FAST_READ)
+    TAG_READ_PATHS
+};
+
+// Gauges owned by other modules, sampled by the caller at scrape time
+struct MetricsGauges {
+    uint32_t wsClients;
+    uint32_t streamClients;
+    uint32_t inflight;       // admitted HTTP requests still connected
+    uint8_t  admitLevel;     // AdmitLevel
+    uint32_t rfidPollMs;     // current REQA period
+    uint32_t rfidSpiHz;      // RC522 clock chosen by the boot self-test
+};
+
+void metricsAdd(MetricCounter c, uint32_t n = 1);
+
+// Filter stage of readWeight() (median + EMA), in microseconds.
+void metricsObserveFilterUs(uint32_t us);
+
+// readRFID() stage of loop() (poll, and inventory when tags arrive), in microseconds.
+void metricsObserveRfidUs(uint32_t us);
+
+// One differential OLED flush that sent something, in microseconds.
+void metricsObserveOledFlushUs(uint32_t us);
+
+// From display() to the end of the flush that sent the frame, in microseconds.
+void metricsObserveOledLatencyUs(uint32_t us);
+
+// Duration of one cloud push (HTTPS round-trip), in milliseconds.
+void metricsObservePushMs(uint32_t ms);
+
+// Time to obtain the TigerTag pages after selection, in microseconds.
+void metricsObserveTagReadUs(TagReadPath path, uint32_t us);
+
+// Renders the Prometheus text format; returns the length (0 if it did not fit).
+size_t metricsRender(char* buf, size_t cap, const MetricsGauges& gauges);
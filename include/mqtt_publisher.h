@@ -0,0 +1,53 @@
+/*
+ * @file mqtt_publisher.h
+ * @brief TigerTagScale - Publication MQTT (QoS1, topics retenus, last-will)
+ *
+ * Topics (base = <prefix>/<mdns name>, ex: tigerscale/tigerscale-AB12):
+ *   <base>/status   "online" | "offline"   retenu, last-will = "offline"
+ *   <base>/weight   {"weight":N,"uid":"…"}  retenu, coalescé (dernière valeur)
+ *   <base>/uid      "<uid décimal>"          retenu
+ *   <base>/stable   {"weight":N,"uid":"…"}  évènement (QoS1, non retenu)
+ *   <base>/push     {"ok":true,"weight":N,"uid":"…","code":200}  évènement
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "mqtt_queue.h"
+
+struct MqttConfig {
+    bool     enabled = false;
+    String   host;
+    uint16_t port = 1883;
+    String   user;
+    String   pass;
+    String   prefix = "tigerscale";
+};
+
+struct MqttStats {
+    bool     connected;
+    uint32_t queued;      // messages waiting or in flight
+    uint32_t published;   // acked by broker (PUBACK)
+    uint32_t coalesced;   // state updates merged into a pending slot
+    uint32_t dropped;     // rejected because the queue was full
+    uint32_t retries;     // in-flight messages re-sent after timeout/reconnect
+};
+
+// Loads the configuration from Preferences ("config") and starts the client.
+// deviceName is used both as client id and as the last topic level.
+void mqttSetup(const String& deviceName);
+
+// Services reconnection, queue draining and PUBACK timeouts. Call from loop().
+void mqttLoop();
+
+// Stages a new configuration (safe from AsyncTCP handlers); the next
+// mqttLoop() persists it and reconnects.
+void mqttApplyConfig(const MqttConfig& cfg);
+// Latest configuration, staged or running (copy, safe from any task).
+MqttConfig mqttConfig();
+MqttStats mqttStats();
+
+// Producers (safe to call from loop() and from AsyncTCP handlers)
+void mqttPublishWeight(int weightG, const char* uid);
+void mqttPublishUid(const char* uid);
+void mqttPublishStable(int weightG, const char* uid);
+void mqttPublishPushResult(bool ok, int code, int weightG, const char* uid);
@@ -0,0 +1,95 @@
+/*
+ * @file mqtt_queue.h
+ * @brief TigerTagScale - File d'envoi MQTT QoS1 et fenêtre d'acquittements, hors client
+ *
+ * Ce que mqtt_publisher décide pour chaque message, sans AsyncMqttClient :
+ * MQTT_QUEUE_SLOTS emplacements fixes, au plus MQTT_MAX_INFLIGHT messages
+ * non acquittés, envoi dans l'ordre FIFO. Une mise à jour d'état (coalesce)
+ * remplace la valeur encore en attente du même topic ; file pleine, la plus
+ * ancienne mise à jour d'état en attente est évincée, jamais un évènement.
+ * Sans PUBACK après MQTT_ACK_TIMEOUT_MS, le message repart avec DUP et le
+ * même identifiant ; à la déconnexion, les messages en vol redeviennent en
+ * attente.
+ *
+ * Pas de dépendance Arduino ni de verrou : mqtt_publisher.cpp prend
+ * gMqttMux autour de chaque appel (producteurs sur loop() et sur la tâche
+ * AsyncTCP, PUBACK et déconnexions sur la tâche AsyncTCP).
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Outgoing queue capacity (slots) and QoS1 in-flight window
+#define MQTT_QUEUE_SLOTS      12
+#define MQTT_MAX_INFLIGHT     4
+#define MQTT_TOPIC_MAX        80
+#define MQTT_PAYLOAD_MAX      160
+// PUBACK timeout before re-sending an in-flight message with DUP set
+#define MQTT_ACK_TIMEOUT_MS   5000
+
+struct MqttQueueStats {
+    uint32_t published;   // acked by broker (PUBACK)
+    uint32_t coalesced;   // state updates merged into a pending slot
+    uint32_t dropped;     // evicted or rejected because the queue was full
+    uint32_t retries;     // in-flight messages re-sent after timeout/reconnect
+};
+
+// A message handed to the client: copied out of its slot, so it can be
+// published without holding the caller's lock
+struct MqttOutgoing {
+    int8_t   slot;
+    bool     retain;
+    bool     dup;           // PUBACK timeout: same packet id, DUP flag
+    uint16_t packetId;      // id to reuse when dup, 0 otherwise
+    char     topic[MQTT_TOPIC_MAX];
+    char     payload[MQTT_PAYLOAD_MAX];
+};
+
+class MqttQueue {
+public:
+    MqttQueue();
+
+    // False when the message was dropped (queue full of events and in-flight
+    // messages). coalesce = state message (latest value wins).
+    bool enqueue(const char* topic, const char* payload, bool retain, bool coalesce);
+
+    // Next message to publish: a timed-out in-flight one first, else the
+    // oldest pending one if the window has room. Marks it in flight.
+    bool next(uint32_t nowMs, MqttOutgoing* out);
+
+    // Result of publishing out: packetId 0 = the client refused it (back to
+    // pending, retried on a later pass).
+    void sent(const MqttOutgoing& out, uint16_t packetId);
+
+    // PUBACK for packetId; false if no in-flight message carries it.
+    bool acked(uint16_t packetId);
+
+    // Connection lost: in-flight messages go back to pending.
+    void disconnected();
+
+    void clear();
+
+    uint32_t queued() const;        // pending + in flight
+    uint32_t inflight() const;
+    const MqttQueueStats& stats() const { return stats_; }
+
+private:
+    enum SlotState : uint8_t { SLOT_FREE = 0, SLOT_PENDING, SLOT_INFLIGHT };
+
+    struct Slot {
+        SlotState state;
+        bool      retain;
+        bool      coalesce;     // state message: newer value replaces a pending one
+        uint16_t  packetId;
+        uint32_t  seq;          // FIFO order
+        uint32_t  sentMs;
+        char      topic[MQTT_TOPIC_MAX];
+        char      payload[MQTT_PAYLOAD_MAX];
+    };
+
+    uint32_t countState(SlotState s) const;
+
+    Slot slots_[MQTT_QUEUE_SLOTS];
+    uint32_t seq_;
+    MqttQueueStats stats_;
+};
@@ -0,0 +1,56 @@
+/*
+ * @file oled_diff.h
+ * @brief TigerTagScale - Envoi différentiel du framebuffer SSD1306 (pages modifiées seulement)
+ *
+ * La mémoire du SSD1306 est organisée en pages de 8 lignes : un octet = une
+ * colonne de 8 pixels d'une page. OledDiff garde une copie de ce qui a été
+ * envoyé au contrôleur et, pour chaque page, n'envoie que les fenêtres de
+ * colonnes qui ont changé (PAGEADDR/COLUMNADDR puis les données). Deux
+ * zones modifiées séparées par moins de OLED_MERGE_GAP octets identiques
+ * partent en une seule fenêtre : renvoyer ces octets coûte moins que
+ * l'adressage d'une fenêtre de plus. Rien de modifié = rien sur le bus.
+ *
+ * Pas de dépendance Arduino : le transport est une interface, remplacée
+ * par un mock pour vérifier le découpage sur le poste.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OLED_WIDTH_MAX    128
+#define OLED_PAGES_MAX    8
+#define OLED_MERGE_GAP    10          // ~ I2C cost of addressing one more window
+
+// Where the changed bytes go (I2C panel on target, a recorder on the host)
+class OledTransport {
+public:
+    virtual ~OledTransport() {}
+    // Sets the controller write window to columns col0..col1 of one page.
+    virtual void window(uint8_t page, uint8_t col0, uint8_t col1) = 0;
+    // GDDRAM bytes for the current window, in column order.
+    virtual void data(const uint8_t* bytes, uint16_t n) = 0;
+};
+
+struct OledFlushResult {
+    uint16_t windows;                 // 0 = frame identical to the panel, nothing sent
+    uint16_t dataBytes;
+};
+
+class OledDiff {
+public:
+    OledDiff(uint8_t width, uint8_t pages);
+
+    // Next flush resends the whole frame (panel content unknown or reset).
+    void invalidate() { valid_ = false; }
+
+    // Sends what differs between frame and the panel, then records frame
+    // as the panel content. frame is width x pages bytes, page-major.
+    OledFlushResult flush(const uint8_t* frame, OledTransport& out);
+
+private:
+    uint8_t width_;
+    uint8_t pages_;
+    bool valid_;
+    uint8_t shadow_[OLED_WIDTH_MAX * OLED_PAGES_MAX];
+};
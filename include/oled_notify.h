@@ -0,0 +1,68 @@
+/*
+ * @file oled_notify.h
+ * @brief TigerTagScale - File de notifications OLED (durée + priorité, sans delay())
+ *
+ * Les messages transitoires ("Synced", "API key OK", "Sync failed") étaient
+ * affichés par displayMessage() suivi d'un delay() de 600 à 700 ms : loop()
+ * entière s'arrêtait à chaque événement. Ils passent maintenant par cette
+ * file, que le rendu de l'écran poids consulte à chaque image :
+ *
+ *   - la notice affichée est la plus prioritaire, puis la plus ancienne ;
+ *   - sa durée court à partir de sa première image, même si une notice
+ *     plus prioritaire la masque ensuite ;
+ *   - une notice poussée avec la même clé (key != 0) qu'une notice en file
+ *     la remplace sur place et repart de zéro ("Sending..." -> "Synced") ;
+ *   - file pleine : la notice la moins prioritaire (la plus ancienne à
+ *     égalité) cède sa place si elle n'est pas plus prioritaire que la
+ *     nouvelle, sinon la nouvelle est refusée.
+ *
+ * Pas de dépendance Arduino : l'horloge est passée en paramètre (nowMs), la
+ * file se vérifie sur le poste avec une horloge simulée. À n'utiliser que
+ * depuis loop().
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OLED_NOTIFY_SLOTS   4
+#define OLED_NOTIFY_LINES   3           // text rows of the overlay band
+#define OLED_NOTIFY_COLS    21          // 128 px / 6 px per character
+
+enum OledNotifyPriority : uint8_t {
+    NOTIFY_INFO = 0,                    // progress ("Sending...")
+    NOTIFY_RESULT,                      // outcome of an action ("Synced", "API key OK")
+    NOTIFY_ERROR                        // failures stay on top
+};
+
+struct OledNotice {
+    char     line[OLED_NOTIFY_LINES][OLED_NOTIFY_COLS + 1];
+    uint16_t durationMs;
+    uint8_t  priority;
+    uint8_t  key;                       // 0 = never replaced in place
+    bool     used;
+    bool     shown;                     // first frame drawn, shownAtMs valid
+    uint32_t shownAtMs;
+    uint32_t seq;                       // arrival order
+};
+
+class OledNotifyQueue {
+public:
+    OledNotifyQueue();
+
+    // Queues (or replaces, same key) a notice; null lines are empty, longer
+    // ones are cut at OLED_NOTIFY_COLS. False when the queue is full of more
+    // important notices.
+    bool push(const char* l1, const char* l2, const char* l3, uint16_t durationMs,
+              uint8_t priority, uint8_t key = 0);
+
+    // Drops expired notices and returns the one to draw now (nullptr = none).
+    const OledNotice* current(uint32_t nowMs);
+
+    uint8_t size() const;
+    void clear();
+
+private:
+    OledNotice slots_[OLED_NOTIFY_SLOTS];
+    uint32_t nextSeq_;
+};
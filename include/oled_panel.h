@@ -0,0 +1,69 @@
+/*
+ * @file oled_panel.h
+ * @brief TigerTagScale - SSD1306 I2C : envoi différentiel sur une tâche de fond
+ *
+ * Adafruit_SSD1306::display() pousse les 1024 octets du framebuffer à chaque
+ * appel, même quand seul un chiffre du poids a bougé (ou rien du tout), et
+ * bloque l'appelant pendant le transfert I2C (~25 ms à 400 kHz). OledPanel
+ * garde tout le dessin Adafruit_GFX et remplace display() :
+ *
+ *   - le framebuffer est comparé à ce que le panneau affiche déjà (OledDiff)
+ *     et seules les fenêtres de colonnes modifiées partent sur le bus ;
+ *   - après beginAsync(), display() ne fait que copier le buffer de dessin
+ *     (arrière) dans le buffer avant et réveille la tâche "oled", de basse
+ *     priorité, qui fait le transfert. Une image pas encore partie est
+ *     remplacée par la suivante (seule la dernière compte) ;
+ *   - beginAsync() vérifie l'ACK du panneau de la fréquence demandée à
+ *     400 kHz et garde la plus rapide qui passe.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+#include "oled_diff.h"
+
+#define OLED_I2C_SAFE_HZ     400000u     // SSD1306 datasheet (fast mode)
+#define OLED_TASK_STACK      3072
+#define OLED_TASK_PRIORITY   1           // same as loop(): never ahead of sensing or WiFi
+#define OLED_CLOCK_PROBES    8           // NOP commands that must be ACKed per candidate clock
+
+class OledPanel : public Adafruit_SSD1306, private OledTransport {
+public:
+    OledPanel(uint8_t w, uint8_t h, TwoWire* twi, int8_t rstPin);
+
+    // After begin(): picks the I2C clock (<= maxHz) and starts the flush
+    // task on core coreId. Before this, display() flushes inline.
+    bool beginAsync(uint32_t maxHz, BaseType_t coreId);
+
+    // Hides Adafruit_SSD1306::display(). Async: hands the frame to the flush
+    // task and returns at once. Inline: differential flush, false when the
+    // frame was already on the panel.
+    bool display();
+
+    // Forces the next flush to send the whole frame (after begin(),
+    // or a command that changes what the panel shows).
+    void invalidate() { diff_.invalidate(); }
+
+    uint32_t i2cClockHz() const { return wireClk; }
+
+private:
+    void window(uint8_t page, uint8_t col0, uint8_t col1) override;
+    void data(const uint8_t* bytes, uint16_t n) override;
+    bool flush(const uint8_t* frame);
+    bool clockAcked(uint32_t hz);
+    static void taskMain(void* arg);
+
+    OledDiff diff_;
+    uint32_t busBytes_;             // I2C bytes of the flush in progress
+
+    // Front buffers: pending_ is filled by display(), swapped with
+    // flushing_ by the task under mux_ (the copy is ~2 us)
+    TaskHandle_t task_;
+    portMUX_TYPE mux_;
+    uint8_t* pending_;
+    uint8_t* flushing_;
+    bool hasPending_;
+    uint32_t pendingUs_;            // micros() when the pending frame was presented
+    uint8_t frames_[2][OLED_WIDTH_MAX * OLED_PAGES_MAX];
+};
@@ -0,0 +1,57 @@
+/*
+ * @file rc522_spi.h
+ * @brief TigerTagScale - Accès registres RC522 groupés, horloge SPI vérifiée au démarrage
+ *
+ * La bibliothèque MFRC522 ouvre une transaction SPI (verrou du bus +
+ * reconfiguration) par accès registre et envoie chaque octet par un
+ * SPI.transfer() séparé, à 4 MHz. Les séquences de la boucle de détection
+ * (REQA, HLTA, lecture de ComIrqReg) passent ici :
+ *
+ *   - Rc522Burst prend le bus une fois pour toute une séquence ;
+ *   - chaque accès registre (adresse + données, FIFO comprise) part en un
+ *     seul transferBytes(), soit une transaction matérielle du contrôleur
+ *     SPI de l'ESP32 (tampon 64 octets : la FIFO du RC522 y tient, le DMA
+ *     n'apporterait rien à cette taille) ;
+ *   - l'horloge est la plus rapide qui passe rc522SpiSelfTest() : motif
+ *     écrit puis relu dans la FIFO, du max datasheet (10 MHz) à 4 MHz.
+ *
+ * Le RC522 n'adresse qu'un registre par sélection (CS) : une séquence reste
+ * une suite de sélections, mais sans les begin/endTransaction intermédiaires.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <MFRC522.h>
+
+#define RC522_SPI_MAX_HZ        10000000u   // datasheet limit of the RC522 SPI slave
+#define RC522_SPI_MIN_HZ        4000000u    // library default, used if nothing faster passes
+#define RC522_SPI_TEST_ROUNDS   8           // FIFO pattern round-trips per candidate clock
+
+// Result of the boot self-test, for logs and /metrics
+struct Rc522SpiStats {
+    uint32_t clockHz;          // 0 = the RC522 did not answer
+    uint32_t burstRegPerS;     // single-register reads per second through this transport
+    uint32_t libraryRegPerS;   // same reads through MFRC522::PCD_ReadRegister()
+};
+
+// ssPin is the RC522 chip select; SPI.begin() must have run.
+void rc522SpiBegin(uint8_t ssPin);
+
+// Picks the clock (RC522 idle, after PCD_Init) and measures both paths.
+const Rc522SpiStats& rc522SpiSelfTest(MFRC522& lib);
+const Rc522SpiStats& rc522SpiStats();
+
+// Holds the SPI bus for a sequence of register accesses; every rc522Read /
+// rc522Write must run inside one.
+class Rc522Burst {
+public:
+    Rc522Burst();
+    ~Rc522Burst();
+    Rc522Burst(const Rc522Burst&) = delete;
+    Rc522Burst& operator=(const Rc522Burst&) = delete;
+};
+
+void rc522Write(MFRC522::PCD_Register reg, uint8_t value);
+void rc522Write(MFRC522::PCD_Register reg, const uint8_t* values, uint8_t count);   // FIFO
+uint8_t rc522Read(MFRC522::PCD_Register reg);
+void rc522Read(MFRC522::PCD_Register reg, uint8_t* values, uint8_t count);          // FIFO
@@ -0,0 +1,33 @@
+/*
+ * @file rfid_presence.h
+ * @brief TigerTagScale - Anti-rebond de présence d'un tag (sondes WUPA)
+ *
+ * Un tag posé est mis en HALT après lecture : il ne répond plus aux REQA.
+ * Sa présence se vérifie par une sonde (WUPA + SELECT de son UID) toutes les
+ * RFID_PRESENCE_MS. Une sonde sans réponse peut venir d'un couplage limite
+ * (bobine qui bouge sur le plateau) : le tag n'est déclaré retiré qu'après
+ * RFID_REMOVE_MISSES sondes muettes d'affilée.
+ *
+ * Pas de dépendance Arduino : la transition se vérifie sur le poste.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define RFID_PRESENCE_MS        250     // WUPA probe period while a tag is on the reader
+#define RFID_REMOVE_MISSES      3       // unanswered probes before the tag counts as removed
+
+enum RfidEvent : uint8_t {
+    RFID_EVT_NONE = 0,
+    RFID_EVT_ARRIVED,      // a tag was selected and read (*tag filled)
+    RFID_EVT_REMOVED       // the present tag stopped answering WUPA probes
+};
+
+// Debounce of the present tag, fed with one result per WUPA probe
+struct RfidPresence {
+    bool    present;
+    uint8_t misses;        // consecutive unanswered probes
+};
+
+// Pure transition: seen = the present tag answered its probe.
+RfidEvent rfidPresenceUpdate(RfidPresence& p, bool seen);
@@ -0,0 +1,55 @@
+/*
+ * @file rfid_reader.h
+ * @brief TigerTagScale - Détection RC522 non bloquante (IRQ ou scrutation adaptative)
+ *
+ * PICC_IsNewCardPresent() envoie un REQA puis scrute ComIrqReg en boucle
+ * jusqu'à la réponse ou au timeout de 25 ms programmé par PCD_Init() : sans
+ * tag sur le lecteur, chaque appel bloque loop() ~25 ms et enchaîne ~2000
+ * lectures SPI. Ici le REQA est lancé puis on rend la main :
+ *
+ *   - mode IRQ (RC522_IRQ câblé) : le RC522 signale RxIRq (ATQA reçu) ou
+ *     TimerIRq (personne n'a répondu) sur sa broche IRQ, une seule lecture de
+ *     ComIrqReg suffit ensuite pour savoir lequel ;
+ *   - mode scrutation : ComIrqReg est lu une fois, RFID_REQA_SETTLE_MS après
+ *     l'envoi (l'ATQA arrive en ~100 µs).
+ *
+ * Le RC522 n'a pas de détection de carte basse consommation : il faut émettre
+ * pour savoir si un tag est là. L'intervalle entre deux REQA s'adapte donc :
+ * lent au repos, rapide pendant RFID_FAST_WINDOW_MS après une variation de
+ * poids (une bobine posée arrive avec son tag).
+ *
+ * La machine d'état (inventaire, sondes, file des arrivées) est RfidScanner ;
+ * ce module lui fournit le RC522 derrière l'interface RfidPcd.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <MFRC522.h>
+#include "rfid_scanner.h"
+#include "metrics.h"
+
+#define RFID_REQA_SETTLE_MS     2       // polling mode: wait before reading ComIrqReg
+#define RFID_REQA_TIMEOUT_MS    40      // IRQ mode: give up if the pin never fires (25 ms timer)
+
+// irqPin < 0 selects the polling mode.
+void rfidBegin(uint8_t ssPin, uint8_t rstPin, int8_t irqPin);
+
+// Advances the detection state machine and returns at most one event, with
+// the tag concerned copied to *tag. When a REQA is answered, every new tag
+// in the field is enumerated (anticollision, read, halt, repeat) into a set
+// of RFID_MAX_TAGS; each is then reported as its own ARRIVED event on this
+// and the following calls. Tags of the set are probed in turn (WUPA + SELECT
+// of their UID) every RFID_PRESENCE_MS; RFID_EVT_REMOVED comes after
+// RFID_REMOVE_MISSES silent probes of a tag (about 1 s for a single tag).
+RfidEvent rfidPoll(uint32_t nowMs, RfidTag* tag);
+
+// Tags currently on the reader (order changes on removal).
+uint8_t rfidTagCount();
+const RfidTag* rfidTagAt(uint8_t i);
+
+// Feeds the filtered weight so the poll period can follow scale activity.
+void rfidNoteWeight(float grams, uint32_t nowMs);
+
+// Current REQA period (ms) and mode, for /metrics and logs.
+uint32_t rfidPollIntervalMs();
+bool rfidIrqMode();
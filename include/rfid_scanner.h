@@ -0,0 +1,120 @@
+/*
+ * @file rfid_scanner.h
+ * @brief TigerTagScale - Machine d'état de détection multi-tags (inventaire + sondes)
+ *
+ * La logique ISO 14443-3 de rfid_reader (quand envoyer REQA ou WUPA,
+ * inventaire par anticollision, sondes de présence tour à tour, file des
+ * arrivées) ne parle au lecteur qu'à travers RfidPcd : le RC522 sur cible,
+ * un lecteur scripté sur le poste. Les accès registres, la broche IRQ, le
+ * cache de pages et les métriques restent côté implémentation.
+ *
+ * Pas de dépendance Arduino : l'horloge est passée en argument.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "rfid_presence.h"
+#include "tag_uid.h"
+#include "tigertag.h"
+
+#define RFID_POLL_IDLE_MS       300     // REQA period while nothing moves on the scale
+#define RFID_POLL_FAST_MS       50      // ... right after a weight change
+#define RFID_FAST_WINDOW_MS     3000
+#define RFID_WAKE_DELTA_G       5.0f    // weight change that switches to the fast period
+#define RFID_MAX_TAGS           8       // tags tracked at once (sample spool trays)
+
+// A tag as read right after selection, before it is halted
+struct RfidTag {
+    TagUid  uid;
+    uint8_t sak;                        // SELECT answer (tag type)
+    bool    hasUser;                    // user pages read (NTAG / Ultralight only)
+    uint8_t source;                     // TagReadPath (metrics.h), valid when hasUser
+    uint8_t user[TIGERTAG_BYTES];       // pages TIGERTAG_FIRST_PAGE..
+};
+
+enum RfidAnswer : uint8_t {
+    RFID_ANSWER_PENDING = 0,   // neither an answer nor the timeout yet
+    RFID_ANSWER_NONE,          // nobody answered
+    RFID_ANSWER_ATQA           // at least one tag answered (possibly collided)
+};
+
+// The PCD operations the state machine needs (RC522 on target, a scripted
+// field of tags on the host)
+class RfidPcd {
+public:
+    virtual ~RfidPcd() {}
+    // Sends REQA (IDLE tags) or WUPA (IDLE and HALT tags) and returns at once.
+    virtual void request(bool wakeup) = 0;
+    // Outcome of the last request(), elapsedMs after it was sent.
+    virtual RfidAnswer answer(uint32_t elapsedMs) = 0;
+    // Short "nobody answered" timer while frames follow each other (on),
+    // default timer (off).
+    virtual void burst(bool on) = 0;
+    // Anticollision + SELECT of one READY tag; false when none is left.
+    virtual bool selectAny(TagUid* uid, uint8_t* sak) = 0;
+    // SELECT of a known UID: only that tag answers, the other woken ones
+    // fall back to HALT.
+    virtual bool select(const TagUid& uid, uint8_t sak) = 0;
+    // Blocking REQA inside a burst: true if any ATQA came back.
+    virtual bool requestAgain() = 0;
+    // TigerTag pages of the selected tag into tag->user / tag->source.
+    virtual bool readUser(RfidTag* tag) = 0;
+    // HLTA of the selected tag; wait = let the frame leave before returning.
+    virtual void halt(bool wait) = 0;
+};
+
+// What the last poll() enumerated, for logs and metrics
+struct RfidInventoryResult {
+    uint8_t found;             // new tags added to the set
+    bool    setFull;           // a tag was left out (set full)
+};
+
+class RfidScanner {
+public:
+    RfidScanner();
+
+    // First REQA goes out on the first poll() at or after nowMs.
+    void begin(uint32_t nowMs);
+
+    // Advances the detection and returns at most one event (see rfidPoll()).
+    RfidEvent poll(uint32_t nowMs, RfidPcd& pcd, RfidTag* tag);
+
+    // Tags currently on the reader (order changes on removal).
+    uint8_t tagCount() const { return tagCount_; }
+    const RfidTag* tagAt(uint8_t i) const { return i < tagCount_ ? &tags_[i] : nullptr; }
+
+    void noteWeight(float grams, uint32_t nowMs);
+    uint32_t pollIntervalMs(uint32_t nowMs);
+
+    // Reset by every poll(); set when that poll ran an inventory burst.
+    const RfidInventoryResult& lastInventory() const { return last_; }
+
+private:
+    int findTag(const TagUid& uid) const;
+    void removeTag(uint8_t i);
+    void inventory(uint32_t nowMs, RfidPcd& pcd);
+    bool probeTag(uint8_t i, RfidPcd& pcd);
+    RfidEvent popPending(RfidTag* tag);
+
+    bool armed_;               // REQA/WUPA sent, answer or timer pending
+    bool armedWakeup_;         // last request was a WUPA probe
+    uint32_t armedMs_;
+    uint32_t nextPollMs_;
+
+    // Tags known to be on the reader (halted between probes), unordered
+    RfidTag tags_[RFID_MAX_TAGS];
+    RfidPresence presence_[RFID_MAX_TAGS];
+    uint8_t tagCount_;
+    uint8_t probeIdx_;         // next tag to probe (round-robin)
+    uint32_t nextProbeMs_;
+
+    // Arrivals found by one inventory burst, handed out one per poll()
+    uint8_t pending_[RFID_MAX_TAGS];    // indexes into tags_
+    uint8_t pendingCount_;
+    RfidInventoryResult last_;
+
+    bool fastActive_;
+    uint32_t fastUntilMs_;
+    bool refInit_;
+    float refWeight_;
+};
@@ -0,0 +1,64 @@
+/*
+ * @file sample_stream.h
+ * @brief TigerTagScale - Flux WebSocket binaire des échantillons HX711 (graphique temps réel)
+ *
+ * Endpoint dédié /ws/stream (opt-in : rien n'est produit tant qu'aucun client
+ * n'est connecté). Chaque échantillon lu par readWeight() est empilé puis
+ * envoyé par lots de STREAM_BATCH_SAMPLES dans une trame binaire little-endian :
+ *
+ *   en-tête (8 octets)
+ *     u8  version      (= STREAM_PROTO_VERSION)
+ *     u8  count        échantillons dans la trame
+ *     u16 sampleSize   (= 16, permet d'étendre l'échantillon sans casser l'UI)
+ *     u32 firstSeq     numéro du premier échantillon (continu, trous = pertes)
+ *   échantillon (16 octets) × count
+ *     u32 t_us         micros() au moment de la lecture
+ *     i32 raw          comptes bruts HX711 (avant tare et facteur)
+ *     f32 filtered     poids filtré (médiane + EMA), en grammes
+ *     u8  flags        STREAM_FLAG_*
+ *     u8  pad[3]
+ */
+#pragma once
+
+#include <Arduino.h>
+
+class AsyncWebServer;
+
+#define STREAM_PROTO_VERSION    1
+#define STREAM_BATCH_SAMPLES    8       // samples per frame (header amortised 8x)
+#define STREAM_MAX_BATCH_MS     200     // flush a partial batch after this delay
+#define STREAM_MAX_CLIENTS      2
+
+enum StreamFlag : uint8_t {
+    STREAM_FLAG_HOLD = 1 << 0,   // hold mode engaged
+    STREAM_FLAG_TAG  = 1 << 1,   // a tag UID is known
+    STREAM_FLAG_TARE = 1 << 2,   // first sample after a tare
+    STREAM_FLAG_GAP  = 1 << 3,   // frames were dropped right before this sample
+    STREAM_FLAG_MULTI = 1 << 4   // several tags on the reader (the weight is a sum)
+};
+
+struct StreamStats {
+    uint32_t clients;
+    uint32_t frames;         // frames handed to the WebSocket layer
+    uint32_t samples;        // samples sent
+    uint32_t dropped;        // samples discarded because a client queue was full
+    float    framesPerSec;   // over the last full second
+    float    samplesPerSec;
+    uint32_t busyUsPerSec;   // time spent in push + flush over the last second
+    uint32_t maxFlushUs;
+};
+
+// Registers /ws/stream on the server. Call once from setupWebServer().
+void sampleStreamSetup(AsyncWebServer& server);
+
+// Appends one acquisition sample (loop task only).
+void sampleStreamPush(int32_t rawCounts, float filteredG, uint8_t flags);
+
+// Marks the next sample with STREAM_FLAG_TARE (safe from AsyncTCP handlers).
+void sampleStreamMarkTare();
+
+// Flushes a partial batch once it is STREAM_MAX_BATCH_MS old, prunes clients
+// and rolls the per-second counters. Call from loop().
+void sampleStreamLoop();
+
+StreamStats sampleStreamStats();
@@ -0,0 +1,98 @@
+/*
+ * @file status_json.h
+ * @brief TigerTagScale - Instantané d'état et sérialisation JSON sans allocation
+ *
+ * loop() recopie l'état courant dans un StatusSnapshot ; les handlers HTTP
+ * travaillent sur une copie figée de cet instantané et l'écrivent directement
+ * dans un tampon fourni par l'appelant (aucune String, aucun malloc, pas de
+ * printf flottant).
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "tag_uid.h"
+#include "tigertag.h"
+
+#define STATUS_JSON_MAX 768
+#define TAGS_JSON_ENTRY_MAX 128     // one /api/tags entry is at most ~110 bytes
+
+struct StatusSnapshot {
+    int32_t  weight;            // displayed weight (hold-aware), rounded (g)
+    int32_t  smoothWeight;      // filtered weight, rounded (g)
+    float    rawWeight;         // filtered float weight (g)
+    bool     hold;
+    int32_t  holdWeight;
+    bool     cloudOK;
+    bool     apiValid;
+    float    calibrationFactor;
+    uint32_t uptimeMs;
+    char     uid[24];
+    char     uidHex[24];
+    char     wifi[33];
+    char     ip[16];
+    char     mdns[40];
+    char     apiKey[96];
+    char     displayName[64];
+    char     sendToCloud[8];    // "3","2","1","send","success","error" or ""
+    bool     spoolValid;        // TigerTag data decoded from the current tag
+    uint16_t materialId;
+    uint32_t nominalG;
+    uint16_t tareG;             // 0 = not on the tag
+    bool     hasNet;
+    int32_t  netG;              // displayed weight minus tare
+    uint8_t  tagCount;          // tags on the reader (> 1 = several spools weighed together)
+};
+
+// One bit per top-level key of /api/status, in output order
+enum StatusField : uint32_t {
+    SF_WEIGHT            = 1u << 0,
+    SF_RAW_WEIGHT        = 1u << 1,
+    SF_SMOOTH_WEIGHT     = 1u << 2,
+    SF_HOLD              = 1u << 3,
+    SF_HOLD_WEIGHT       = 1u << 4,
+    SF_UID               = 1u << 5,
+    SF_UID_HEX           = 1u << 6,
+    SF_WIFI              = 1u << 7,
+    SF_IP                = 1u << 8,
+    SF_MDNS              = 1u << 9,
+    SF_CLOUD             = 1u << 10,
+    SF_API_KEY           = 1u << 11,
+    SF_API_VALID         = 1u << 12,
+    SF_DISPLAY_NAME      = 1u << 13,
+    SF_CALIBRATION       = 1u << 14,
+    SF_UPTIME_MS         = 1u << 15,
+    SF_UPTIME_S          = 1u << 16,
+    SF_SEND_TO_CLOUD     = 1u << 17,
+    SF_SPOOL             = 1u << 18,
+    SF_TAGS              = 1u << 19,
+    SF_ALL               = (1u << 20) - 1,
+    // Pushed over the WebSocket as deltas: excludes fields that change on
+    // every sample without being shown (noise would defeat delta encoding).
+    // uptime_s only rides on the idle keepalive; the UI ticks it locally.
+    SF_WS_DELTA          = SF_ALL & ~(SF_RAW_WEIGHT | SF_SMOOTH_WEIGHT | SF_HOLD_WEIGHT |
+                                      SF_UPTIME_MS | SF_UPTIME_S)
+};
+
+// Parses a "?fields=weight,uid" list; unknown names are ignored.
+// Returns SF_ALL for a null/empty list, 0 if no name matched.
+uint32_t statusParseFields(const char* list);
+
+// Bitmask of the fields whose value differs between a and b.
+uint32_t statusDiff(const StatusSnapshot& a, const StatusSnapshot& b);
+
+// Writes the JSON object into out (NUL-terminated). Returns the length, or 0
+// if cap was too small.
+size_t statusSerialize(const StatusSnapshot& s, uint32_t fields, char* out, size_t cap);
+
+// One tag of the set for /api/tags, copied with the status snapshot
+struct TagSnap {
+    TagUid   uid;
+    TigerTagInfo info;          // valid = false without TigerTag data
+    int32_t  netG;              // apportioned share, when apportioned
+};
+
+// {"count":N,"apportioned":..,"tags":[{"uid":..,"material":..,"nominal":..,
+// "tare":..,"net":..},...]} into out. Returns the length, or 0 if cap was too
+// small (64 + n * TAGS_JSON_ENTRY_MAX always fits).
+size_t tagsSerialize(const TagSnap* tags, uint8_t n, bool apportioned, char* out, size_t cap);
@@ -0,0 +1,32 @@
+/*
+ * @file tag_cache.h
+ * @brief TigerTagScale - Cache des pages TigerTag indexé par UID (RAM + LittleFS)
+ *
+ * Les données d'une bobine ne changent pas une fois le tag écrit : quand un
+ * tag déjà vu revient sur la balance, seule la sélection (UID) passe par la
+ * radio, les pages viennent d'ici. Chaque entrée porte un hash FNV-1a de son
+ * contenu, vérifié au chargement du fichier (entrée corrompue = ignorée).
+ *
+ * Le cache tient en RAM (TAG_CACHE_ENTRIES entrées, remplacement LRU) et est
+ * réécrit dans TAG_CACHE_PATH seulement quand un contenu nouveau y entre.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include "tag_uid.h"
+
+#define TAG_CACHE_ENTRIES   16
+#define TAG_CACHE_PATH      "/tagcache.bin"
+
+// Loads the persisted entries (missing or stale file = empty cache).
+void tagCacheBegin(fs::FS& fs);
+
+// Copies the cached TigerTag pages (TIGERTAG_BYTES) of uid into user.
+bool tagCacheLookup(const TagUid& uid, uint8_t* user);
+
+// Inserts or refreshes uid; the file is rewritten only if the content is new.
+void tagCacheStore(const TagUid& uid, const uint8_t* user);
+
+// Entries currently held, for logs.
+uint8_t tagCacheCount();
@@ -0,0 +1,101 @@
+/*
+ * @file tag_uid.h
+ * @brief TigerTagScale - UID de tag ISO 14443A en valeur fixe (sans allocation)
+ *
+ * Un UID fait 4, 7 ou 10 octets. TagUid le garde tel quel avec sa longueur
+ * et le formate à la demande dans un tampon fourni par l'appelant :
+ *
+ *   - décimal : les octets lus en big-endian comme un entier (forme utilisée
+ *     par l'API, l'UI et le cloud). Seuls les 8 derniers octets d'un UID de
+ *     10 tiennent dans les 64 bits, comme avant ;
+ *   - hexadécimal majuscule, 2 caractères par octet (logs).
+ *
+ * Tout est constexpr et sans dépendance Arduino : copier, comparer ou
+ * formater un UID ne touche jamais le tas.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TAG_UID_MAX       10                    // triple-size UID
+#define TAG_UID_DEC_LEN   21                    // 2^64 - 1 has 20 digits, + NUL
+#define TAG_UID_HEX_LEN   (TAG_UID_MAX * 2 + 1)
+
+struct TagUid {
+    uint8_t len = 0;                            // 0 = no tag
+    uint8_t bytes[TAG_UID_MAX] = {};
+
+    constexpr TagUid() = default;
+    constexpr TagUid(const uint8_t* b, uint8_t n) {
+        len = n > TAG_UID_MAX ? TAG_UID_MAX : n;
+        for (uint8_t i = 0; i < len; ++i) bytes[i] = b[i];
+    }
+
+    constexpr bool empty() const { return len == 0; }
+    constexpr void clear() { len = 0; }
+
+    // Big-endian integer value behind the decimal form
+    constexpr uint64_t value() const {
+        uint64_t v = 0;
+        for (uint8_t i = 0; i < len; ++i) v = (v << 8) | bytes[i];
+        return v;
+    }
+
+    // Writes the decimal form ("" for no tag); returns its length, 0 if cap
+    // is too small (out is then "").
+    constexpr size_t toDec(char* out, size_t cap) const {
+        if (cap == 0) return 0;
+        out[0] = '\0';
+        if (empty()) return 0;
+        char rev[TAG_UID_DEC_LEN] = {};
+        size_t n = 0;
+        uint64_t v = value();
+        do { rev[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+        if (n + 1 > cap) return 0;
+        for (size_t i = 0; i < n; ++i) out[i] = rev[n - 1 - i];
+        out[n] = '\0';
+        return n;
+    }
+
+    constexpr size_t toHex(char* out, size_t cap) const {
+        if (cap == 0) return 0;
+        out[0] = '\0';
+        if ((size_t)len * 2 + 1 > cap) return 0;
+        const char* digits = "0123456789ABCDEF";
+        for (uint8_t i = 0; i < len; ++i) {
+            out[i * 2] = digits[bytes[i] >> 4];
+            out[i * 2 + 1] = digits[bytes[i] & 0x0F];
+        }
+        out[len * 2] = '\0';
+        return (size_t)len * 2;
+    }
+
+    // FNV-1a over length and bytes
+    constexpr uint32_t hash() const {
+        uint32_t h = 2166136261u;
+        h = (h ^ len) * 16777619u;
+        for (uint8_t i = 0; i < len; ++i) h = (h ^ bytes[i]) * 16777619u;
+        return h;
+    }
+
+    constexpr bool operator==(const TagUid& o) const {
+        if (len != o.len) return false;
+        for (uint8_t i = 0; i < len; ++i) {
+            if (bytes[i] != o.bytes[i]) return false;
+        }
+        return true;
+    }
+    constexpr bool operator!=(const TagUid& o) const { return !(*this == o); }
+};
+
+// Fixed-size text forms, for call sites that keep them around
+struct TagUidDec {
+    char str[TAG_UID_DEC_LEN] = {};
+    constexpr explicit TagUidDec(const TagUid& u) { u.toDec(str, sizeof(str)); }
+};
+
+struct TagUidHex {
+    char str[TAG_UID_HEX_LEN] = {};
+    constexpr explicit TagUidHex(const TagUid& u) { u.toHex(str, sizeof(str)); }
+};
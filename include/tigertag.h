@@ -0,0 +1,69 @@
+/*
+ * @file tigertag.h
+ * @brief TigerTagScale - Décodage de la mémoire utilisateur d'un tag TigerTag (NTAG21x)
+ *
+ * Les données TigerTag commencent à la page 4 (première page utilisateur des
+ * NTAG213/215/216). Tous les entiers sont big-endian :
+ *
+ *   page  octets  champ
+ *   4     0-3     identifiant de format TigerTag (u32, 0 / FFFFFFFF = tag vierge)
+ *   5     0-3     identifiant produit (u32)
+ *   6     0-1     matière (u16)            2 aspect 1       3 aspect 2
+ *   7     0       type                     1 diamètre       2-3 marque (u16)
+ *   8     0-3     couleur RGBA
+ *   9     0-2     poids nominal (u24)      3 unité (1 = g, 2 = kg)
+ *   10    0-1     buse min °C (u16)        2-3 buse max °C (u16)
+ *   11    0       séchage °C               1 séchage h      2-3 réservé
+ *   12    0-3     horodatage (u32, secondes)
+ *   13    0-1     tare bobine vide (u16, g, 0 = non renseignée)
+ *
+ * Pas de dépendance Arduino : le décodeur se vérifie sur le poste à partir de
+ * dumps de tags.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TIGERTAG_FIRST_PAGE   4
+#define TIGERTAG_PAGES        10          // pages 4..13
+#define TIGERTAG_BYTES        (TIGERTAG_PAGES * 4)
+#define TIGERTAG_MAX_NOMINAL_G 20000      // above this the tag is not a filament spool
+
+#define TIGERTAG_UNIT_G       1
+#define TIGERTAG_UNIT_KG      2
+
+struct TigerTagInfo {
+    bool     valid;
+    uint32_t formatId;
+    uint32_t productId;
+    uint16_t materialId;
+    uint8_t  aspect1;
+    uint8_t  aspect2;
+    uint8_t  typeId;
+    uint8_t  diameterId;
+    uint16_t brandId;
+    uint32_t colorRgba;
+    uint32_t nominalG;         // filament weight when new, converted to grams
+    uint16_t nozzleMinC;
+    uint16_t nozzleMaxC;
+    uint8_t  dryTempC;
+    uint8_t  dryHours;
+    uint32_t timestamp;
+    uint16_t tareG;            // empty spool weight, 0 if the tag does not carry it
+};
+
+// Decodes TIGERTAG_BYTES starting at page 4. Returns false (and out->valid =
+// false) for a blank or truncated dump, or values that cannot be a spool.
+bool tigertagDecode(const uint8_t* user, size_t len, TigerTagInfo* out);
+
+// Net filament left on a spool weighing gross grams; false when the tag has
+// no tare. Clamped at 0 so scale noise around an empty spool does not show
+// as negative filament (new spools often carry a little more than nominal).
+bool tigertagNetGrams(const TigerTagInfo& info, float gross, int32_t* net);
+
+// Several spools weighed together: subtracts every tare from gross and
+// splits the remainder in proportion to the nominal weights (an estimate:
+// it assumes the spools were used evenly). False, and nothing written, when
+// a tag lacks TigerTag data or a tare; the total is then only flagged.
+bool tigertagApportion(const TigerTagInfo* infos, uint8_t n, float gross, int32_t* net);
@@ -0,0 +1,42 @@
+/*
+ * @file weight_history.h
+ * @brief TigerTagScale - Historique du poids en RAM (anneaux par paliers) + requêtes sous-échantillonnées
+ *
+ * Chaque échantillon filtré alimente trois anneaux de seaux min/max/moyenne :
+ *
+ *   palier  pas     seaux  couverture
+ *   1s      1 s     300    5 min
+ *   1m      1 min   360    6 h
+ *   10m     10 min  432    3 jours
+ *
+ * Un seau n'est écrit qu'une fois sa période terminée, puis agrégé dans le
+ * palier suivant. Les horodatages sont en secondes depuis le démarrage (pas
+ * d'horloge murale sur l'appareil).
+ *
+ * GET /api/history?from=&to=&points=&mode= choisit le palier le plus fin qui
+ * couvre [from, to], le réduit côté serveur à `points` points (min/max par
+ * groupe, ou LTTB) et le diffuse en HTTP chunked, point par point, sans
+ * jamais construire la réponse complète en mémoire.
+ *
+ * Les anneaux et la réduction sont dans history_store.h (testés sur le
+ * poste) ; ici ne restent l'horloge, le verrou et la réponse HTTP.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "history_store.h"
+
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+
+// Feeds one filtered sample (loop task only).
+void historyAddSample(float grams, uint32_t nowMs);
+
+// Seconds since boot, the time base of every bucket.
+uint32_t historyNow();
+
+// Chunked JSON response for [from, to] (seconds since boot, inclusive), see
+// historyQueryRender(). Safe from AsyncTCP handlers: buckets are read one
+// by one under a lock.
+AsyncWebServerResponse* historyBeginResponse(AsyncWebServerRequest* request, uint32_t from,
+                                             uint32_t to, uint16_t points, HistoryMode mode);
@@ -0,0 +1,63 @@
+/*
+ * @file ws_clients.h
+ * @brief TigerTagScale - Table des clients WebSocket /ws et coalescence par client
+ *
+ * Une diffusion de delta ne part telle quelle qu'aux clients qui suivent. Un
+ * client lent (file de la bibliothèque pleine ou tampon TCP presque plein)
+ * est sauté : les champs qu'il a manqués s'accumulent dans pendingMask, et
+ * il reçoit plus tard une seule trame de rattrapage avec les dernières
+ * valeurs au lieu d'un arriéré de trames périmées.
+ *
+ * La table ne fait que décider ; l'envoi reste à l'appelant. Pas de
+ * dépendance Arduino ni de verrou : main.cpp prend gWsMux autour de chaque
+ * appel (connexions et déconnexions arrivent sur la tâche AsyncTCP, les
+ * diffusions partent de loop()) et n'envoie rien sous le verrou.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WS_MAX_TRACKED_CLIENTS  8
+
+enum WsSendAction : uint8_t {
+    WS_SEND_NONE = 0,       // nothing to send (unknown client, or nothing new)
+    WS_SEND_SHARED,         // queue the shared delta frame
+    WS_SEND_CATCHUP,        // send a per-client frame with the fields in mask
+    WS_SEND_COALESCED       // client is slow: the delta was folded into its pending mask
+};
+
+struct WsSendPlan {
+    WsSendAction action;
+    uint32_t     mask;      // fields of the catch-up frame (WS_SEND_CATCHUP)
+};
+
+class WsClientTable {
+public:
+    WsClientTable();
+
+    // False when the table is full (the caller closes the connection).
+    bool track(uint32_t id);
+    void untrack(uint32_t id);
+
+    // Copies the tracked ids into ids[WS_MAX_TRACKED_CLIENTS]; returns how many.
+    uint8_t ids(uint32_t* ids) const;
+
+    // What client id gets for a broadcast of the fields in changed (0 = no
+    // new delta: only flushes a pending catch-up). slow is the caller's
+    // view of the client's send queue.
+    WsSendPlan plan(uint32_t id, uint32_t changed, bool slow);
+
+    uint32_t pending(uint32_t id) const;
+
+private:
+    struct Slot {
+        bool     used;
+        uint32_t id;
+        uint32_t pendingMask;   // fields this client has not seen yet (coalesced)
+    };
+    Slot* find(uint32_t id);
+    const Slot* find(uint32_t id) const;
+
+    Slot slots_[WS_MAX_TRACKED_CLIENTS];
+};
@@ -4,6 +4,23 @@ import gzip
 import shutil
 from pathlib import Path
 import re
+import hashlib
+
+try:
+    import brotli   # pip install brotli (optionnel : sans lui, pas de variantes .br)
+except ImportError:
+    brotli = None
+
+# Mode "embarqué" (platformio.ini : custom_web_embed = yes) : en plus de data/www,
+# génère include/web_assets.h (tableaux PROGMEM + table de routes constexpr)
+# pour servir l'interface depuis la flash du firmware, sans LittleFS.
+EMBED = str(env.GetProjectOption("custom_web_embed", "no")).lower() in ("1", "yes", "true")
+EMBED_MAX_FILE = int(env.GetProjectOption("custom_web_embed_max_file", "16384"))
+EMBED_HEADER = Path("include/web_assets.h")
+
+# Fichiers jamais renommés : le service worker doit garder une URL stable
+UNHASHED = {"sw.js"}
+SERVICE_WORKER = "sw.js"
 
 def minify_html(content):
     """Minification HTML basique"""
@@ -27,14 +44,143 @@ def minify_css(content):
 
 def minify_js(content):
     """Minification JS basique (pour minification avancée, utiliser terser)"""
-    # Supprimer commentaires //
-    content = re.sub(r'//.*?\n', '\n', content)
+    # Supprimer commentaires // (sauf dans les URLs : 'ws://', 'https://')
+    content = re.sub(r'(?<![:\\])//[^\n]*', '', content)
     # Supprimer commentaires /* */
     content = re.sub(r'/\*.*?\*/', '', content, flags=re.DOTALL)
     # Supprimer espaces multiples
     content = re.sub(r'\s+', ' ', content)
     return content.strip()
 
+def fnv1a(data):
+    """Même hash que src/asset_cache.cpp (ETag)"""
+    h = 2166136261
+    for b in data:
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    return h
+
+def c_identifier(url):
+    return "kAsset" + re.sub(r'[^0-9A-Za-z]', '_', url)
+
+# Doit rester aligné avec AssetEncoding (include/asset_cache.h)
+ENCODINGS = {"identity": 0, "gzip": 1, "br": 2}
+
+def write_embedded_header(assets):
+    """assets: liste de (url, bytes, encoding)"""
+    version = fnv1a(b"".join(url.encode() + enc.encode() + data for url, data, enc in assets))
+    lines = [
+        "// Généré par scripts/build_web.py (custom_web_embed = yes) - ne pas modifier",
+        "#pragma once",
+        "",
+        "#include <Arduino.h>",
+        '#include "asset_cache.h"',
+        "",
+        f'#define WEB_ASSETS_VERSION "{version:08x}"',
+        "",
+    ]
+    for url, data, enc in assets:
+        lines.append(f"static const uint8_t {c_identifier(url + '_' + enc)}[] PROGMEM = {{")
+        for i in range(0, len(data), 20):
+            lines.append("    " + ",".join(f"0x{b:02x}" for b in data[i:i + 20]) + ",")
+        lines.append("};")
+    lines.append("")
+    lines.append("static constexpr EmbeddedAsset kEmbeddedAssets[] = {")
+    for url, data, enc in assets:
+        etag = f'"\\"{fnv1a(data):08x}\\""'
+        lines.append(f'    {{ "{url}", {c_identifier(url + "_" + enc)}, {len(data)}, {ENCODINGS[enc]}, {etag} }},')
+    lines.append("};")
+    lines.append("static constexpr size_t kEmbeddedAssetCount = sizeof(kEmbeddedAssets) / sizeof(kEmbeddedAssets[0]);")
+    text = "\n".join(lines) + "\n"
+
+    # Réécrire seulement si le contenu change (évite de tout recompiler)
+    if EMBED_HEADER.exists() and EMBED_HEADER.read_text(encoding='utf-8') == text:
+        print(f"   🔁 {EMBED_HEADER} inchangé (version {version:08x})")
+        return
+    EMBED_HEADER.parent.mkdir(parents=True, exist_ok=True)
+    EMBED_HEADER.write_text(text, encoding='utf-8')
+    total = sum(len(d) for _, d, _ in assets)
+    print(f"   🧩 {EMBED_HEADER}: {len(assets)} assets, {total} bytes en flash (version {version:08x})")
+
+def hashed_name(name, data):
+    """script.js -> script.<8 hex>.js ; le firmware reconnaît ce motif (cache immutable)"""
+    stem, dot, ext = name.rpartition(".")
+    return f"{stem}.{hashlib.sha256(data).hexdigest()[:8]}.{ext}"
+
+def rewrite_asset_refs(html, renames):
+    """Remplace "/styles.css", "styles.css" … par leur nom hashé dans index.html"""
+    for name, new in renames.items():
+        html = re.sub(r'(?<=["\'/])' + re.escape(name) + r'(?=["\'?#])', new, html)
+    return html
+
+def precache_urls(source_dir, renames):
+    """URLs mises en cache à l'installation du service worker : (coquille, optionnelles).
+    Coquille = document + CSS/JS hashés, indispensables (l'installation échoue
+    sans eux). Optionnelles = petits fichiers statiques (manifest, icônes) :
+    absents du cache RAM quand le tas est bas, ils ne doivent pas bloquer
+    l'installation."""
+    shell = ["/"] + [f"/{renames[name]}" for name in sorted(renames)]
+    optional = []
+    for f in sorted(source_dir.rglob("*")):
+        if f.is_file() and f.suffix not in ['.html', '.css', '.js'] and f.stat().st_size <= EMBED_MAX_FILE:
+            optional.append("/" + f.relative_to(source_dir).as_posix())
+    return shell, optional
+
+def inject_service_worker(content, source_dir, renames, shell):
+    """Remplace CACHE_VERSION / PRECACHE_URLS de web-src/sw.js.
+    La version dérive du contenu de la coquille : même UI ⇒ même sw.js (pas de
+    réinstallation inutile), UI modifiée ⇒ nouveau cache, l'ancien est purgé."""
+    required, optional = precache_urls(source_dir, renames)
+    urls = required + optional
+    digest = hashlib.sha256("\n".join(urls).encode() + shell)
+    for url in urls:
+        f = source_dir / url.lstrip("/")
+        if f.is_file():
+            digest.update(f.read_bytes())
+    version = digest.hexdigest()[:8]
+    listing = lambda lst: ", ".join(f"'{u}'" for u in lst)
+    content = re.sub(r"const CACHE_VERSION = '[^']*';", f"const CACHE_VERSION = '{version}';", content)
+    content = re.sub(r"const PRECACHE_URLS = \[[^\]]*\];", f"const PRECACHE_URLS = [{listing(required)}];", content)
+    content = re.sub(r"const PRECACHE_OPTIONAL = \[[^\]]*\];", f"const PRECACHE_OPTIONAL = [{listing(optional)}];", content)
+    print(f"   🗂️  cache tigertag-scale-{version}, {len(required)} URLs précachées (+{len(optional)} optionnelles)")
+    return content
+
+def print_page_load_report(html, html_gz, linked):
+    """Requêtes/octets du document + des CSS/JS qu'il référence, calculés sur les
+    fichiers générés. Les lignes de rechargement sont des estimations : elles
+    supposent les en-têtes du firmware (document revalidé → 304 sans corps,
+    noms hashés immutables, le reste revalidé), pas une mesure réseau."""
+    refs = [(name, gz, hashed) for name, gz, hashed in linked if name.encode() in html]
+    revalidated = [name for name, _, hashed in refs if not hashed]
+    n = 1 + len(refs)
+    first = html_gz + sum(gz for _, gz, _ in refs)
+    print("\n📊 Chargement de la page (document + CSS/JS référencés, hors images)")
+    print(f"   Premier chargement      : {n} requêtes, {first:>6} B")
+    print(f"   Rechargement (avant)    : {n} requêtes, {first:>6} B  (no-store partout)")
+    print(f"   Rechargement (après)    : {1 + len(revalidated)} requête(s), {0:>6} B  "
+          f"(estimé : index.html → 304, {len(refs) - len(revalidated)} fichier(s) immutable(s))")
+    print(f"   Avec service worker     : 0 requête bloquante (estimé : coquille en cache, revalidée en fond)")
+    print(f"   Après mise à jour de l'UI: 1 + fichiers modifiés seulement (estimé)")
+
+def print_size_report(rows):
+    """Octets transférés par fichier selon l'encodage négocié"""
+    if not rows:
+        return
+    print("\n📦 Taille transférée par encodage (identity → gzip → br)")
+    if brotli is None:
+        print("   ⚠️  module 'brotli' absent : pas de variantes .br (pip install brotli)")
+    for name, ident, gz, br in rows:
+        line = f"   {name:<24} {ident:>7} B → {gz:>6} B (-{(1 - gz / ident) * 100:4.1f}%)"
+        if br is not None:
+            line += f" → {br:>6} B (-{(1 - br / ident) * 100:4.1f}%, {br - gz:+d} B vs gz)"
+        print(line)
+    ident = sum(r[1] for r in rows)
+    gz = sum(r[2] for r in rows)
+    line = f"   {'TOTAL':<24} {ident:>7} B → {gz:>6} B"
+    if brotli is not None:
+        line += f" → {sum(r[3] for r in rows):>6} B"
+    print(line)
+
 def build_web_files(*args, **kwargs):
     print("\n" + "="*60)
     print("🔨 BUILD INTERFACE WEB - TigerTagScale")
@@ -52,19 +198,27 @@ def build_web_files(*args, **kwargs):
     # Créer dossier destination
     data_dir.mkdir(parents=True, exist_ok=True)
     
-    # Nettoyer ancien build
-    for file in data_dir.glob("*"):
+    # Nettoyer ancien build (sous-dossiers compris : img/ …)
+    for file in data_dir.rglob("*"):
         if file.is_file():
             file.unlink()
     
     files_processed = 0
     total_original = 0
     total_compressed = 0
+    embedded = []   # (url, bytes, encoding) pour web_assets.h
+    size_rows = []  # rapport de tailles par fichier
     
-    # Liste des fichiers à traiter
-    web_files = list(source_dir.glob("*.html")) + \
-                list(source_dir.glob("*.css")) + \
-                list(source_dir.glob("*.js"))
+    # Liste des fichiers à traiter (HTML après CSS/JS : il référence les noms hashés ;
+    # service worker en dernier : sa version dépend de tout le reste)
+    web_files = list(source_dir.glob("*.css")) + \
+                [f for f in source_dir.glob("*.js") if f.name != SERVICE_WORKER] + \
+                list(source_dir.glob("*.html")) + \
+                list(source_dir.glob(SERVICE_WORKER))
+    renames = {}
+    html_raw = b""
+    html_gz = 0
+    linked = []     # (nom servi, taille gzip, hashé) des CSS/JS
     
     if not web_files:
         print("⚠️  ATTENTION: Aucun fichier HTML/CSS/JS trouvé dans web-src/")
@@ -82,21 +236,45 @@ def build_web_files(*args, **kwargs):
             
             # Minification selon type
             if source_file.suffix == '.html':
-                content = minify_html(content)
+                content = rewrite_asset_refs(minify_html(content), renames)
             elif source_file.suffix == '.css':
                 content = minify_css(content)
+            elif source_file.name == SERVICE_WORKER:
+                content = minify_js(inject_service_worker(content, source_dir, renames, html_raw))
             elif source_file.suffix == '.js':
                 content = minify_js(content)
             
-            minified_size = len(content)
+            raw = content.encode('utf-8')
+            minified_size = len(raw)
             
             # Compression GZIP niveau 9 (maximum)
-            compressed = gzip.compress(content.encode('utf-8'), compresslevel=9)
+            # mtime=0 : sortie déterministe (le header embarqué ne change qu'avec le contenu)
+            compressed = gzip.compress(raw, compresslevel=9, mtime=0)
             compressed_size = len(compressed)
+            # Brotli qualité 11 / fenêtre 22 (maximum) : servi si le client annonce "br"
+            br = brotli.compress(raw, quality=11, lgwin=22) if brotli else None
             
-            # Sauvegarder avec extension .gz
-            output_file = data_dir / f"{source_file.name}.gz"
-            output_file.write_bytes(compressed)
+            # Nom hashé pour CSS/JS (contenu figé sous cette URL → cache navigateur d'un an)
+            out_name = source_file.name
+            if source_file.suffix in ('.css', '.js') and source_file.name not in UNHASHED:
+                out_name = hashed_name(source_file.name, raw)
+                renames[source_file.name] = out_name
+            if source_file.suffix in ('.css', '.js'):
+                linked.append((out_name, compressed_size, out_name != source_file.name))
+            elif source_file.name == 'index.html':
+                html_gz = compressed_size
+                html_raw = raw
+
+            # Variantes : identité (repli), .gz, .br — le firmware négocie via Accept-Encoding
+            (data_dir / out_name).write_bytes(raw)
+            (data_dir / f"{out_name}.gz").write_bytes(compressed)
+            embedded.append((f"/{out_name}", compressed, "gzip"))
+            if br is not None:
+                (data_dir / f"{out_name}.br").write_bytes(br)
+                embedded.append((f"/{out_name}", br, "br"))
+            size_rows.append((out_name, minified_size, compressed_size, len(br) if br is not None else None))
+            if out_name != source_file.name:
+                print(f"   🔖 {out_name}")
             
             # Statistiques
             ratio = (1 - compressed_size / original_size) * 100 if original_size > 0 else 0
@@ -110,15 +288,36 @@ def build_web_files(*args, **kwargs):
             print(f"   ❌ ERREUR: {e}")
             continue
     
-    # Copier fichiers binaires (images, etc.) sans compression
-    binary_files = [f for f in source_dir.iterdir() 
+    # Copier fichiers binaires (images, etc.) sans compression, en gardant
+    # l'arborescence : /img/custom.png doit exister sur LittleFS
+    binary_files = [f for f in sorted(source_dir.rglob("*"))
                     if f.is_file() and f.suffix not in ['.html', '.css', '.js']]
     
     for bin_file in binary_files:
-        print(f"📦 {bin_file.name} (copie directe)...")
-        shutil.copy(bin_file, data_dir / bin_file.name)
+        rel = bin_file.relative_to(source_dir)
+        print(f"📦 {rel.as_posix()} (copie directe)...")
+        (data_dir / rel).parent.mkdir(parents=True, exist_ok=True)
+        shutil.copy(bin_file, data_dir / rel)
         files_processed += 1
+
+    if EMBED:
+        # Images & co. (y compris sous-dossiers) tant qu'elles restent petites :
+        # la partition app n'a que quelques centaines de Ko de marge.
+        for bin_file in sorted(source_dir.rglob("*")):
+            if not bin_file.is_file() or bin_file.suffix in ['.html', '.css', '.js']:
+                continue
+            size = bin_file.stat().st_size
+            url = "/" + bin_file.relative_to(source_dir).as_posix()
+            if size > EMBED_MAX_FILE:
+                print(f"   ⏭️  {url} ({size} B) reste sur LittleFS")
+                continue
+            embedded.append((url, bin_file.read_bytes(), "identity"))
+        write_embedded_header(sorted(embedded))
     
+    print_size_report(size_rows)
+    if html_gz:
+        print_page_load_report(html_raw, html_gz, linked)
+
     # Résumé final
     print("\n" + "-"*60)
     if total_original > 0:
@@ -133,6 +332,12 @@ def build_web_files(*args, **kwargs):
         print(f"✨ {files_processed} fichiers copiés")
     print("-"*60 + "\n")
 
+# Mode embarqué : le header doit exister AVANT la compilation des sources,
+# donc génération immédiate au chargement du script (extra_scripts = pre:...)
+if EMBED:
+    env.Append(CPPDEFINES=["WEB_ASSETS_EMBEDDED"])
+    build_web_files()
+
 # Hook PlatformIO: exécuter AVANT la création du filesystem
 env.AddPreAction("buildfs", build_web_files)
 
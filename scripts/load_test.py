@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+# scripts/load_test.py
+# Charge HTTP simulée depuis le poste (plusieurs navigateurs + un tableau de bord)
+# pour vérifier que la balance se dégrade proprement : 503 + Retry-After au lieu
+# d'un reboot. Stdlib uniquement.
+#
+#   python scripts/load_test.py --host tigerscale.local --clients 12 --seconds 30
+#
+# Chaque seconde : réponses 2xx / 503 / erreurs, p95, puis le niveau d'admission
+# et le tas lus sur /metrics. Une dégradation correcte = les 503 montent avec la
+# charge, /api/status reste servi, le compteur uptime ne repart jamais à 0.
+
+import argparse
+import random
+import re
+import threading
+import time
+import urllib.error
+import urllib.request
+from collections import defaultdict
+
+# (poids, méthode, chemin) : mélange d'une UI ouverte + actions coûteuses
+MIX = [
+    (40, "GET",  "/api/status"),
+    (15, "GET",  "/"),
+    (10, "GET",  "/img/bambu_grey.png"),   # flux LittleFS
+    (10, "GET",  "/api/history?points=500&mode=lttb"),
+    (10, "GET",  "/api/assets"),
+    (5,  "GET",  "/metrics"),
+    (5,  "GET",  "/api/stream"),
+    (5,  "GET",  "/api/mqtt"),
+]
+
+lock = threading.Lock()
+stats = defaultdict(lambda: {"ok": 0, "shed": 0, "err": 0, "lat": []})
+stop = threading.Event()
+
+
+def pick():
+    total = sum(w for w, _, _ in MIX)
+    r = random.uniform(0, total)
+    for w, method, path in MIX:
+        r -= w
+        if r <= 0:
+            return method, path
+    return MIX[0][1:]
+
+
+def worker(base, timeout):
+    while not stop.is_set():
+        method, path = pick()
+        t0 = time.monotonic()
+        sec = int(time.time())
+        kind = "ok"
+        retry = 0
+        try:
+            req = urllib.request.Request(base + path, method=method,
+                                         headers={"Accept-Encoding": "gzip, br"})
+            with urllib.request.urlopen(req, timeout=timeout) as resp:
+                resp.read()
+        except urllib.error.HTTPError as e:
+            kind = "shed" if e.code == 503 else "err"
+            retry = int(e.headers.get("Retry-After", "0") or 0)
+        except Exception:
+            kind = "err"
+        dt = time.monotonic() - t0
+        with lock:
+            s = stats[sec]
+            s[kind] += 1
+            s["lat"].append(dt)
+        if retry:
+            # Client bien élevé : respecte Retry-After
+            stop.wait(retry)
+
+
+def scrape(base):
+    try:
+        with urllib.request.urlopen(base + "/metrics", timeout=2) as resp:
+            text = resp.read().decode()
+    except Exception:
+        return None
+    def val(name):
+        m = re.search(rf"^{name} ([0-9.e+-]+)$", text, re.M)
+        return float(m.group(1)) if m else float("nan")
+    return {
+        "level": int(val("tigerscale_admission_level")),
+        "heap": int(val("tigerscale_heap_free_bytes")),
+        "block": int(val("tigerscale_heap_largest_free_block_bytes")),
+        "uptime": val("tigerscale_uptime_seconds"),
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser(description="TigerTag Scale HTTP load test")
+    ap.add_argument("--host", default="tigerscale.local")
+    ap.add_argument("--clients", type=int, default=8)
+    ap.add_argument("--seconds", type=int, default=30)
+    ap.add_argument("--timeout", type=float, default=5.0)
+    args = ap.parse_args()
+    base = f"http://{args.host}"
+
+    before = scrape(base)
+    if before is None:
+        print(f"❌ {base}/metrics injoignable")
+        return 1
+
+    threads = [threading.Thread(target=worker, args=(base, args.timeout), daemon=True)
+               for _ in range(args.clients)]
+    for t in threads:
+        t.start()
+
+    levels = ["ok", "low", "critical"]
+    print(f"{'t':>3} {'2xx':>5} {'503':>5} {'err':>5} {'p95 ms':>7}  {'level':<8} {'heap':>7} {'block':>7}")
+    start = int(time.time())
+    uptime_reset = False
+    for i in range(args.seconds):
+        time.sleep(1)
+        m = scrape(base) or {}
+        if m and m["uptime"] < before["uptime"]:
+            uptime_reset = True
+        with lock:
+            s = stats.get(start + i, {"ok": 0, "shed": 0, "err": 0, "lat": []})
+        lat = sorted(s["lat"])
+        p95 = lat[int(len(lat) * 0.95)] * 1000 if lat else 0
+        level = levels[m["level"]] if m else "?"
+        print(f"{i:>3} {s['ok']:>5} {s['shed']:>5} {s['err']:>5} {p95:>7.0f}  {level:<8} "
+              f"{m.get('heap', 0):>7} {m.get('block', 0):>7}")
+    stop.set()
+
+    total = defaultdict(int)
+    for s in stats.values():
+        for k in ("ok", "shed", "err"):
+            total[k] += s[k]
+    print(f"\nTotal: {total['ok']} 2xx, {total['shed']} 503, {total['err']} erreurs")
+    print("❌ REDÉMARRAGE détecté (uptime revenu à 0)" if uptime_reset else "✅ aucun redémarrage")
+    return 1 if uptime_reset else 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,72 @@
+/*
+ * @file admission.cpp
+ * @brief TigerTagScale - Handler d'admission (en tête de chaîne) : tas, cache d'assets, 503
+ */
+
+#include "admission.h"
+#include "asset_cache.h"
+#include "metrics.h"
+
+#include <ESPAsyncWebServer.h>
+#include <esp_heap_caps.h>
+
+static AsyncWebSocket* gWs = nullptr;
+static AdmissionGate gGate;   // AsyncTCP task only (canHandle + disconnect callbacks)
+
+AdmitLevel admissionLevel() {
+    return admissionLevelFor(ESP.getFreeHeap(), heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
+AdmitCost admissionCost(const char* url) {
+    AdmitCost cost;
+    if (admissionRouteCost(url, &cost)) return cost;
+    // Static files: zero-copy from the RAM cache, or a LittleFS stream (file
+    // handle + 512-byte buffers for the whole transfer) when not cached
+    const uint8_t anyEncoding = (1 << ASSET_IDENTITY) | (1 << ASSET_GZIP) | (1 << ASSET_BR);
+    return assetCacheFind(url, anyEncoding) ? ADMIT_NORMAL : ADMIT_EXPENSIVE;
+}
+
+uint32_t admissionInflight() {
+    return gGate.inflight();
+}
+
+// 🔎 Placed first in the handler list, so AsyncWebServer asks it before any
+//    route. canHandle() returns true only to reject; admitted requests fall
+//    through to the real handler and are counted until their TCP connection
+//    closes. WebSocket upgrades are not counted: the connection is handed
+//    over to AsyncWebSocketClient and the request's disconnect callback never
+//    fires. They are capped by client count instead.
+class AdmissionHandler : public AsyncWebHandler {
+public:
+    bool canHandle(AsyncWebServerRequest *request) override {
+        const char* url = request->url().c_str();
+        bool upgrade = request->hasHeader("Upgrade");
+        bool statusSocket = upgrade && strcmp(url, "/ws") == 0;
+        AdmitVerdict verdict = gGate.admit(admissionLevel(), admissionCost(url), upgrade, statusSocket,
+                                           gWs ? gWs->count() : 0);
+        if (verdict != ADMIT_ACCEPT) {
+            metricsAdd((MetricCounter)(MC_SHED_LOW + verdict - ADMIT_REJECT_LOW));
+            return true;
+        }
+        if (!upgrade) request->onDisconnect([]() { gGate.release(); });
+        return false;
+    }
+
+    void handleRequest(AsyncWebServerRequest *request) override {
+        // A POST body may arrive after other requests were attached: derive the
+        // delay from the current level rather than keeping per-request state
+        char retry[4];
+        snprintf(retry, sizeof(retry), "%u", admissionRetryAfter(admissionShedVerdict(admissionLevel())));
+        AsyncWebServerResponse *response = request->beginResponse(503, "text/plain", "busy, retry later");
+        response->addHeader("Retry-After", retry);
+        response->addHeader("Cache-Control", "no-store");
+        request->send(response);
+    }
+};
+
+static AdmissionHandler gHandler;
+
+void admissionAttach(AsyncWebServer& server, AsyncWebSocket& ws) {
+    gWs = &ws;
+    server.addHandler(&gHandler);
+}
@@ -0,0 +1,95 @@
+/*
+ * @file admission_policy.cpp
+ * @brief TigerTagScale - Niveaux de pression, coût des routes et verdicts d'admission
+ */
+
+#include "admission_policy.h"
+
+#include <string.h>
+
+struct AdmitRule {
+    const char* prefix;
+    AdmitCost   cost;
+};
+
+// First matching prefix wins; anything else under /api/ is NORMAL.
+static const AdmitRule kRules[] = {
+    { "/api/status",     ADMIT_ESSENTIAL },
+    { "/api/tare",       ADMIT_ESSENTIAL },
+    { "/api/ping",       ADMIT_ESSENTIAL },
+    { "/api/job",        ADMIT_ESSENTIAL },
+    { "/metrics",        ADMIT_ESSENTIAL },
+    { "/api/apikey",     ADMIT_EXPENSIVE },   // HTTPS validation (~40 KB for TLS)
+    { "/apikeydelete",   ADMIT_EXPENSIVE },
+    { "/api/weight",     ADMIT_EXPENSIVE },   // cloud push
+    { "/api/push-weight", ADMIT_EXPENSIVE },
+    { "/api/assets",     ADMIT_EXPENSIVE },   // 1.5 KB JSON document
+    { "/api/history",    ADMIT_EXPENSIVE },   // long chunked response
+    { "/api/mqtt",       ADMIT_EXPENSIVE },
+    { "/ws/stream",      ADMIT_EXPENSIVE },   // full-rate send queue per client
+    { "/api/",           ADMIT_NORMAL },
+    { "/ws",             ADMIT_NORMAL },
+};
+
+const char* admissionLevelName(AdmitLevel level) {
+    switch (level) {
+        case ADMIT_LEVEL_LOW:      return "low";
+        case ADMIT_LEVEL_CRITICAL: return "critical";
+        default:                   return "ok";
+    }
+}
+
+AdmitLevel admissionLevelFor(uint32_t freeHeap, uint32_t largestBlock) {
+    if (freeHeap < ADMIT_CRITICAL_FREE || largestBlock < ADMIT_CRITICAL_BLOCK) return ADMIT_LEVEL_CRITICAL;
+    if (freeHeap < ADMIT_LOW_FREE || largestBlock < ADMIT_LOW_BLOCK) return ADMIT_LEVEL_LOW;
+    return ADMIT_LEVEL_OK;
+}
+
+bool admissionRouteCost(const char* url, AdmitCost* cost) {
+    for (const AdmitRule& r : kRules) {
+        if (strncmp(url, r.prefix, strlen(r.prefix)) == 0) {
+            *cost = r.cost;
+            return true;
+        }
+    }
+    return false;
+}
+
+AdmitVerdict admissionDecide(AdmitLevel level, AdmitCost cost, bool websocket,
+                             uint32_t inflight, uint32_t wsClients) {
+    if (websocket) {
+        uint32_t cap = level == ADMIT_LEVEL_OK  ? ADMIT_MAX_WS_CLIENTS
+                     : level == ADMIT_LEVEL_LOW ? ADMIT_MAX_WS_CLIENTS_LOW : 0;
+        return wsClients >= cap ? ADMIT_REJECT_WS : ADMIT_ACCEPT;
+    }
+    // Essential routes only answer from static buffers: keep them reachable
+    // (that is how a dashboard sees the pressure) but not unbounded
+    if (cost == ADMIT_ESSENTIAL) {
+        return inflight >= 2 * ADMIT_MAX_INFLIGHT ? ADMIT_REJECT_BUSY : ADMIT_ACCEPT;
+    }
+    if (level == ADMIT_LEVEL_CRITICAL) return ADMIT_REJECT_CRITICAL;
+    if (level == ADMIT_LEVEL_LOW && cost == ADMIT_EXPENSIVE) return ADMIT_REJECT_LOW;
+    if (inflight >= ADMIT_MAX_INFLIGHT) return ADMIT_REJECT_BUSY;
+    return ADMIT_ACCEPT;
+}
+
+AdmitVerdict admissionShedVerdict(AdmitLevel level) {
+    return level == ADMIT_LEVEL_CRITICAL ? ADMIT_REJECT_CRITICAL
+         : level == ADMIT_LEVEL_LOW      ? ADMIT_REJECT_LOW : ADMIT_REJECT_BUSY;
+}
+
+uint8_t admissionRetryAfter(AdmitVerdict verdict) {
+    switch (verdict) {
+        case ADMIT_REJECT_LOW:      return ADMIT_RETRY_LOW_S;
+        case ADMIT_REJECT_CRITICAL: return ADMIT_RETRY_CRITICAL_S;
+        case ADMIT_REJECT_WS:       return ADMIT_RETRY_LOW_S;
+        default:                    return ADMIT_RETRY_BUSY_S;
+    }
+}
+
+AdmitVerdict AdmissionGate::admit(AdmitLevel level, AdmitCost cost, bool upgrade, bool statusSocket,
+                                  uint32_t wsClients) {
+    AdmitVerdict v = admissionDecide(level, cost, statusSocket, inflight_, wsClients);
+    if (v == ADMIT_ACCEPT && !upgrade) inflight_++;
+    return v;
+}
@@ -0,0 +1,318 @@
+/*
+ * @file asset_cache.cpp
+ * @brief TigerTagScale - Arène RAM + handler AsyncWebServer pour les fichiers web
+ */
+
+#include "asset_cache.h"
+
+#include <ESPAsyncWebServer.h>
+
+static AssetEntry gEntries[ASSET_CACHE_MAX_ENTRIES];
+static size_t gCount = 0;
+static uint8_t* gArena = nullptr;
+static size_t gArenaLen = 0;
+static uint32_t gMisses = 0;
+static bool gEmbedded = false;
+
+static uint32_t fnv1a(const uint8_t* p, size_t n, uint32_t h = 2166136261u) {
+    while (n--) { h ^= *p++; h *= 16777619u; }
+    return h;
+}
+
+static uint32_t hashStr(const char* s) {
+    return fnv1a((const uint8_t*)s, strlen(s));
+}
+
+static bool endsWith(const char* s, const char* suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+static const char* mimeFor(const char* url) {
+    if (endsWith(url, ".html")) return "text/html; charset=utf-8";
+    if (endsWith(url, ".css"))  return "text/css";
+    if (endsWith(url, ".js"))   return "application/javascript";
+    if (endsWith(url, ".json")) return "application/json";
+    if (endsWith(url, ".svg"))  return "image/svg+xml";
+    if (endsWith(url, ".png"))  return "image/png";
+    if (endsWith(url, ".ico"))  return "image/x-icon";
+    return "application/octet-stream";
+}
+
+bool assetIsHashedUrl(const char* url) {
+    // "<stem>.<8 lowercase hex>.<ext>" as emitted by build_web.py
+    const char* ext = strrchr(url, '.');
+    if (!ext || ext - url < 10 || ext[-9] != '.') return false;
+    for (const char* p = ext - 8; p < ext; ++p) {
+        if (!((*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'f'))) return false;
+    }
+    return true;
+}
+
+// Hashed names never change content: cache for a year. Everything else
+// (index.html, sw.js, manifest, icons) may be stored but is revalidated
+// with If-None-Match on every use, which costs a 304 instead of the body.
+static const char* cacheControlFor(const AssetEntry& e) {
+    if (assetIsHashedUrl(e.url)) return ASSET_IMMUTABLE_CACHE_CONTROL;
+    return "no-cache";
+}
+
+const char* assetEncodingName(AssetEncoding encoding) {
+    switch (encoding) {
+        case ASSET_GZIP: return "gzip";
+        case ASSET_BR:   return "br";
+        default:         return "identity";
+    }
+}
+
+// "gzip, deflate, br" / "br;q=1.0, gzip;q=0.8, *;q=0.1" / "gzip;q=0"
+// Only q=0 matters here: among accepted encodings the server prefers the
+// smallest variant (br > gzip), whatever the client's relative weights.
+static uint8_t parseAcceptEncoding(const char* h) {
+    uint8_t mask = 1 << ASSET_IDENTITY;
+    while (*h) {
+        while (*h == ' ' || *h == ',') h++;
+        const char* tok = h;
+        while (*h && *h != ',' && *h != ';' && *h != ' ') h++;
+        size_t n = h - tok;
+        bool refused = false;
+        while (*h && *h != ',') {
+            if (*h == '=') {
+                const char* q = h + 1;
+                refused = atof(q) <= 0.0 && (*q == '0' || *q == '.');
+            }
+            h++;
+        }
+        if (n == 0 || refused) continue;
+        if (n == 2 && strncasecmp(tok, "br", 2) == 0) mask |= 1 << ASSET_BR;
+        else if (n == 4 && strncasecmp(tok, "gzip", 4) == 0) mask |= 1 << ASSET_GZIP;
+        else if (n == 1 && *tok == '*') mask |= (1 << ASSET_BR) | (1 << ASSET_GZIP);
+    }
+    return mask;
+}
+
+uint8_t assetAcceptedEncodings(AsyncWebServerRequest* request) {
+    if (!request->hasHeader("Accept-Encoding")) return 1 << ASSET_IDENTITY;
+    return parseAcceptEncoding(request->header("Accept-Encoding").c_str());
+}
+
+// Candidate gathered during the directory walk (pass 1)
+struct AssetFile {
+    char     path[ASSET_URL_MAX + 8];   // LittleFS path
+    uint32_t size;
+};
+
+static void collect(fs::FS& fs, const char* dir, size_t rootLen, AssetFile* files, uint8_t depth) {
+    File d = fs.open(dir);
+    if (!d || !d.isDirectory()) return;
+    File f = d.openNextFile();
+    while (f) {
+        // Arduino-ESP32 2.x returns the full path in name(); be tolerant of both forms
+        char path[ASSET_URL_MAX + 8];
+        const char* name = f.name();
+        if (name[0] == '/') strlcpy(path, name, sizeof(path));
+        else snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+        if (f.isDirectory()) {
+            if (depth > 0) collect(fs, path, rootLen, files, depth - 1);
+        } else if (f.size() <= ASSET_CACHE_MAX_FILE && strlen(path) - rootLen < ASSET_URL_MAX
+                   && gCount < ASSET_CACHE_MAX_ENTRIES) {
+            // Every variant gets its own entry: "/script.js.br" → ("/script.js", br)
+            AssetEntry& e = gEntries[gCount];
+            strlcpy(e.url, path + rootLen, sizeof(e.url));
+            e.encoding = ASSET_IDENTITY;
+            if (endsWith(e.url, ".gz")) { e.encoding = ASSET_GZIP; e.url[strlen(e.url) - 3] = '\0'; }
+            else if (endsWith(e.url, ".br")) { e.encoding = ASSET_BR; e.url[strlen(e.url) - 3] = '\0'; }
+            strlcpy(files[gCount].path, path, sizeof(files[gCount].path));
+            files[gCount].size = f.size();
+            gCount++;
+        }
+        f = d.openNextFile();
+    }
+}
+
+void assetCacheBeginEmbedded(const EmbeddedAsset* assets, size_t count) {
+    gCount = 0;
+    for (size_t i = 0; i < count && gCount < ASSET_CACHE_MAX_ENTRIES; ++i) {
+        AssetEntry& e = gEntries[gCount++];
+        strlcpy(e.url, assets[i].url, sizeof(e.url));
+        e.urlHash = hashStr(e.url);
+        e.data = assets[i].data;
+        e.len = assets[i].len;
+        e.mime = mimeFor(e.url);
+        e.encoding = (AssetEncoding)assets[i].encoding;
+        strlcpy(e.etag, assets[i].etag, sizeof(e.etag));
+        e.hits = 0;
+    }
+    gEmbedded = true;
+    Serial.printf("[ASSETS] %u fichiers embarqués dans le firmware\n", (unsigned)gCount);
+}
+
+void assetCacheBegin(fs::FS& fs, const char* root) {
+    if (gEmbedded) return;   // the firmware already carries the UI
+    if (gArena) { free(gArena); gArena = nullptr; }
+    gArenaLen = 0;
+    gCount = 0;
+
+    static AssetFile files[ASSET_CACHE_MAX_ENTRIES];
+    collect(fs, root, strlen(root), files, 2);
+
+    // Fit as many entries as the budget allows, smallest first (HTML/CSS/JS gz)
+    size_t budget = ASSET_CACHE_MAX_BYTES;
+    size_t maxBlock = ESP.getMaxAllocHeap();
+    if (maxBlock < ASSET_CACHE_HEAP_RESERVE) budget = 0;
+    else if (maxBlock - ASSET_CACHE_HEAP_RESERVE < budget) budget = maxBlock - ASSET_CACHE_HEAP_RESERVE;
+
+    // Identity copies of compressible files are skipped: every browser sends
+    // gzip, and the rare client that does not is served by LittleFS.
+    bool skip[ASSET_CACHE_MAX_ENTRIES] = {};
+    for (size_t i = 0; i < gCount; ++i) {
+        for (size_t j = 0; j < gCount && gEntries[i].encoding == ASSET_IDENTITY; ++j) {
+            if (gEntries[j].encoding != ASSET_IDENTITY && strcmp(gEntries[i].url, gEntries[j].url) == 0) skip[i] = true;
+        }
+    }
+
+    bool keep[ASSET_CACHE_MAX_ENTRIES] = {};
+    size_t total = 0;
+    for (;;) {
+        int best = -1;
+        for (size_t i = 0; i < gCount; ++i) {
+            if (!keep[i] && !skip[i] && (best < 0 || files[i].size < files[best].size)) best = (int)i;
+        }
+        if (best < 0 || total + files[best].size > budget) break;
+        keep[best] = true;
+        total += files[best].size;
+    }
+
+    if (total) gArena = (uint8_t*)malloc(total);
+    size_t n = 0, off = 0;
+    for (size_t i = 0; gArena && i < gCount; ++i) {
+        if (!keep[i]) continue;
+        File f = fs.open(files[i].path, "r");
+        if (!f) continue;
+        size_t got = f.read(gArena + off, files[i].size);
+        f.close();
+        if (got != files[i].size) continue;
+
+        AssetEntry e = gEntries[i];
+        e.data = gArena + off;
+        e.len = got;
+        e.mime = mimeFor(e.url);
+        e.urlHash = hashStr(e.url);
+        e.hits = 0;
+        snprintf(e.etag, sizeof(e.etag), "\"%08x\"", fnv1a(e.data, e.len));
+        gEntries[n++] = e;   // compact: n <= i
+        off += got;
+    }
+    gCount = n;
+    gArenaLen = off;
+    Serial.printf("[ASSETS] %u fichiers en RAM (%u octets), le reste via LittleFS\n",
+                  (unsigned)gCount, (unsigned)gArenaLen);
+}
+
+static AssetEntry* findEntry(const char* url, uint8_t acceptMask) {
+    if (strcmp(url, "/") == 0) url = "/index.html";
+    uint32_t h = hashStr(url);
+    AssetEntry* best = nullptr;
+    for (size_t i = 0; i < gCount; ++i) {
+        AssetEntry& e = gEntries[i];
+        if (e.urlHash != h || strcmp(e.url, url) != 0) continue;
+        if (!(acceptMask & (1 << e.encoding))) continue;
+        if (!best || e.encoding > best->encoding) best = &e;
+    }
+    return best;
+}
+
+const AssetEntry* assetCacheFind(const char* url, uint8_t acceptMask) {
+    return findEntry(url, acceptMask);
+}
+
+// Same ETag as a RAM entry holding these bytes. Only small files are hashed
+// (the ones the cache would hold): a 190 KB favicon.ico is not read per request.
+static bool fsEtag(fs::FS& fs, const String& file, char* etag, size_t len) {
+    File f = fs.open(file, "r");
+    if (!f || f.size() > ASSET_CACHE_MAX_FILE) return false;
+    uint8_t buf[256];
+    uint32_t h = 2166136261u;
+    size_t n;
+    while ((n = f.read(buf, sizeof(buf))) > 0) h = fnv1a(buf, n, h);
+    f.close();
+    snprintf(etag, len, "\"%08x\"", h);
+    return true;
+}
+
+AsyncWebServerResponse* assetBeginFsResponse(AsyncWebServerRequest* request, fs::FS& fs,
+                                             const char* path, const char* mime) {
+    static const char* const kSuffix[] = { "", ".gz", ".br" };
+    uint8_t mask = assetAcceptedEncodings(request);
+    for (int enc = ASSET_BR; enc >= ASSET_IDENTITY; --enc) {
+        if (!(mask & (1 << enc))) continue;
+        String file = String(path) + kSuffix[enc];
+        if (!fs.exists(file)) continue;
+        char etag[12];
+        bool hasEtag = fsEtag(fs, file, etag, sizeof(etag));
+        AsyncWebServerResponse *response;
+        if (hasEtag && request->hasHeader("If-None-Match") && request->header("If-None-Match").equals(etag)) {
+            response = request->beginResponse(304);
+        } else {
+            response = request->beginResponse(fs, file, mime ? mime : mimeFor(path));
+            if (enc != ASSET_IDENTITY) response->addHeader("Content-Encoding", assetEncodingName((AssetEncoding)enc));
+        }
+        if (hasEtag) response->addHeader("ETag", etag);
+        response->addHeader("Vary", "Accept-Encoding");
+        return response;
+    }
+    return nullptr;
+}
+
+class AssetCacheHandler : public AsyncWebHandler {
+public:
+    bool canHandle(AsyncWebServerRequest *request) override {
+        if (request->method() != HTTP_GET) return false;
+        // Headers are still all present here; keep the ones handleRequest() reads
+        request->addInterestingHeader("Accept-Encoding");
+        request->addInterestingHeader("If-None-Match");
+        if (!findEntry(request->url().c_str(), assetAcceptedEncodings(request))) {
+            const String& url = request->url();
+            if (!url.startsWith("/api/") && !url.startsWith("/ws")) gMisses++;
+            return false;
+        }
+        return true;
+    }
+
+    void handleRequest(AsyncWebServerRequest *request) override {
+        AssetEntry* e = findEntry(request->url().c_str(), assetAcceptedEncodings(request));
+        if (!e) { request->send(404); return; }
+        e->hits++;
+        if (request->hasHeader("If-None-Match") &&
+            request->header("If-None-Match").equals(e->etag)) {
+            AsyncWebServerResponse *response = request->beginResponse(304);
+            response->addHeader("ETag", e->etag);
+            response->addHeader("Cache-Control", cacheControlFor(*e));
+            response->addHeader("Vary", "Accept-Encoding");
+            request->send(response);
+            return;
+        }
+        // Zero-copy: the response reads straight from the arena or the
+        // flash-mapped PROGMEM array (memcpy_P == memcpy on ESP32)
+        AsyncWebServerResponse *response = request->beginResponse_P(200, e->mime, e->data, e->len);
+        if (e->encoding != ASSET_IDENTITY) response->addHeader("Content-Encoding", assetEncodingName(e->encoding));
+        // Caches (browser, proxies) must key the body on the encoding as well
+        response->addHeader("Vary", "Accept-Encoding");
+        response->addHeader("Cache-Control", cacheControlFor(*e));
+        response->addHeader("ETag", e->etag);
+        request->send(response);
+    }
+};
+
+static AssetCacheHandler gHandler;
+
+void assetCacheAttach(AsyncWebServer& server) {
+    server.addHandler(&gHandler);
+}
+
+size_t assetCacheCount() { return gCount; }
+const AssetEntry* assetCacheEntry(size_t i) { return i < gCount ? &gEntries[i] : nullptr; }
+size_t assetCacheArenaBytes() { return gArenaLen; }
+bool assetCacheEmbedded() { return gEmbedded; }
+uint32_t assetCacheMisses() { return gMisses; }
@@ -0,0 +1,103 @@
+/*
+ * @file deferred_jobs.cpp
+ * @brief TigerTagScale - File fixe de travaux + anneau des derniers résultats
+ */
+
+#include "deferred_jobs.h"
+
+static Job gQueue[JOB_QUEUE_SLOTS];
+static uint8_t gHead = 0;       // next job to run
+static uint8_t gCount = 0;
+static JobResult gResults[JOB_RESULT_SLOTS];
+static uint32_t gNextId = 1;
+static portMUX_TYPE gJobMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Caller holds gJobMux. Slot chosen by id so lookups are O(1).
+static JobResult& resultSlot(uint32_t id) {
+    return gResults[id % JOB_RESULT_SLOTS];
+}
+
+uint32_t jobEnqueue(JobType type, const char* arg, int32_t value,
+                    uint32_t wsClient, uint32_t delayMs) {
+    uint32_t id = 0;
+    portENTER_CRITICAL(&gJobMux);
+    if (gCount < JOB_QUEUE_SLOTS) {
+        id = gNextId++;
+        if (gNextId == 0) gNextId = 1;   // 0 means "rejected"
+        Job& j = gQueue[(gHead + gCount) % JOB_QUEUE_SLOTS];
+        j.id = id;
+        j.type = type;
+        j.wsClient = wsClient;
+        j.notBeforeMs = millis() + delayMs;
+        j.value = value;
+        strlcpy(j.arg, arg ? arg : "", sizeof(j.arg));
+        gCount++;
+
+        JobResult& r = resultSlot(id);
+        r.id = id;
+        r.type = type;
+        r.state = JOB_QUEUED;
+        r.code = 0;
+        r.detail[0] = '\0';
+    }
+    portEXIT_CRITICAL(&gJobMux);
+    return id;
+}
+
+bool jobNext(Job& out) {
+    bool got = false;
+    portENTER_CRITICAL(&gJobMux);
+    // Strict FIFO: a delayed job (reboot) holds back the ones queued after it
+    if (gCount && (int32_t)(millis() - gQueue[gHead].notBeforeMs) >= 0) {
+        out = gQueue[gHead];
+        gHead = (gHead + 1) % JOB_QUEUE_SLOTS;
+        gCount--;
+        JobResult& r = resultSlot(out.id);
+        if (r.id == out.id) r.state = JOB_RUNNING;
+        got = true;
+    }
+    portEXIT_CRITICAL(&gJobMux);
+    return got;
+}
+
+void jobFinish(uint32_t id, bool ok, int code, const char* detail) {
+    portENTER_CRITICAL(&gJobMux);
+    JobResult& r = resultSlot(id);
+    if (r.id == id) {
+        r.state = ok ? JOB_DONE : JOB_FAILED;
+        r.code = (int16_t)code;
+        strlcpy(r.detail, detail ? detail : "", sizeof(r.detail));
+    }
+    portEXIT_CRITICAL(&gJobMux);
+}
+
+bool jobLookup(uint32_t id, JobResult& out) {
+    bool found = false;
+    portENTER_CRITICAL(&gJobMux);
+    const JobResult& r = resultSlot(id);
+    if (id != 0 && r.id == id) { out = r; found = true; }
+    portEXIT_CRITICAL(&gJobMux);
+    return found;
+}
+
+const char* jobTypeName(JobType type) {
+    switch (type) {
+        case JOB_VALIDATE_API_KEY: return "apiKey";
+        case JOB_DELETE_API_KEY:   return "deleteApiKey";
+        case JOB_PUSH_WEIGHT:      return "pushWeight";
+        case JOB_RESET_WIFI:       return "resetWifi";
+        case JOB_FACTORY_RESET:    return "factoryReset";
+        case JOB_TARE:             return "tare";
+        default:                   return "none";
+    }
+}
+
+const char* jobStateName(JobState state) {
+    switch (state) {
+        case JOB_QUEUED:  return "queued";
+        case JOB_RUNNING: return "running";
+        case JOB_DONE:    return "done";
+        case JOB_FAILED:  return "failed";
+        default:          return "unknown";
+    }
+}
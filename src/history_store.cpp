@@ -0,0 +1,239 @@
+/*
+ * @file history_store.cpp
+ * @brief TigerTagScale - Paliers 1 s / 1 min / 10 min, recherche et sous-échantillonnage
+ */
+
+#include "history_store.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* const kTierNames[HISTORY_TIERS] = { "1s", "1m", "10m" };
+static const uint32_t kTierSteps[HISTORY_TIERS] = { 1, 60, 600 };
+
+HistoryStore::HistoryStore(void (*enter)(), void (*exit)())
+    : ring0_(), ring1_(), ring2_(), tiers_(), enter_(enter), exit_(exit) {
+    tiers_[0].slots = HISTORY_T0_SLOTS;
+    tiers_[0].ring = ring0_;
+    tiers_[1].slots = HISTORY_T1_SLOTS;
+    tiers_[1].ring = ring1_;
+    tiers_[2].slots = HISTORY_T2_SLOTS;
+    tiers_[2].ring = ring2_;
+}
+
+const char* HistoryStore::tierName(uint8_t level) {
+    return kTierNames[level];
+}
+
+uint32_t HistoryStore::tierStep(uint8_t level) {
+    return kTierSteps[level];
+}
+
+void HistoryStore::accumulate(uint8_t level, uint32_t t, float mean, float mn, float mx) {
+    Tier& tier = tiers_[level];
+    uint32_t period = t - t % kTierSteps[level];
+
+    if (tier.accN && period != tier.accT) {
+        HistoryBucket b = { tier.accT, tier.accSum / tier.accN, tier.accMin, tier.accMax };
+        enter();
+        tier.ring[tier.head % tier.slots] = b;
+        tier.head++;
+        exit();
+        // Each finished bucket weighs the same in the coarser tier
+        if (level + 1 < HISTORY_TIERS) accumulate(level + 1, b.t, b.mean, b.min, b.max);
+        tier.accN = 0;
+    }
+    if (tier.accN == 0) {
+        tier.accT = period;
+        tier.accSum = 0.0f;
+        tier.accMin = mn;
+        tier.accMax = mx;
+    }
+    tier.accSum += mean;
+    tier.accN++;
+    if (mn < tier.accMin) tier.accMin = mn;
+    if (mx > tier.accMax) tier.accMax = mx;
+}
+
+void HistoryStore::addSample(float grams, uint32_t nowS) {
+    if (isnan(grams)) return;
+    accumulate(0, nowS, grams, grams, grams);
+}
+
+bool HistoryStore::readBucket(uint8_t level, uint32_t idx, HistoryBucket& out) const {
+    const Tier& tier = tiers_[level];
+    bool ok = false;
+    enter();
+    if (idx < tier.head && tier.head - idx <= tier.slots) {
+        out = tier.ring[idx % tier.slots];
+        ok = true;
+    }
+    exit();
+    return ok;
+}
+
+void HistoryStore::bounds(uint8_t level, uint32_t& oldest, uint32_t& head) const {
+    const Tier& tier = tiers_[level];
+    enter();
+    head = tier.head;
+    exit();
+    oldest = head > tier.slots ? head - tier.slots : 0;
+}
+
+uint8_t HistoryStore::pickTier(uint32_t from) const {
+    for (uint8_t level = 0; level < HISTORY_TIERS; ++level) {
+        uint32_t oldest, head;
+        bounds(level, oldest, head);
+        HistoryBucket b;
+        if (oldest == 0 || (readBucket(level, oldest, b) && b.t <= from)) return level;
+    }
+    return HISTORY_TIERS - 1;
+}
+
+uint32_t HistoryStore::lowerBound(uint8_t level, uint32_t t) const {
+    uint32_t lo, hi;
+    bounds(level, lo, hi);
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        HistoryBucket b;
+        if (!readBucket(level, mid, b) || b.t < t) lo = mid + 1;   // evicted meanwhile: move right
+        else hi = mid;
+    }
+    return lo;
+}
+
+// ============================================================================
+// REQUÊTES
+// ============================================================================
+
+void historyQueryBegin(const HistoryStore& store, HistoryQuery& q, uint32_t from, uint32_t to,
+                       uint16_t points, HistoryMode mode, uint32_t nowS) {
+    q = HistoryQuery();
+    q.now = nowS;
+    q.from = from;
+    q.to = to;
+    q.mode = mode;
+    q.points = points < 2 ? 2 : points > HISTORY_MAX_POINTS ? HISTORY_MAX_POINTS : points;
+    if (mode == HISTORY_LTTB && q.points < 3) q.mode = HISTORY_MINMAX;
+    q.level = store.pickTier(from);
+    q.lo = store.lowerBound(q.level, from);
+    uint32_t hi = store.lowerBound(q.level, to + 1);
+    q.n = hi > q.lo ? hi - q.lo : 0;
+    q.decimate = q.n > q.points;
+    q.phase = QUERY_HEADER;
+}
+
+// Envelope of buckets [a, b) (relative indices)
+static bool aggregate(const HistoryStore& store, const HistoryQuery& q, uint32_t a, uint32_t b,
+                      HistoryBucket& out) {
+    uint32_t count = 0;
+    float sum = 0.0f;
+    for (uint32_t i = a; i < b; ++i) {
+        HistoryBucket x;
+        if (!store.readBucket(q.level, q.lo + i, x)) continue;
+        if (count == 0) out = x;
+        else {
+            if (x.min < out.min) out.min = x.min;
+            if (x.max > out.max) out.max = x.max;
+        }
+        sum += x.mean;
+        count++;
+    }
+    if (count) out.mean = sum / count;
+    return count > 0;
+}
+
+// One LTTB step (1 .. points-2): the bucket of [a, b) forming the largest
+// triangle with the previous pick and the mean of the following range [b, c).
+static bool lttbPick(const HistoryStore& store, HistoryQuery& q, uint32_t a, uint32_t b, uint32_t c,
+                     HistoryBucket& out) {
+    float avgT = 0.0f, avgY = 0.0f;
+    uint32_t count = 0;
+    for (uint32_t i = b; i < c; ++i) {
+        HistoryBucket x;
+        if (!store.readBucket(q.level, q.lo + i, x)) continue;
+        avgT += x.t;
+        avgY += x.mean;
+        count++;
+    }
+    if (count) { avgT /= count; avgY /= count; }
+
+    float best = -1.0f;
+    for (uint32_t i = a; i < b; ++i) {
+        HistoryBucket x;
+        if (!store.readBucket(q.level, q.lo + i, x)) continue;
+        if (!q.havePrev) { q.prev = x; q.havePrev = true; }
+        float area = fabsf(((float)q.prev.t - avgT) * (x.mean - q.prev.mean) -
+                           ((float)q.prev.t - x.t) * (avgY - q.prev.mean));
+        if (area > best) { best = area; out = x; }
+    }
+    return best >= 0.0f;
+}
+
+bool historyQueryNext(const HistoryStore& store, HistoryQuery& q, HistoryBucket& out) {
+    for (;;) {
+        if (!q.decimate) {
+            if (q.step >= q.n) return false;
+            if (store.readBucket(q.level, q.lo + q.step++, out)) return true;
+            continue;
+        }
+        if (q.step >= q.points) return false;
+        uint32_t i = q.step++;
+        bool ok;
+        if (q.mode == HISTORY_MINMAX) {
+            ok = aggregate(store, q, (uint64_t)i * q.n / q.points, (uint64_t)(i + 1) * q.n / q.points, out);
+        } else if (i == 0 || i == (uint32_t)q.points - 1) {
+            // LTTB always keeps the first and last buckets
+            ok = store.readBucket(q.level, q.lo + (i ? q.n - 1 : 0), out);
+        } else {
+            float every = (float)(q.n - 2) / (q.points - 2);
+            uint32_t a = (uint32_t)((i - 1) * every) + 1;
+            uint32_t b = (uint32_t)(i * every) + 1;
+            uint32_t c = (uint32_t)((i + 1) * every) + 1;
+            if (c > q.n) c = q.n;
+            ok = lttbPick(store, q, a, b, c, out);
+        }
+        if (!ok) continue;
+        q.prev = out;
+        q.havePrev = true;
+        return true;
+    }
+}
+
+bool historyQueryRender(const HistoryStore& store, HistoryQuery& q) {
+    q.outPos = 0;
+    q.outLen = 0;
+    int len = 0;
+    switch (q.phase) {
+        case QUERY_HEADER:
+            len = snprintf(q.out, sizeof(q.out),
+                           "{\"tier\":\"%s\",\"step\":%u,\"now\":%u,\"from\":%u,\"to\":%u,\"mode\":\"%s\",\"points\":[",
+                           HistoryStore::tierName(q.level), (unsigned)HistoryStore::tierStep(q.level),
+                           (unsigned)q.now, (unsigned)q.from, (unsigned)q.to,
+                           !q.decimate ? "raw" : (q.mode == HISTORY_LTTB ? "lttb" : "minmax"));
+            q.phase = QUERY_POINTS;
+            break;
+        case QUERY_POINTS: {
+            HistoryBucket b;
+            if (historyQueryNext(store, q, b)) {
+                len = snprintf(q.out, sizeof(q.out), "%s[%u,%.1f,%.1f,%.1f]",
+                               q.emitted ? "," : "", (unsigned)b.t, b.mean, b.min, b.max);
+                q.emitted++;
+                break;
+            }
+            q.phase = QUERY_FOOTER;
+        }
+        // fall through
+        case QUERY_FOOTER:
+            len = snprintf(q.out, sizeof(q.out), "],\"count\":%u}", (unsigned)q.emitted);
+            q.phase = QUERY_DONE;
+            break;
+        case QUERY_DONE:
+            return false;
+    }
+    if (len < 0) len = 0;
+    if (len > (int)sizeof(q.out) - 1) len = sizeof(q.out) - 1;
+    q.outLen = (uint16_t)len;
+    return true;
+}
@@ -0,0 +1,234 @@
+/*
+ * @file json_stream.cpp
+ * @brief TigerTagScale - Tokenizer JSON incrémental (objet racine, valeurs scalaires)
+ */
+
+#include "json_stream.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool isWs(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+static int hexVal(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void JsonStreamParser::begin(JsonFieldCallback cb, void* ctx) {
+    _cb = cb;
+    _ctx = ctx;
+    _error = nullptr;
+    _state = ST_START;
+    _escape = false;
+    _skipInString = false;
+    _skipEscape = false;
+    _afterComma = false;
+    _unicodeLeft = 0;
+    _unicode = 0;
+    _skipDepth = 0;
+    _len = 0;
+    _keyTruncated = false;
+    _key[0] = '\0';
+    _buf[0] = '\0';
+}
+
+bool JsonStreamParser::fail(const char* why) {
+    _state = ST_ERROR;
+    _error = why;
+    return false;
+}
+
+bool JsonStreamParser::appendChar(char c) {
+    if (_len + 1 >= JSON_STREAM_VALUE_MAX) return fail("value too long");
+    _buf[_len++] = c;
+    return true;
+}
+
+void JsonStreamParser::emit(JsonValueType type) {
+    _buf[_len] = '\0';
+    // Keys longer than the buffer cannot match any field: skip silently
+    if (_cb && !_keyTruncated) _cb(_ctx, _key, type, _buf, _len);
+    _len = 0;
+}
+
+// Shared by keys and string values; both are accumulated in _buf.
+bool JsonStreamParser::stringChar(char c, bool isKey) {
+    if (_unicodeLeft) {
+        int h = hexVal(c);
+        if (h < 0) return fail("bad \\u escape");
+        _unicode = (uint16_t)((_unicode << 4) | h);
+        if (--_unicodeLeft) return true;
+        uint16_t u = _unicode;
+        if (u >= 0xD800 && u <= 0xDFFF) return appendChar('?'); // surrogates unsupported
+        if (u < 0x80) return appendChar((char)u);
+        if (u < 0x800) {
+            return appendChar((char)(0xC0 | (u >> 6))) && appendChar((char)(0x80 | (u & 0x3F)));
+        }
+        return appendChar((char)(0xE0 | (u >> 12))) &&
+               appendChar((char)(0x80 | ((u >> 6) & 0x3F))) &&
+               appendChar((char)(0x80 | (u & 0x3F)));
+    }
+    if (_escape) {
+        _escape = false;
+        switch (c) {
+            case '"': case '\\': case '/': return appendChar(c);
+            case 'b': return appendChar('\b');
+            case 'f': return appendChar('\f');
+            case 'n': return appendChar('\n');
+            case 'r': return appendChar('\r');
+            case 't': return appendChar('\t');
+            case 'u': _unicodeLeft = 4; _unicode = 0; return true;
+            default:  return fail("bad escape");
+        }
+    }
+    if (c == '\\') { _escape = true; return true; }
+    if ((uint8_t)c < 0x20) return fail("control char in string");
+    if (c != '"') {
+        if (isKey && _len + 1 >= JSON_STREAM_KEY_MAX) { _keyTruncated = true; return true; }
+        return appendChar(c);
+    }
+
+    // Closing quote
+    if (isKey) {
+        _buf[_len] = '\0';
+        if (_len + 1 > JSON_STREAM_KEY_MAX) _keyTruncated = true;
+        else memcpy(_key, _buf, _len + 1);
+        _len = 0;
+        _state = ST_COLON;
+    } else {
+        emit(JSON_VALUE_STRING);
+        _state = ST_COMMA_OR_END;
+    }
+    return true;
+}
+
+bool JsonStreamParser::endLiteral() {
+    _buf[_len] = '\0';
+    if (strcmp(_buf, "true") == 0 || strcmp(_buf, "false") == 0) {
+        emit(JSON_VALUE_BOOL);
+    } else if (strcmp(_buf, "null") == 0) {
+        emit(JSON_VALUE_NULL);
+    } else {
+        // Number: validate the JSON grammar loosely (sign, digits, fraction, exponent)
+        const char* p = _buf;
+        if (*p == '-') p++;
+        if (*p < '0' || *p > '9') return fail("bad literal");
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p == '.') { p++; if (*p < '0' || *p > '9') return fail("bad number"); while (*p >= '0' && *p <= '9') p++; }
+        if (*p == 'e' || *p == 'E') {
+            p++;
+            if (*p == '+' || *p == '-') p++;
+            if (*p < '0' || *p > '9') return fail("bad number");
+            while (*p >= '0' && *p <= '9') p++;
+        }
+        if (*p) return fail("bad number");
+        emit(JSON_VALUE_NUMBER);
+    }
+    _state = ST_COMMA_OR_END;
+    return true;
+}
+
+bool JsonStreamParser::step(char c) {
+    switch (_state) {
+        case ST_START:
+            if (isWs(c)) return true;
+            if (c != '{') return fail("expected object");
+            _state = ST_KEY_OR_END;
+            _afterComma = false;
+            return true;
+
+        case ST_KEY_OR_END:
+            if (isWs(c)) return true;
+            if (c == '"') { _len = 0; _keyTruncated = false; _state = ST_KEY; return true; }
+            if (c == '}' && !_afterComma) { _state = ST_DONE; return true; }
+            return fail("expected key");
+
+        case ST_KEY:
+            return stringChar(c, true);
+
+        case ST_COLON:
+            if (isWs(c)) return true;
+            if (c != ':') return fail("expected ':'");
+            _state = ST_VALUE;
+            return true;
+
+        case ST_VALUE:
+            if (isWs(c)) return true;
+            _len = 0;
+            if (c == '"') { _state = ST_STRING; return true; }
+            if (c == '{' || c == '[') {
+                _state = ST_SKIP;
+                _skipDepth = 1;
+                _skipInString = false;
+                _skipEscape = false;
+                return true;
+            }
+            if (c == '-' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')) {
+                _state = ST_LITERAL;
+                return appendChar(c);
+            }
+            return fail("expected value");
+
+        case ST_STRING:
+            return stringChar(c, false);
+
+        case ST_LITERAL:
+            if (isWs(c) || c == ',' || c == '}') {
+                if (!endLiteral()) return false;
+                return isWs(c) ? true : step(c); // reprocess the delimiter
+            }
+            return appendChar(c);
+
+        case ST_SKIP:
+            // Nested containers are not decoded, only balanced
+            if (_skipInString) {
+                if (_skipEscape) _skipEscape = false;
+                else if (c == '\\') _skipEscape = true;
+                else if (c == '"') _skipInString = false;
+                return true;
+            }
+            if (c == '"') _skipInString = true;
+            else if (c == '{' || c == '[') {
+                if (++_skipDepth > 32) return fail("nesting too deep");
+            }
+            else if (c == '}' || c == ']') {
+                if (--_skipDepth == 0) _state = ST_COMMA_OR_END;
+            }
+            return true;
+
+        case ST_COMMA_OR_END:
+            if (isWs(c)) return true;
+            if (c == ',') { _state = ST_KEY_OR_END; _afterComma = true; return true; }
+            if (c == '}') { _state = ST_DONE; return true; }
+            return fail("expected ',' or '}'");
+
+        case ST_DONE:
+            if (isWs(c)) return true;
+            return fail("trailing data");
+
+        case ST_ERROR:
+        default:
+            return false;
+    }
+}
+
+bool jsonParseFloat(JsonValueType type, const char* value, float& out) {
+    if (type != JSON_VALUE_NUMBER && type != JSON_VALUE_STRING) return false;
+    char* end = nullptr;
+    float f = strtof(value, &end);
+    if (end == value || *end != '\0' || !isfinite(f)) return false;
+    out = f;
+    return true;
+}
+
+bool JsonStreamParser::feed(const uint8_t* data, size_t len) {
+    if (_state == ST_ERROR) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (!step((char)data[i])) return false;
+    }
+    return true;
+}
@@ -17,9 +17,26 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
 #include <HX711.h>
-#include <MFRC522.h>
-#include <SPI.h>
 #include <LittleFS.h>  // ← AJOUTÉ pour filesystem
+#include "mqtt_publisher.h"
+#include "json_stream.h"
+#include "status_json.h"
+#include "sample_stream.h"
+#include "deferred_jobs.h"
+#include "asset_cache.h"
+#include "weight_history.h"
+#include "metrics.h"
+#include "admission.h"
+#include "rfid_reader.h"
+#include "rc522_spi.h"
+#include "tigertag.h"
+#include "tag_cache.h"
+#include "oled_panel.h"
+#include "oled_notify.h"
+#include "ws_clients.h"
+#ifdef WEB_ASSETS_EMBEDDED
+#include "web_assets.h"   // generated by scripts/build_web.py
+#endif
 
 // ============================================================================
 // CONFIGURATION MATERIELLE
@@ -30,14 +47,27 @@
 #define OLED_HEIGHT 64
 #define OLED_RESET -1
 #define OLED_ADDR 0x3C
+#define OLED_I2C_MAX_HZ 1000000   // highest clock tried; the panel's ACK decides
+#define OLED_TASK_CORE 0          // loop() runs on core 1
+#define OLED_NOTIFY_Y 36          // top of the notification band (3 text rows)
+
+// Notification durations; the weight stays on screen meanwhile
+#define NOTIFY_RESULT_MS   1500
+#define NOTIFY_ERROR_MS    3000
+#define NOTIFY_SENDING_MS  15000   // replaced by the push result (same key)
+#define NOTIFY_KEY_PUSH    1
+#define NOTIFY_KEY_API     2
 
 // RFID RC522 (SPI)
 #define RC522_SS    5
 #define RC522_RST   27
+#define RC522_IRQ   -1      // RC522 IRQ → a free GPIO (e.g. 26) for interrupt-driven detection; -1 = polling
 
 // HX711 Balance
 #define HX711_DOUT  32
 #define HX711_SCK   33
+#define CAL_FACTOR_MIN 0.001f   // |factor| bounds accepted by /api/calibration
+#define CAL_FACTOR_MAX 1e6f
 
 // LED Heartbeat
 #define LED_PIN     2
@@ -45,17 +75,27 @@
 // WebSocket update interval (ms)
 #define WS_UPDATE_INTERVAL_MS 250
 
+// WebSocket push: deltas on change (at most every WS_MIN_INTERVAL_MS), keepalive when idle
+#define WS_MIN_INTERVAL_MS      100
+#define WS_KEEPALIVE_MS         10000
+#define WS_CONGESTED_SPACE      512   // TCP send space (bytes) below which a client counts as slow
+
 // mDNS
 #define MDNS_NAME   "tigerscale"
 
 // mDNS lifecycle helpers
 void startMDNS();
 void onWiFiEvent(WiFiEvent_t event);
+void cacheWifiInfo();
 
 // Unique Setup SSID + mDNS name derived from MAC
 String gSetupSsid;     // e.g. Setup-TigerScale-AB12
 String gMdnsName;      // e.g. tigerscale-AB12
 
+// SSID / IP cached on WiFi events (avoid WiFi.SSID()/localIP().toString() per request)
+char gWifiSsid[33] = "";
+char gWifiIp[16] = "0.0.0.0";
+
 static String macSuffix4() {
     uint8_t mac[6];
     WiFi.macAddress(mac); // MAC[0]..MAC[5]
@@ -72,10 +112,11 @@ static String makeSetupSSID() {
 // OBJETS GLOBAUX
 // ============================================================================
 
-Adafruit_SSD1306 display(OLED_WIDTH, OLED_HEIGHT, &Wire, OLED_RESET);
+OledPanel display(OLED_WIDTH, OLED_HEIGHT, &Wire, OLED_RESET);   // differential flush
+OledNotifyQueue gNotices;   // loop() only
 HX711 scale;
-MFRC522 rfid(RC522_SS, RC522_RST);
 AsyncWebServer server(80);
+AsyncWebSocket ws("/ws");
 Preferences prefs;
 WiFiManager wm;
 
@@ -89,6 +130,14 @@ bool apiValid = false;          // last known validation state
 uint32_t lastApiBroadcastMs = 0; // WS broadcast throttle for apiStatus
 float calibrationFactor = 406;
 float currentWeight = 0.0;
+float displayedWeight = 0.0f;   // hold-aware value shown on OLED / UI
+
+// Raw HX711 counts per gram: finite, non-zero, within a sane magnitude
+static bool calibrationFactorValid(float f) {
+    float a = fabsf(f);
+    return a >= CAL_FACTOR_MIN && a <= CAL_FACTOR_MAX;   // false for NaN
+}
+
 // --- Hold mode variables ---
 bool holdMode = false;
 float holdWeight = 0.0f;
@@ -96,8 +145,17 @@ uint32_t holdStartMs = 0;
 const float HOLD_THRESHOLD_ENTER = 0.5f;
 const float HOLD_THRESHOLD_EXIT = 1.5f;
 const uint32_t HOLD_TIME_MS = 700;
-String lastUID = "";       // decimal UID for API/UI
-String lastUIDHex = "";    // hex UID for logs/debug
+TagUid currentUid;                          // tag the weight belongs to (empty = none)
+char currentUidDec[TAG_UID_DEC_LEN] = "";   // decimal UID for API/UI/cloud
+char currentUidHex[TAG_UID_HEX_LEN] = "";   // hex UID for logs/debug
+TigerTagInfo gSpool = {};  // TigerTag pages of the current tag (valid = false if none)
+
+// Formats once per change: payloads and the OLED then reuse the text forms
+static void setCurrentUid(const TagUid& uid) {
+    currentUid = uid;
+    uid.toDec(currentUidDec, sizeof(currentUidDec));
+    uid.toHex(currentUidHex, sizeof(currentUidHex));
+}
 
 bool wifiConnected = false;
 bool cloudOK = false; // true if health endpoint returns {"ok":true}
@@ -115,6 +173,7 @@ const int   MEDIAN_WINDOW = 5;     // odd number; 5 is a good trade-off
 
 // State
 float lastPushedWeight = NAN;
+bool currentPushed = false;     // current tag's weight was sent; no auto-push until it leaves
 uint32_t stableSinceMs = 0;
 float stableCandidate = NAN;
 uint32_t lastPushMs = 0;
@@ -126,6 +185,19 @@ static float gMedianBuf[MEDIAN_WINDOW] = {0};
 static int   gMedianIdx = 0;
 static int   gMedianCount = 0; // <= MEDIAN_WINDOW
 
+// After a tare the pre-tare samples would drag the EMA down over ~2 s:
+// restart the filters and the hold so the next reading is the new zero
+static void resetWeightFilter() {
+    gEmaInit = false;
+    gMedianIdx = 0;
+    gMedianCount = 0;
+    currentWeight = 0.0f;
+    displayedWeight = 0.0f;
+    holdMode = false;
+    holdStartMs = 0;
+    holdWeight = 0.0f;
+}
+
 // --- UI/Status for auto-send countdown & phase ---
 volatile int sendCountdown = -1;         // -1 = no countdown, >=0 = seconds remaining
 String sendPhase = "";                  // "" | "countdown" | "send" | "success" | "error"
@@ -136,7 +208,8 @@ uint32_t sendPhaseLastChangeMs = 0;      // for expiring transient phases (succe
 // ============================================================================
 
 // 🔎 OLED Display: Utility to show multi-line status/info messages on the SSD1306 screen.
-//    Used for user feedback, errors, and setup states.
+//    Full-screen, for boot and setup states (before loop() runs); runtime
+//    messages go through notify().
 void displayMessage(String line1, String line2 = "", String line3 = "", String line4 = "") {
     display.clearDisplay();
     display.setTextSize(1);
@@ -165,17 +238,40 @@ void displayMessage(String line1, String line2 = "", String line3 = "", String l
 
 // 🔎 OLED Display: Shows the current weight and RFID UID, plus WiFi status, on the OLED.
 //    This function is called frequently to update the main UI shown to the user.
-void displayWeight(float weight, const String& uid = "");
+void displayWeight(float weight, const char* uid = "");
 
 bool checkServerHealth();
-bool pushWeightToCloud(float w);
+bool pushWeightToCloud(float w, int* httpCodeOut = nullptr, const char* uid = nullptr);
 void handleAutoPush(float w);
 bool validateApiKeyFirmware(const String& key, String& displayNameOut);
 bool deleteApiKey();
 
+// Decodes every tag on the reader into infos[] (RFID_MAX_TAGS entries);
+// returns how many there are, 0 when one of them carries no TigerTag data.
+static uint8_t decodeTagSet(TigerTagInfo* infos) {
+    uint8_t n = rfidTagCount();
+    for (uint8_t i = 0; i < n; ++i) {
+        const RfidTag* t = rfidTagAt(i);
+        if (!t->hasUser || !tigertagDecode(t->user, sizeof(t->user), &infos[i])) return 0;
+    }
+    return n;
+}
+
+// Notification band over the lower rows; the weight above keeps updating
+static void drawNotice(const OledNotice& n) {
+    display.fillRect(0, OLED_NOTIFY_Y, OLED_WIDTH, OLED_HEIGHT - OLED_NOTIFY_Y, SSD1306_BLACK);
+    display.drawFastHLine(0, OLED_NOTIFY_Y, OLED_WIDTH, SSD1306_WHITE);
+    display.setTextSize(1);
+    for (uint8_t i = 0; i < OLED_NOTIFY_LINES; ++i) {
+        display.setCursor(0, OLED_NOTIFY_Y + 2 + i * 9);
+        display.print(n.line[i]);
+    }
+}
+
 // 🔎 OLED Display: Main function for rendering weight and tag info on the OLED.
-//    Shows WiFi status, weight (large digits), UID, and device IP.
-void displayWeight(float weight, const String& uid) {
+//    Shows WiFi status, weight (large digits), UID, and device IP, with the
+//    current notification (if any) composited on top.
+void displayWeight(float weight, const char* uid) {
     display.clearDisplay();
     
      // En-tête avec titre et statut WiFi
@@ -196,9 +292,33 @@ void displayWeight(float weight, const String& uid) {
     display.setCursor(0, 20);
     display.print(wInt);
     display.println(" g");
+
+    // Filament net (tare lue sur le TigerTag), sans attendre le cloud
+    int32_t net;
+    uint8_t tagCount = rfidTagCount();
+    if (tagCount > 1) {
+        // Plusieurs bobines : total net estimé (somme des parts), pas de push
+        TigerTagInfo infos[RFID_MAX_TAGS];
+        int32_t nets[RFID_MAX_TAGS];
+        display.setTextSize(1);
+        display.setCursor(0, 36);
+        display.printf("%u tags", tagCount);
+        if (decodeTagSet(infos) && tigertagApportion(infos, tagCount, weight, nets)) {
+            int32_t total = 0;
+            for (uint8_t i = 0; i < tagCount; ++i) total += nets[i];
+            display.printf("  net %ld g", (long)total);
+        } else {
+            display.print("  no tare");
+        }
+    } else if (uid[0] && tigertagNetGrams(gSpool, weight, &net)) {
+        display.setTextSize(1);
+        display.setCursor(0, 36);
+        display.printf("Net %ld g", (long)net);
+        if (gSpool.nominalG) display.printf(" / %lu", (unsigned long)gSpool.nominalG);
+    }
     
     // UID
-    if (uid.length() > 0) {
+    if (uid[0]) {
         display.setTextSize(1);
         display.setCursor(0, 45);
         display.print("UID:");
@@ -212,10 +332,22 @@ void displayWeight(float weight, const String& uid) {
         display.print("IP: ");
         display.println(WiFi.localIP().toString().c_str());
     }
+
+    const OledNotice* notice = gNotices.current(millis());
+    if (notice) drawNotice(*notice);
     
     display.display();
 }
 
+// 🔎 Transient message without delay(): queued, then drawn by displayWeight()
+//    for durationMs while loop() keeps running. Redraws at once so the
+//    message does not wait for the next periodic refresh.
+static void notify(const char* l1, const char* l2, const char* l3, uint16_t durationMs,
+                   uint8_t priority, uint8_t key = 0) {
+    gNotices.push(l1, l2, l3, durationMs, priority, key);
+    displayWeight(displayedWeight, currentUidDec);
+}
+
 // ============================================================================
 // PORTAIL CAPTIF & CONFIGURATION
 // ============================================================================
@@ -255,6 +387,7 @@ void setupWiFi() {
         ESP.restart();
     }
     
+    cacheWifiInfo();
     apiKey = custom_api_key.getValue();
     if (apiKey.length() > 0) {
         prefs.begin("config", false);
@@ -336,6 +469,9 @@ void setupFileSystem() {
     }
     // Recursive listing including /www/img etc.
     listDir(LittleFS, "/www", 3);
+
+    // Small text assets go to RAM once; the routes below only see cache misses
+    assetCacheBegin(LittleFS, "/www");
 }
 
 // Validate API key against TigerTag CDN (firmware-side)
@@ -391,6 +527,196 @@ bool deleteApiKey() {
     return removed;
 }
 
+// ============================================================================
+// INSTANTANÉ D'ÉTAT (/api/status)
+// ============================================================================
+// 🔎 Status snapshot: loop() copies the live state into gStatusSnap once per
+//    iteration; /api/status serializes a frozen copy of it into one of a few
+//    preallocated buffers, so polling costs no String building or heap churn.
+
+#define STATUS_POOL_SLOTS   4
+#define STATUS_SLOT_STALE_MS 10000   // reclaim slots of aborted responses
+
+struct StatusSlot {
+    bool     busy;
+    uint32_t takenMs;
+    size_t   len;
+    char     buf[STATUS_JSON_MAX];
+};
+
+static StatusSnapshot gStatusSnap;
+static portMUX_TYPE gStatusMux = portMUX_INITIALIZER_UNLOCKED;
+static StatusSlot gStatusPool[STATUS_POOL_SLOTS];   // only touched from the AsyncTCP task
+
+// Tag set as seen by the AsyncTCP task (/api/tags), copied with the status snapshot
+static TagSnap gTagSnap[RFID_MAX_TAGS];
+static uint8_t gTagSnapCount = 0;
+static bool gTagSnapApportioned = false;
+
+static void refreshTagSnapshot() {
+    TagSnap tags[RFID_MAX_TAGS];
+    TigerTagInfo infos[RFID_MAX_TAGS];
+    int32_t nets[RFID_MAX_TAGS];
+    uint8_t n = rfidTagCount();
+    for (uint8_t i = 0; i < n; ++i) {
+        const RfidTag* t = rfidTagAt(i);
+        tags[i].uid = t->uid;
+        if (!t->hasUser || !tigertagDecode(t->user, sizeof(t->user), &tags[i].info)) tags[i].info.valid = false;
+        infos[i] = tags[i].info;
+    }
+    bool apportioned = tigertagApportion(infos, n, displayedWeight, nets);
+    for (uint8_t i = 0; i < n; ++i) tags[i].netG = apportioned ? nets[i] : 0;
+
+    portENTER_CRITICAL(&gStatusMux);
+    memcpy(gTagSnap, tags, n * sizeof(TagSnap));
+    gTagSnapCount = n;
+    gTagSnapApportioned = apportioned;
+    portEXIT_CRITICAL(&gStatusMux);
+}
+
+static void refreshStatusSnapshot() {
+    StatusSnapshot s;
+    s.weight = (int32_t)(displayedWeight + (displayedWeight >= 0 ? 0.5f : -0.5f));
+    s.smoothWeight = (int32_t)(currentWeight + (currentWeight >= 0 ? 0.5f : -0.5f));
+    s.rawWeight = currentWeight;
+    s.hold = holdMode;
+    s.holdWeight = (int32_t)(holdWeight + (holdWeight >= 0 ? 0.5f : -0.5f));
+    s.cloudOK = cloudOK;
+    s.apiValid = apiValid;
+    s.calibrationFactor = calibrationFactor;
+    s.uptimeMs = millis();
+    strlcpy(s.uid, currentUidDec, sizeof(s.uid));
+    strlcpy(s.uidHex, currentUidHex, sizeof(s.uidHex));
+    strlcpy(s.wifi, gWifiSsid, sizeof(s.wifi));
+    strlcpy(s.ip, gWifiIp, sizeof(s.ip));
+    snprintf(s.mdns, sizeof(s.mdns), "%s.local", gMdnsName.c_str());
+    strlcpy(s.apiKey, apiKey.c_str(), sizeof(s.apiKey));
+    strlcpy(s.displayName, apiDisplayName.c_str(), sizeof(s.displayName));
+    // sendToCloud status: "3","2","1","send","success","error" or ""
+    if (sendPhase == "countdown" && sendCountdown >= 0) snprintf(s.sendToCloud, sizeof(s.sendToCloud), "%d", (int)sendCountdown);
+    else if (sendPhase == "send" || sendPhase == "success" || sendPhase == "error") strlcpy(s.sendToCloud, sendPhase.c_str(), sizeof(s.sendToCloud));
+    else s.sendToCloud[0] = '\0';
+    s.spoolValid = gSpool.valid;
+    s.materialId = gSpool.materialId;
+    s.nominalG = gSpool.nominalG;
+    s.tareG = gSpool.tareG;
+    s.hasNet = tigertagNetGrams(gSpool, displayedWeight, &s.netG);
+    if (!s.hasNet) s.netG = 0;
+    s.tagCount = rfidTagCount();
+
+    portENTER_CRITICAL(&gStatusMux);
+    gStatusSnap = s;
+    portEXIT_CRITICAL(&gStatusMux);
+    refreshTagSnapshot();
+}
+
+static void copyStatusSnapshot(StatusSnapshot& out) {
+    portENTER_CRITICAL(&gStatusMux);
+    out = gStatusSnap;
+    portEXIT_CRITICAL(&gStatusMux);
+}
+
+static StatusSlot* acquireStatusSlot() {
+    const uint32_t now = millis();
+    for (int i = 0; i < STATUS_POOL_SLOTS; ++i) {
+        StatusSlot& slot = gStatusPool[i];
+        if (!slot.busy || now - slot.takenMs > STATUS_SLOT_STALE_MS) {
+            slot.busy = true;
+            slot.takenMs = now;
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+static void handleStatus(AsyncWebServerRequest *request) {
+    uint32_t fields = SF_ALL;
+    if (request->hasParam("fields")) {
+        fields = statusParseFields(request->getParam("fields")->value().c_str());
+    }
+    StatusSnapshot snap;
+    copyStatusSnapshot(snap);
+
+    StatusSlot* slot = acquireStatusSlot();
+    if (!slot) {
+        // All buffers in flight (many slow clients): one-off copy instead of failing
+        char buf[STATUS_JSON_MAX];
+        statusSerialize(snap, fields, buf, sizeof(buf));
+        request->send(200, "application/json", buf);
+        return;
+    }
+    slot->len = statusSerialize(snap, fields, slot->buf, sizeof(slot->buf));
+
+    // Zero-copy: the response streams straight out of the slot, released on the last chunk
+    AsyncWebServerResponse *response = request->beginResponse("application/json", slot->len,
+        [slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            if (index >= slot->len) { slot->busy = false; return 0; }
+            size_t n = slot->len - index;
+            if (n > maxLen) n = maxLen;
+            memcpy(buffer, slot->buf + index, n);
+            if (index + n >= slot->len) slot->busy = false;
+            return n;
+        });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
+// Tags on the reader with their share of the weight. One tag = the /api/status
+// spool; several = a summed weight, split by nominal when every tag has a tare.
+static void handleTags(AsyncWebServerRequest *request) {
+    TagSnap tags[RFID_MAX_TAGS];
+    uint8_t n;
+    bool apportioned;
+    portENTER_CRITICAL(&gStatusMux);
+    n = gTagSnapCount;
+    apportioned = gTagSnapApportioned;
+    memcpy(tags, gTagSnap, n * sizeof(TagSnap));
+    portEXIT_CRITICAL(&gStatusMux);
+
+    char buf[64 + RFID_MAX_TAGS * TAGS_JSON_ENTRY_MAX];
+    size_t len = tagsSerialize(tags, n, apportioned, buf, sizeof(buf));
+    if (!len) { request->send(500, "application/json", "{\"error\":\"overflow\"}"); return; }
+    request->send(200, "application/json", buf);
+}
+
+// Prometheus text exposition, rendered into one static buffer (scrapes are serial)
+static char gMetricsBuf[METRICS_BUFFER_SIZE];
+static bool gMetricsBusy = false;
+static uint32_t gMetricsTakenMs = 0;
+
+static void handleMetrics(AsyncWebServerRequest *request) {
+    const uint32_t now = millis();
+    if (gMetricsBusy && now - gMetricsTakenMs < STATUS_SLOT_STALE_MS) {
+        AsyncWebServerResponse *response = request->beginResponse(503, "text/plain", "scrape in progress");
+        response->addHeader("Retry-After", "1");
+        request->send(response);
+        return;
+    }
+    MetricsGauges g;
+    g.wsClients = ws.count();
+    g.streamClients = sampleStreamStats().clients;
+    g.inflight = admissionInflight();
+    g.admitLevel = admissionLevel();
+    g.rfidPollMs = rfidPollIntervalMs();
+    g.rfidSpiHz = rc522SpiStats().clockHz;
+    size_t len = metricsRender(gMetricsBuf, sizeof(gMetricsBuf), g);
+    if (!len) { request->send(500, "text/plain", "metrics buffer too small"); return; }
+
+    gMetricsBusy = true;
+    gMetricsTakenMs = now;
+    AsyncWebServerResponse *response = request->beginResponse("text/plain; version=0.0.4", len,
+        [len](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            if (index >= len) { gMetricsBusy = false; return 0; }
+            size_t n = len - index;
+            if (n > maxLen) n = maxLen;
+            memcpy(buffer, gMetricsBuf + index, n);
+            if (index + n >= len) gMetricsBusy = false;
+            return n;
+        });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+}
+
 // ============================================================================
 // SERVEUR WEB & API
 // ============================================================================
@@ -398,17 +724,140 @@ bool deleteApiKey() {
 // ⚠️ SUPPRIMÉ : const char index_html[] PROGMEM = R"rawliteral(...
 // Les fichiers HTML sont maintenant servis depuis LittleFS
 
-AsyncWebSocket ws("/ws");
+// ============================================================================
+// WEBSOCKET : DIFFUSION SUR CHANGEMENT
+// ============================================================================
+// 🔎 WebSocket push: a delta (only the snapshot fields that changed) is built
+//    once into a shared AsyncWebSocketMessageBuffer and queued to every client
+//    that keeps up. Slow clients are coalesced by WsClientTable (ws_clients.h)
+//    into one catch-up frame with the latest values.
+
+static WsClientTable gWsClients;   // under gWsMux: AsyncTCP (connect/disconnect) + loop()
+static portMUX_TYPE gWsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Called from the AsyncTCP task on connect; false when the table is full.
+static bool wsTrackClient(uint32_t id) {
+    portENTER_CRITICAL(&gWsMux);
+    bool ok = gWsClients.track(id);
+    portEXIT_CRITICAL(&gWsMux);
+    return ok;
+}
+
+static void wsUntrackClient(uint32_t id) {
+    portENTER_CRITICAL(&gWsMux);
+    gWsClients.untrack(id);
+    portEXIT_CRITICAL(&gWsMux);
+}
+
+static WsSendPlan wsPlan(uint32_t id, uint32_t changed, bool slow) {
+    portENTER_CRITICAL(&gWsMux);
+    WsSendPlan p = gWsClients.plan(id, changed, slow);
+    portEXIT_CRITICAL(&gWsMux);
+    return p;
+}
+
+static bool wsClientSlow(AsyncWebSocketClient* c) {
+    if (!c->canSend()) return true;
+    AsyncClient* tcp = c->client();
+    return tcp && tcp->space() < WS_CONGESTED_SPACE;
+}
+
+// Per-client frame with the latest value of every field it missed.
+static void wsSendCatchup(AsyncWebSocketClient* c, const StatusSnapshot& snap, uint32_t mask) {
+    char buf[STATUS_JSON_MAX];
+    size_t n = statusSerialize(snap, mask, buf, sizeof(buf));
+    if (!n) return;
+    c->text(buf, n);
+    metricsAdd(MC_WS_CATCHUPS);
+    metricsAdd(MC_WS_STATUS_BYTES, n);
+}
+
+void broadcastStatusDelta() {
+    static StatusSnapshot lastSent;
+    static bool haveLast = false;
+    static uint32_t lastSendMs = 0;
+    const uint32_t now = millis();
+
+    if (ws.count() == 0) { haveLast = false; return; }
+    if (now - lastSendMs < WS_MIN_INTERVAL_MS) return;
+
+    StatusSnapshot snap;
+    copyStatusSnapshot(snap);
+    uint32_t changed = haveLast ? (statusDiff(snap, lastSent) & SF_WS_DELTA) : SF_WS_DELTA;
+    bool keepalive = false;
+    if (!changed && now - lastSendMs >= WS_KEEPALIVE_MS) {
+        changed = SF_UPTIME_S;
+        keepalive = true;
+    }
+
+    // Ids copied under the mux; the sends below run without it
+    uint32_t ids[WS_MAX_TRACKED_CLIENTS];
+    portENTER_CRITICAL(&gWsMux);
+    uint8_t count = gWsClients.ids(ids);
+    portEXIT_CRITICAL(&gWsMux);
+
+    // Nothing new: only flushes catch-ups of clients that drained their queue
+    char buf[STATUS_JSON_MAX];
+    size_t n = 0;
+    if (changed) {
+        n = statusSerialize(snap, changed, buf, sizeof(buf));
+        if (!n) return;
+    }
+    AsyncWebSocketMessageBuffer* shared = nullptr;   // built for the first client that takes it
+
+    for (uint8_t i = 0; i < count; ++i) {
+        AsyncWebSocketClient* c = ws.client(ids[i]);
+        if (!c) continue;
+        WsSendPlan p = wsPlan(ids[i], changed, wsClientSlow(c));
+        switch (p.action) {
+            case WS_SEND_COALESCED:
+                metricsAdd(MC_WS_COALESCED);
+                break;
+            case WS_SEND_CATCHUP:
+                wsSendCatchup(c, snap, p.mask);
+                break;
+            case WS_SEND_SHARED:
+                if (!shared) {
+                    shared = ws.makeBuffer((uint8_t*)buf, n);
+                    if (!shared) break;
+                    shared->lock();
+                }
+                c->text(shared);
+                metricsAdd(MC_WS_STATUS_BYTES, n);
+                break;
+            case WS_SEND_NONE:
+                break;
+        }
+    }
+    // Released here; the library frees the buffer once the last client's
+    // frame is acked (no call into its private _cleanBuffers() from loop())
+    if (shared) shared->unlock();
+    if (!changed) return;
+
+    metricsAdd(keepalive ? MC_WS_KEEPALIVES : MC_WS_DELTAS);
+    lastSent = snap;
+    haveLast = true;
+    lastSendMs = now;
+}
 
 void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
                AwsEventType type, void *arg, uint8_t *data, size_t len) {
+    if (type == WS_EVT_DISCONNECT) {
+        wsUntrackClient(client->id());
+        return;
+    }
     if (type == WS_EVT_CONNECT) {
         Serial.printf("WebSocket client #%u connected\n", client->id());
-        // Send an immediate snapshot so the UI updates right away on connect
-        int wIntSnap = (int)(currentWeight + (currentWeight >= 0 ? 0.5f : -0.5f));
-        char snap[96];
-        snprintf(snap, sizeof(snap), "{\"weight\":%d,\"uid\":\"%s\"}", wIntSnap, lastUID.c_str());
-        client->text(snap);
+        if (!wsTrackClient(client->id())) {
+            client->close(1013, "too many clients");   // 1013 = try again later
+            return;
+        }
+        // Send a full snapshot so the UI updates right away on connect; deltas follow
+        StatusSnapshot snap;
+        copyStatusSnapshot(snap);
+        char buf[STATUS_JSON_MAX];
+        size_t n = statusSerialize(snap, SF_ALL, buf, sizeof(buf));
+        if (n) client->text(buf, n);
         // Also push current API status so the UI reflects it immediately on fresh load
         {
             StaticJsonDocument<192> out;
@@ -430,97 +879,334 @@ void onWsEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
             return;
         }
         const char* mtype = doc["type"] | "";
+        // Validation is an HTTPS round-trip: never run it on the AsyncTCP task.
+        // The outcome comes back as "apiStatus" / "deleteApiKeyResult" plus a job result.
+        JobType jt = JOB_NONE;
+        String arg;
         if (strcmp(mtype, "updateApiKey") == 0) {
-            String newKey = String(doc["value"] | "");
-            newKey.trim();
-            if (newKey.length() == 0) {
-                displayMessage("API key FAIL", "Check key");
-                delay(600);
-                displayWeight(currentWeight, lastUID);
-                client->text("{\"type\":\"apiStatus\",\"valid\":false}");
-                return;
-            }
-            String displayName;
-            bool ok = validateApiKeyFirmware(newKey, displayName);
-            if (ok) {
-                // Persist only if valid
-                apiKey = newKey;
-                apiValid = true;
-                apiDisplayName = displayName;
-                prefs.begin("config", false);
-                prefs.putString("apiKey", apiKey);
-                prefs.putString("apiName", apiDisplayName);
-                prefs.end();
-                // Notify UI
-                displayMessage("API key OK", apiDisplayName);
-                delay(600);
-                displayWeight(currentWeight, lastUID);
-                StaticJsonDocument<192> out;
-                out["type"] = "apiStatus";
-                out["valid"] = true;
-                out["displayName"] = apiDisplayName;
-                String outStr; serializeJson(out, outStr);
-                client->text(outStr);
-                // Optional: also echo the stored key (if UI needs to sync)
-                // client->text(String("{\"type\":\"apiKey\",\"value\":\"") + apiKey + "\"}");
-            } else {
-                displayMessage("API key FAIL", "Check key");
-                delay(600);
-                displayWeight(currentWeight, lastUID);
-                client->text("{\"type\":\"apiStatus\",\"valid\":false}");
-            }
+            jt = JOB_VALIDATE_API_KEY;
+            arg = String(doc["value"] | "");
+            arg.trim();
+        } else if (strcmp(mtype, "deleteApiKey") == 0) {
+            jt = JOB_DELETE_API_KEY;
         }
-        else if (strcmp(mtype, "deleteApiKey") == 0) {
-            bool ok = deleteApiKey();
-            displayMessage(ok ? "API key deleted" : "Delete failed", ok ? "Credentials cleared" : "Check storage");
-            delay(600);
-            displayWeight(currentWeight, lastUID);
-            // Inform only the requester about the result
-            {
-                StaticJsonDocument<96> out;
-                out["type"] = "deleteApiKeyResult";
-                out["success"] = ok;
-                String outStr; serializeJson(out, outStr);
-                client->text(outStr);
-            }
-            // Broadcast new API status to all clients
-            {
-                StaticJsonDocument<96> st;
-                st["type"] = "apiStatus";
-                st["valid"] = false;
-                String s; serializeJson(st, s);
-                ws.textAll(s);
-            }
+        if (jt == JOB_NONE) return;
+        uint32_t jobId = jobEnqueue(jt, arg.c_str(), 0, client->id());
+        char out[96];
+        if (jobId) snprintf(out, sizeof(out), "{\"type\":\"job\",\"id\":%u,\"action\":\"%s\",\"state\":\"queued\"}", jobId, jobTypeName(jt));
+        else snprintf(out, sizeof(out), "{\"type\":\"job\",\"id\":0,\"action\":\"%s\",\"state\":\"rejected\"}", jobTypeName(jt));
+        client->text(out);
+    }
+}
+
+// ============================================================================
+// CORPS JSON DES REQUÊTES (parsing incrémental, chunk par chunk)
+// ============================================================================
+// 🔎 Body parsing: AsyncWebServer hands POST bodies over in TCP-sized chunks
+//    (index/total). Each chunk is fed to a JsonStreamParser kept in
+//    request->_tempObject, which fills a typed struct; the onRequest handler
+//    runs once the whole body has arrived and only reads that struct.
+
+#define MAX_JSON_BODY 1024
+
+static void copyJsonString(char* dst, size_t cap, const char* value) {
+    strlcpy(dst, value, cap);
+}
+
+struct ConfigBody {
+    JsonStreamParser parser;
+    bool hasApiKey;
+    char apiKey[JSON_STREAM_VALUE_MAX];
+
+    static void onField(void* ctx, const char* key, JsonValueType type, const char* value, size_t len) {
+        ConfigBody* b = (ConfigBody*)ctx;
+        if (strcmp(key, "apiKey") == 0 && type == JSON_VALUE_STRING) {
+            copyJsonString(b->apiKey, sizeof(b->apiKey), value);
+            b->hasApiKey = true;
+        }
+    }
+};
+
+struct ApiKeyBody {
+    JsonStreamParser parser;
+    bool hasKey;
+    char key[JSON_STREAM_VALUE_MAX];
+
+    static void onField(void* ctx, const char* key, JsonValueType type, const char* value, size_t len) {
+        ApiKeyBody* b = (ApiKeyBody*)ctx;
+        if (strcmp(key, "key") == 0 && type == JSON_VALUE_STRING) {
+            copyJsonString(b->key, sizeof(b->key), value);
+            b->hasKey = true;
+        }
+    }
+};
+
+struct WeightBody {
+    JsonStreamParser parser;
+    bool hasWeight;
+    bool weightValid;
+    float weight;
+    bool hasUid;
+    char uid[24];
+
+    static void onField(void* ctx, const char* key, JsonValueType type, const char* value, size_t len) {
+        WeightBody* b = (WeightBody*)ctx;
+        if (strcmp(key, "weight") == 0) {
+            b->hasWeight = true;
+            b->weightValid = jsonParseFloat(type, value, b->weight);
+        } else if (strcmp(key, "uid") == 0 && (type == JSON_VALUE_STRING || type == JSON_VALUE_NUMBER)) {
+            copyJsonString(b->uid, sizeof(b->uid), value);
+            b->hasUid = len > 0;
         }
     }
+};
+
+struct CalibrationBody {
+    JsonStreamParser parser;
+    bool hasFactor;
+    bool fromFactorKey;
+    bool factorValid;
+    float factor;
+
+    static void onField(void* ctx, const char* key, JsonValueType type, const char* value, size_t len) {
+        CalibrationBody* b = (CalibrationBody*)ctx;
+        // "factor" wins over the legacy "value" key
+        bool isFactor = strcmp(key, "factor") == 0;
+        if (isFactor || (strcmp(key, "value") == 0 && !b->fromFactorKey)) {
+            b->hasFactor = true;
+            b->fromFactorKey = isFactor;
+            b->factorValid = jsonParseFloat(type, value, b->factor);
+        }
+    }
+};
+
+struct MqttBody {
+    JsonStreamParser parser;
+    bool hasEnabled, enabled;
+    bool hasHost, hasPort, hasUser, hasPass, hasTopic;
+    uint16_t port;
+    char host[64];
+    char user[48];
+    char pass[64];
+    char topic[32];
+
+    static void onField(void* ctx, const char* key, JsonValueType type, const char* value, size_t len) {
+        MqttBody* b = (MqttBody*)ctx;
+        if (strcmp(key, "enabled") == 0 && type == JSON_VALUE_BOOL) {
+            b->hasEnabled = true;
+            b->enabled = (value[0] == 't');
+        } else if (strcmp(key, "port") == 0 && type == JSON_VALUE_NUMBER) {
+            b->hasPort = true;
+            b->port = (uint16_t)atoi(value);
+        } else if (type == JSON_VALUE_STRING) {
+            if      (strcmp(key, "host") == 0)  { copyJsonString(b->host, sizeof(b->host), value);   b->hasHost = true; }
+            else if (strcmp(key, "user") == 0)  { copyJsonString(b->user, sizeof(b->user), value);   b->hasUser = true; }
+            else if (strcmp(key, "pass") == 0)  { copyJsonString(b->pass, sizeof(b->pass), value);   b->hasPass = true; }
+            else if (strcmp(key, "topic") == 0) { copyJsonString(b->topic, sizeof(b->topic), value); b->hasTopic = true; }
+        }
+    }
+};
+
+// Body callback: T must be POD (AsyncWebServer releases _tempObject with free()).
+template <typename T>
+static void jsonBodyChunk(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (index == 0) {
+        if (request->_tempObject || total > MAX_JSON_BODY) return; // left unset → rejected in onRequest
+        T* b = (T*)calloc(1, sizeof(T));
+        if (!b) return;
+        b->parser.begin(T::onField, b);
+        request->_tempObject = b;
+    }
+    T* b = (T*)request->_tempObject;
+    if (b) b->parser.feed(data, len);
+}
+
+// onRequest side: returns the parsed body, or answers 400/413 and returns nullptr.
+template <typename T>
+static T* jsonBodyResult(AsyncWebServerRequest *request, const char* badJson = "{\"error\":\"bad json\"}") {
+    if (request->contentLength() > MAX_JSON_BODY) {
+        request->send(413, "application/json", "{\"error\":\"body too large\"}");
+        return nullptr;
+    }
+    T* b = (T*)request->_tempObject;
+    if (!b || !b->parser.done()) {
+        if (b && b->parser.failed()) Serial.printf("[HTTP] %s: %s\n", request->url().c_str(), b->parser.error());
+        request->send(400, "application/json", badJson);
+        return nullptr;
+    }
+    return b;
+}
+
+// ============================================================================
+// TRAVAUX DIFFÉRÉS (exécutés par loop(), jamais par la tâche AsyncTCP)
+// ============================================================================
+// 🔎 Deferred jobs: handlers that used to block the network stack (HTTPS
+//    calls, delay() before a reboot) now enqueue a job and answer 202 with
+//    its id within a few milliseconds. loop() runs one job per iteration and
+//    broadcasts {"type":"job","id":N,"state":"done"|"failed",...} on /ws.
+
+#define JOB_REBOOT_DELAY_MS  1000
+#define JOB_JSON_MAX         192
+
+static size_t jobResultJson(const JobResult& r, char* out, size_t cap) {
+    StaticJsonDocument<192> doc;
+    doc["type"] = "job";
+    doc["id"] = r.id;
+    doc["action"] = jobTypeName(r.type);
+    doc["state"] = jobStateName(r.state);
+    if (r.state == JOB_DONE || r.state == JOB_FAILED) {
+        doc["ok"] = r.state == JOB_DONE;
+        if (r.code) doc["code"] = r.code;
+        if (r.detail[0]) doc["detail"] = (const char*)r.detail;
+    }
+    return serializeJson(doc, out, cap);
+}
+
+static void sendJobAccepted(AsyncWebServerRequest *request, uint32_t jobId) {
+    if (!jobId) {
+        AsyncWebServerResponse *response = request->beginResponse(503, "application/json", "{\"error\":\"job queue full\"}");
+        response->addHeader("Retry-After", "1");
+        request->send(response);
+        return;
+    }
+    char buf[48];
+    snprintf(buf, sizeof(buf), "{\"status\":\"accepted\",\"job\":%u}", jobId);
+    request->send(202, "application/json", buf);
+}
+
+static void finishJob(const Job& j, bool ok, int code, const char* detail) {
+    jobFinish(j.id, ok, code, detail);
+    JobResult r;
+    if (!jobLookup(j.id, r)) return;
+    char buf[JOB_JSON_MAX];
+    size_t n = jobResultJson(r, buf, sizeof(buf));
+    if (n) ws.textAll(buf, n);
+}
+
+// Reply on the requester's socket only (the WebSocket API predates jobs)
+static void replyToWsClient(uint32_t clientId, const char* msg) {
+    if (!clientId) return;
+    AsyncWebSocketClient *c = ws.client(clientId);
+    if (c && c->status() == WS_CONNECTED) c->text(msg);
+}
+
+static void runValidateApiKey(const Job& j) {
+    String key = j.arg;
+    String dn;
+    bool ok = validateApiKeyFirmware(key, dn);
+    if (ok) {
+        // Persist only if valid
+        apiKey = key;
+        apiValid = true;
+        if (dn.length()) apiDisplayName = dn;
+        prefs.begin("config", false);
+        prefs.putString("apiKey", apiKey);
+        prefs.putString("apiName", apiDisplayName);
+        prefs.end();
+        notify("API key OK", apiDisplayName.c_str(), nullptr, NOTIFY_RESULT_MS, NOTIFY_RESULT, NOTIFY_KEY_API);
+    } else {
+        notify("API key FAIL", "Check key", nullptr, NOTIFY_ERROR_MS, NOTIFY_ERROR, NOTIFY_KEY_API);
+    }
+
+    StaticJsonDocument<192> out;
+    out["type"] = "apiStatus";
+    out["valid"] = ok;
+    if (ok) out["displayName"] = apiDisplayName;
+    String outStr; serializeJson(out, outStr);
+    replyToWsClient(j.wsClient, outStr.c_str());
+    finishJob(j, ok, 0, ok ? apiDisplayName.c_str() : "invalid key");
+}
+
+static void runDeleteApiKey(const Job& j) {
+    bool ok = deleteApiKey();
+    if (ok) notify("API key deleted", "Credentials cleared", nullptr, NOTIFY_RESULT_MS, NOTIFY_RESULT, NOTIFY_KEY_API);
+    else notify("Delete failed", "Check storage", nullptr, NOTIFY_ERROR_MS, NOTIFY_ERROR, NOTIFY_KEY_API);
+    replyToWsClient(j.wsClient, ok ? "{\"type\":\"deleteApiKeyResult\",\"success\":true}"
+                                   : "{\"type\":\"deleteApiKeyResult\",\"success\":false}");
+    ws.textAll("{\"type\":\"apiStatus\",\"valid\":false}");
+    finishJob(j, ok, 0, ok ? "" : "storage error");
+}
+
+static void runPushWeight(const Job& j) {
+    int wi = j.value;
+    int code = 0;
+    bool ok = pushWeightToCloud((float)wi, &code, j.arg);
+    mqttPublishPushResult(ok, code, wi, j.arg);
+    if (ok) {
+        // The tag stays current (it is still on the scale); only its auto-push is done
+        if (strcmp(j.arg, currentUidDec) == 0) currentPushed = true;
+        stableSinceMs = 0;
+        stableCandidate = NAN;
+        refreshStatusSnapshot();     // the next status delta carries the change
+        char grams[16];
+        snprintf(grams, sizeof(grams), "%d g", wi);
+        notify("Synced \xE2\x9C\x93", grams, "to cloud", NOTIFY_RESULT_MS, NOTIFY_RESULT, NOTIFY_KEY_PUSH);
+    }
+    finishJob(j, ok, code, ok ? "" : (code ? "upstream error" : "not sent (offline or no api key)"));
+}
+
+// Runs on loop(), between two readWeight() calls: never concurrent with them
+static void runTare(const Job& j) {
+    scale.tare();
+    sampleStreamMarkTare();
+    resetWeightFilter();
+    refreshStatusSnapshot();         // the next status delta carries the change
+    finishJob(j, true, 0, "");
+}
+
+void runDeferredJobs() {
+    Job j;
+    if (!jobNext(j)) return;
+    Serial.printf("[JOB] #%u %s\n", j.id, jobTypeName(j.type));
+
+    switch (j.type) {
+        case JOB_VALIDATE_API_KEY: runValidateApiKey(j); break;
+        case JOB_DELETE_API_KEY:   runDeleteApiKey(j); break;
+        case JOB_PUSH_WEIGHT:      runPushWeight(j); break;
+        case JOB_TARE:             runTare(j); break;
+        case JOB_RESET_WIFI:
+            finishJob(j, true, 0, "restarting");
+            delay(100);   // let the WebSocket frame leave
+            wm.resetSettings();
+            ESP.restart();
+            break;
+        case JOB_FACTORY_RESET:
+            finishJob(j, true, 0, "restarting");
+            delay(100);
+            prefs.begin("config", false);
+            prefs.clear();
+            prefs.end();
+            wm.resetSettings();
+            ESP.restart();
+            break;
+        default:
+            finishJob(j, false, 0, "unknown job");
+            break;
+    }
 }
 
 // ============================================
 // SERVEUR WEB & API
 // ============================================
 void setupWebServer() {
+    admissionAttach(server, ws);   // first: sees every request before the routes
     ws.onEvent(onWsEvent);
     server.addHandler(&ws);
+    sampleStreamSetup(server);
+    assetCacheAttach(server);   // must precede the LittleFS routes
     
 
     // ============================================
-    // Page principale (préférer index.html.gz si présent)
+    // Page principale (index.html.br / .gz / brut selon Accept-Encoding)
     // ============================================
-    // 🔎 Routing: Serve index.html(.gz) for root, with no-cache headers for fast dev iteration.
-    //    Tries .gz first for compressed transfer. Caching is disabled for HTML to ensure the UI updates immediately after changes.
+    // 🔎 Routing: LittleFS fallback for the entry document when the RAM/embedded
+    //    cache does not hold it. Picks the smallest variant the client accepts
+    //    (br > gz > identity). Same policy as the cache: no-cache + ETag, so a
+    //    reload revalidates and gets a 304 while the UI is unchanged.
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-        if (LittleFS.exists("/www/index.html.gz")) {
-            AsyncWebServerResponse *response = request->beginResponse(LittleFS, "/www/index.html.gz", "text/html; charset=utf-8");
-            response->addHeader("Content-Encoding", "gzip");
-            response->addHeader("Cache-Control", "no-store, no-cache, must-revalidate, max-age=0");
-            response->addHeader("Pragma", "no-cache");
-            request->send(response);
-            return;
-        }
-        if (LittleFS.exists("/www/index.html")) {
-            AsyncWebServerResponse *response = request->beginResponse(LittleFS, "/www/index.html", "text/html; charset=utf-8");
-            response->addHeader("Cache-Control", "no-store, no-cache, must-revalidate, max-age=0");
-            response->addHeader("Pragma", "no-cache");
+        AsyncWebServerResponse *response = assetBeginFsResponse(request, LittleFS, "/www/index.html", "text/html; charset=utf-8");
+        if (response) {
+            response->addHeader("Cache-Control", "no-cache");
             request->send(response);
             return;
         }
@@ -574,107 +1260,76 @@ void setupWebServer() {
     //    Cache disabled (no-store) for development; can be set to long-term cache in production.
     server.serveStatic("/img", LittleFS, "/www/img")
           .setCacheControl("no-store");
+
+    // Content-hashed CSS/JS and the service worker's files when they are not in
+    // the asset cache (skipped on low heap): the worker install must not 404.
+    // serveStatic() only knows ".gz", so negotiate br/gz/identity like the RAM cache.
+    server.on("/*", HTTP_GET, [](AsyncWebServerRequest *request) {
+        String path = "/www" + request->url();
+        AsyncWebServerResponse *response = assetBeginFsResponse(request, LittleFS, path.c_str());
+        if (!response) { request->send(404); return; }
+        bool hashed = assetIsHashedUrl(request->url().c_str());
+        response->addHeader("Cache-Control", hashed ? ASSET_IMMUTABLE_CACHE_CONTROL : "no-cache");
+        request->send(response);
+    }).setFilter([](AsyncWebServerRequest *request) {
+        static const char* const kShellFiles[] = { "/sw.js", "/manifest.json", "/favicon.png", "/favicon.ico" };
+        const char* url = request->url().c_str();
+        if (assetIsHashedUrl(url)) return true;
+        for (const char* f : kShellFiles) {
+            if (strcmp(url, f) == 0) return true;
+        }
+        return false;
+    });
     
-    server.on("/api/config", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-            String body = String((char*)data).substring(0, len);
-            int keyStart = body.indexOf("\"apiKey\":\"") + 10;
-            int keyEnd = body.indexOf("\"", keyStart);
-            apiKey = body.substring(keyStart, keyEnd);
+    server.on("/api/config", HTTP_POST, [](AsyncWebServerRequest *request) {
+            ConfigBody* b = jsonBodyResult<ConfigBody>(request);
+            if (!b) return;
+            if (!b->hasApiKey) { request->send(400, "application/json", "{\"error\":\"missing apiKey\"}"); return; }
+            apiKey = b->apiKey;
             
             prefs.begin("config", false);
             prefs.putString("apiKey", apiKey);
             prefs.end();
             
             request->send(200, "application/json", "{\"status\":\"ok\"}");
-        }
+        }, NULL, jsonBodyChunk<ConfigBody>
     );
     
+    // Reboots are deferred by JOB_REBOOT_DELAY_MS so the 202 reaches the browser first
     server.on("/api/reset-wifi", HTTP_POST, [](AsyncWebServerRequest *request) {
-        request->send(200, "application/json", "{\"status\":\"resetting\"}");
-        delay(1000);
-        wm.resetSettings();
-        ESP.restart();
+        sendJobAccepted(request, jobEnqueue(JOB_RESET_WIFI, nullptr, 0, 0, JOB_REBOOT_DELAY_MS));
     });
     
     server.on("/api/factory-reset", HTTP_POST, [](AsyncWebServerRequest *request) {
-        request->send(200, "application/json", "{\"status\":\"factory reset\"}");
-        delay(1000);
-        prefs.begin("config", false);
-        prefs.clear();
-        prefs.end();
-        wm.resetSettings();
-        ESP.restart();
+        sendJobAccepted(request, jobEnqueue(JOB_FACTORY_RESET, nullptr, 0, 0, JOB_REBOOT_DELAY_MS));
     });
     
-    server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request) {
-        String json = "{";
-        {
-            int wInt = (int)(currentWeight + (currentWeight >= 0 ? 0.5f : -0.5f));
-            json += "\"weight\":" + String(wInt) + ",";
-            // Insert rawWeight and smoothWeight after weight
-            json += "\"rawWeight\":" + String(currentWeight, 2) + ",";
-            json += "\"smoothWeight\":" + String((int)(currentWeight + (currentWeight >= 0 ? 0.5f : -0.5f))) + ",";
-        }
-        // Hold mode info
-        json += "\"hold\":" + String(holdMode ? "true" : "false") + ",";
-        json += "\"holdWeight\":" + String((int)(holdWeight + (holdWeight>=0?0.5f:-0.5f))) + ",";
-        json += "\"uid\":\"" + lastUID + "\",";
-        json += "\"uid_hex\":\"" + lastUIDHex + "\",";
-        json += "\"wifi\":\"" + WiFi.SSID() + "\",";
-        json += "\"ip\":\"" + WiFi.localIP().toString() + "\",";
-        json += "\"mdns\":\"" + gMdnsName + ".local\",";
-        json += "\"cloud\":\"" + String(cloudOK ? "ok" : "down") + "\",";
-        json += "\"apiKey\":\"" + apiKey + "\",";
-        json += "\"apiValid\":" + String(apiValid ? "true" : "false") + ",";
-        json += "\"displayName\":\"" + apiDisplayName + "\",";
-        json += "\"calibrationFactor\":" + String(calibrationFactor, 4) + ",";
-        json += "\"uptime_ms\":" + String(millis()) + ","; // milliseconds since boot
-        json += "\"uptime_s\":" + String(millis() / 1000) + ",";
-        // sendToCloud status: "3","2","1","send","success","error" or ""
-        String stc;
-        if (sendPhase == "countdown" && sendCountdown >= 0)       stc = String(sendCountdown);
-        else if (sendPhase == "send")                              stc = "send";
-        else if (sendPhase == "success")                           stc = "success";
-        else if (sendPhase == "error")                             stc = "error";
-        else                                                        stc = "";
-        json += "\"sendToCloud\":\"" + stc + "\"";
-        json += "}";
-        request->send(200, "application/json", json);
+    // Deferred job state, for clients that cannot listen on the WebSocket
+    server.on("/api/job", HTTP_GET, [](AsyncWebServerRequest *request) {
+        uint32_t id = request->hasParam("id") ? (uint32_t)strtoul(request->getParam("id")->value().c_str(), nullptr, 10) : 0;
+        JobResult r;
+        if (!jobLookup(id, r)) { request->send(404, "application/json", "{\"error\":\"unknown job\"}"); return; }
+        char buf[JOB_JSON_MAX];
+        jobResultJson(r, buf, sizeof(buf));
+        request->send(200, "application/json", buf);
     });
+    
+    server.on("/api/status", HTTP_GET, handleStatus);
+    server.on("/api/tags", HTTP_GET, handleTags);
+    server.on("/metrics", HTTP_GET, handleMetrics);
 
     // REST: set/validate API key
-    server.on("/api/apikey", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-            String body = String((const char*)data).substring(0, len);
-            // extract { "key": "..." }
-            int kp = body.indexOf("\"key\"");
-            if (kp < 0) { request->send(400, "application/json", "{\"success\":false,\"error\":\"missing key\"}"); return; }
-            int colon = body.indexOf(':', kp);
-            if (colon < 0) { request->send(400, "application/json", "{\"success\":false,\"error\":\"bad json\"}"); return; }
-            int q1 = body.indexOf('"', colon+1);
-            int q2 = (q1 >= 0) ? body.indexOf('"', q1+1) : -1;
-            if (q1 < 0 || q2 < 0) { request->send(400, "application/json", "{\"success\":false,\"error\":\"bad json\"}"); return; }
-            String newKey = body.substring(q1+1, q2);
+    server.on("/api/apikey", HTTP_POST, [](AsyncWebServerRequest *request){
+            // expects { "key": "..." }
+            ApiKeyBody* b = jsonBodyResult<ApiKeyBody>(request, "{\"success\":false,\"error\":\"bad json\"}");
+            if (!b) return;
+            if (!b->hasKey) { request->send(400, "application/json", "{\"success\":false,\"error\":\"missing key\"}"); return; }
+            String newKey = b->key;
             newKey.trim();
             if (newKey.length() == 0) { request->send(400, "application/json", "{\"success\":false,\"error\":\"empty key\"}"); return; }
 
-            String dn;
-            bool ok = validateApiKeyFirmware(newKey, dn);
-            if (ok) {
-                apiKey = newKey;
-                apiValid = true;
-                if (dn.length()) apiDisplayName = dn;
-                prefs.begin("config", false);
-                prefs.putString("apiKey", apiKey);
-                prefs.putString("apiName", apiDisplayName);
-                prefs.end();
-                request->send(200, "application/json", String("{\"success\":true,\"displayName\":\"") + apiDisplayName + "\"}");
-            } else {
-                apiValid = false;
-                request->send(200, "application/json", "{\"success\":false}");
-            }
-        }
+            sendJobAccepted(request, jobEnqueue(JOB_VALIDATE_API_KEY, newKey.c_str(), 0));
+        }, NULL, jsonBodyChunk<ApiKeyBody>
     );
 
     // REST: delete API key
@@ -758,132 +1413,50 @@ void setupWebServer() {
     });
     
     // REST: set weight (send to cloud) — expects { weight, uid? }
-    server.on("/api/weight", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-            String body = String((const char*)data).substring(0, len);
-            // extract weight number
-            int wp = body.indexOf("weight");
-            if (wp < 0) { request->send(400, "application/json", "{\"error\":\"missing weight\"}"); return; }
-            int colon = body.indexOf(':', wp);
-            if (colon < 0) { request->send(400, "application/json", "{\"error\":\"bad json\"}"); return; }
-            String num = body.substring(colon+1);
-            num.trim();
-            while (num.length() && (num[num.length()-1] < '0' || num[num.length()-1] > '9') && num[num.length()-1] != '.') num.remove(num.length()-1);
-            while (num.length() && ((num[0] < '0' || num[0] > '9') && num[0] != '-' && num[0] != '.')) num.remove(0,1);
-            float w = num.toFloat();
+    server.on("/api/weight", HTTP_POST, [](AsyncWebServerRequest *request){
+            WeightBody* b = jsonBodyResult<WeightBody>(request);
+            if (!b) return;
+            if (!b->hasWeight) { request->send(400, "application/json", "{\"error\":\"missing weight\"}"); return; }
+            if (!b->weightValid || b->weight < 0) { request->send(400, "application/json", "{\"error\":\"invalid weight\"}"); return; }
+            float w = b->weight;
             int wi = (int)(w + (w >= 0 ? 0.5f : -0.5f));
-            if (w <= 0 && num.indexOf('0') != 0 && num.indexOf('.') != 0) { request->send(400, "application/json", "{\"error\":\"invalid weight\"}"); return; }
 
             // optional uid override
-            String uidOverride = lastUID;
-            int up = body.indexOf("\"uid\"");
-            if (up >= 0) {
-                int c2 = body.indexOf(':', up);
-                int uq1 = (c2 >= 0) ? body.indexOf('"', c2+1) : -1;
-                int uq2 = (uq1 >= 0) ? body.indexOf('"', uq1+1) : -1;
-                if (uq1 >= 0 && uq2 > uq1) uidOverride = body.substring(uq1+1, uq2);
-            }
+            const char* uidOverride = b->hasUid ? b->uid : currentUidDec;
 
             if (apiKey.length() == 0) { request->send(400, "application/json", "{\"error\":\"missing apiKey\"}"); return; }
-            if (uidOverride.length() == 0) { request->send(400, "application/json", "{\"error\":\"missing uid (present a tag)\"}"); return; }
-
-            HTTPClient http;
-            const char* url = "https://us-central1-tigertag-connect.cloudfunctions.net/setSpoolWeightByRfid";
-            if (!http.begin(url)) { request->send(500, "application/json", "{\"error\":\"http begin failed\"}"); return; }
-            http.addHeader("Content-Type", "application/json");
-            http.addHeader("x-api-key", apiKey);
-            String payload = String("{\"uid\":\"") + uidOverride + "\",\"weight\":" + String(wi) + "}";
-            int code = http.POST(payload);
-            String resp = http.getString();
-            http.end();
-
-            if (code >= 200 && code < 300) {
-                currentWeight = (float)wi;
-                displayMessage("Synced \xE2\x9C\x93", String(wi) + " g", "to cloud");
-                delay(700);
-                lastUID = "";
-                lastPushedWeight = NAN;
-                stableSinceMs = 0;
-                stableCandidate = NAN;
-                displayWeight(currentWeight, lastUID);
-                request->send(200, "application/json", "{\"status\":\"ok\"}");
-            } else {
-                String err = String("{\"error\":\"upstream ") + code + "\",\"body\":" + '"' + resp + '"' + "}";
-                request->send(502, "application/json", err);
-            }
-        }
+            if (!uidOverride[0]) { request->send(400, "application/json", "{\"error\":\"missing uid (present a tag)\"}"); return; }
+
+            sendJobAccepted(request, jobEnqueue(JOB_PUSH_WEIGHT, uidOverride, wi));
+        }, NULL, jsonBodyChunk<WeightBody>
     );
 
-    server.on("/api/push-weight", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-            String body = String((const char*)data).substring(0, len);
-            int wp = body.indexOf("weight");
-            if (wp < 0) { request->send(400, "application/json", "{\"error\":\"missing weight\"}"); return; }
-            int colon = body.indexOf(':', wp);
-            if (colon < 0) { request->send(400, "application/json", "{\"error\":\"bad json\"}"); return; }
-            String num = body.substring(colon+1);
-            num.trim();
-            while (num.length() && (num[num.length()-1] < '0' || num[num.length()-1] > '9') && num[num.length()-1] != '.' ) num.remove(num.length()-1);
-            while (num.length() && ( (num[0] < '0' || num[0] > '9') && num[0] != '-' && num[0] != '.' )) num.remove(0,1);
-            float w = num.toFloat();
+    server.on("/api/push-weight", HTTP_POST, [](AsyncWebServerRequest *request){
+            WeightBody* b = jsonBodyResult<WeightBody>(request);
+            if (!b) return;
+            if (!b->hasWeight) { request->send(400, "application/json", "{\"error\":\"missing weight\"}"); return; }
+            if (!b->weightValid || b->weight < 0) { request->send(400, "application/json", "{\"error\":\"invalid weight\"}"); return; }
+            float w = b->weight;
             int wi = (int)(w + (w >= 0 ? 0.5f : -0.5f));
-            if (w <= 0 && num.indexOf('0') != 0 && num.indexOf('.') != 0) { request->send(400, "application/json", "{\"error\":\"invalid weight\"}"); return; }
 
             if (apiKey.length() == 0) { request->send(400, "application/json", "{\"error\":\"missing apiKey\"}"); return; }
-            if (lastUID.length() == 0) { request->send(400, "application/json", "{\"error\":\"missing uid (present a tag)\"}"); return; }
-
-            HTTPClient http;
-            const char* url = "https://us-central1-tigertag-connect.cloudfunctions.net/setSpoolWeightByRfid";
-            if (!http.begin(url)) { request->send(500, "application/json", "{\"error\":\"http begin failed\"}"); return; }
-            http.addHeader("Content-Type", "application/json");
-            http.addHeader("x-api-key", apiKey);
-            String payload = String("{\"uid\":\"") + lastUID + "\",\"weight\":" + String(wi) + "}";
-            int code = http.POST(payload);
-            String resp = http.getString();
-            http.end();
-
-            if (code >= 200 && code < 300) {
-                currentWeight = (float)wi;
-                displayMessage("Synced \xE2\x9C\x93", String(wi) + " g", "to cloud");
-                delay(700);
-                lastUID = "";
-                lastPushedWeight = NAN;
-                stableSinceMs = 0;
-                stableCandidate = NAN;
-                char buf[64];
-                snprintf(buf, sizeof(buf), "{\"weight\":%d,\"uid\":\"%s\"}", wi, lastUID.c_str());
-                ws.textAll(buf);
-                displayWeight(currentWeight, lastUID);
-                request->send(200, "application/json", "{\"status\":\"ok\"}");
-            } else {
-                String err = String("{\"error\":\"upstream ") + code + "\",\"body\":" + '"' + resp + '"' + "}";
-                request->send(502, "application/json", err);
-            }
-        }
+            if (currentUid.empty()) { request->send(400, "application/json", "{\"error\":\"missing uid (present a tag)\"}"); return; }
+
+            sendJobAccepted(request, jobEnqueue(JOB_PUSH_WEIGHT, currentUidDec, wi));
+        }, NULL, jsonBodyChunk<WeightBody>
     );
 
+    // scale.tare() reads the HX711 for ~1 s: done by loop(), which owns the ADC
     server.on("/api/tare", HTTP_POST, [](AsyncWebServerRequest *request){
-        scale.tare();
-        currentWeight = 0.0f;
-        char buf[64];
-        snprintf(buf, sizeof(buf), "{\"weight\":%.2f,\"uid\":\"%s\"}", currentWeight, lastUID.c_str());
-        ws.textAll(buf);
-        request->send(200, "application/json", "{\"status\":\"ok\"}");
+        sendJobAccepted(request, jobEnqueue(JOB_TARE, nullptr, 0));
     });
 
-    server.on("/api/calibration", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
-        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
-            String body = String((const char*)data).substring(0, len);
-            int p = body.indexOf("factor");
-            if (p < 0) p = body.indexOf("value");
-            if (p < 0) { request->send(400, "application/json", "{\"error\":\"missing factor/value\"}"); return; }
-            int colon = body.indexOf(':', p);
-            if (colon < 0) { request->send(400, "application/json", "{\"error\":\"bad json\"}"); return; }
-            String num = body.substring(colon+1); num.trim();
-            while (num.length() && (num[num.length()-1] < '0' || num[num.length()-1] > '9') && num[num.length()-1] != '.' && num[num.length()-1] != '-') num.remove(num.length()-1);
-            while (num.length() && ((num[0] < '0' || num[0] > '9') && num[0] != '-' && num[0] != '.')) num.remove(0,1);
-            float f = num.toFloat();
-            if (f == 0.0f) { request->send(400, "application/json", "{\"error\":\"invalid factor\"}"); return; }
+    server.on("/api/calibration", HTTP_POST, [](AsyncWebServerRequest *request){
+            CalibrationBody* b = jsonBodyResult<CalibrationBody>(request);
+            if (!b) return;
+            if (!b->hasFactor) { request->send(400, "application/json", "{\"error\":\"missing factor/value\"}"); return; }
+            float f = b->factor;
+            if (!b->factorValid || !calibrationFactorValid(f)) { request->send(400, "application/json", "{\"error\":\"invalid factor\"}"); return; }
 
             calibrationFactor = f;
             scale.set_scale(calibrationFactor);
@@ -891,9 +1464,103 @@ void setupWebServer() {
             prefs.putFloat("calFactor", calibrationFactor);
             prefs.end();
             request->send(200, "application/json", "{\"status\":\"ok\"}");
-        }
+        }, NULL, jsonBodyChunk<CalibrationBody>
     );
     
+    // MQTT: configuration + queue statistics (password is never echoed back)
+    server.on("/api/mqtt", HTTP_GET, [](AsyncWebServerRequest *request){
+        MqttConfig c = mqttConfig();
+        MqttStats st = mqttStats();
+        StaticJsonDocument<384> out;
+        out["enabled"] = c.enabled;
+        out["host"] = c.host;
+        out["port"] = c.port;
+        out["user"] = c.user;
+        out["topic"] = c.prefix + "/" + gMdnsName;
+        out["connected"] = st.connected;
+        out["queued"] = st.queued;
+        out["published"] = st.published;
+        out["coalesced"] = st.coalesced;
+        out["dropped"] = st.dropped;
+        out["retries"] = st.retries;
+        String outStr; serializeJson(out, outStr);
+        request->send(200, "application/json", outStr);
+    });
+
+    server.on("/api/mqtt", HTTP_POST, [](AsyncWebServerRequest *request){
+            MqttBody* b = jsonBodyResult<MqttBody>(request);
+            if (!b) return;
+            MqttConfig c = mqttConfig();
+            if (b->hasEnabled) c.enabled = b->enabled;
+            if (b->hasHost)    c.host = b->host;
+            if (b->hasPort)    c.port = b->port;
+            if (b->hasUser)    c.user = b->user;
+            if (b->hasPass)    c.pass = b->pass;
+            if (b->hasTopic)   c.prefix = b->topic;
+            if (c.enabled && c.host.length() == 0) { request->send(400, "application/json", "{\"error\":\"missing host\"}"); return; }
+            mqttApplyConfig(c);
+            request->send(200, "application/json", "{\"status\":\"ok\"}");
+        }, NULL, jsonBodyChunk<MqttBody>
+    );
+
+    // Binary sample stream (/ws/stream): throughput and CPU cost of the last second
+    server.on("/api/stream", HTTP_GET, [](AsyncWebServerRequest *request){
+        StreamStats st = sampleStreamStats();
+        StaticJsonDocument<320> out;
+        out["clients"] = st.clients;
+        out["frames"] = st.frames;
+        out["samples"] = st.samples;
+        out["dropped"] = st.dropped;
+        out["framesPerSec"] = st.framesPerSec;
+        out["samplesPerSec"] = st.samplesPerSec;
+        out["busyUsPerSec"] = st.busyUsPerSec;
+        out["cpuPercent"] = st.busyUsPerSec / 10000.0f;
+        out["maxFlushUs"] = st.maxFlushUs;
+        out["batch"] = STREAM_BATCH_SAMPLES;
+        String outStr; serializeJson(out, outStr);
+        request->send(200, "application/json", outStr);
+    });
+
+    // Weight history: ?from=&to= in seconds since boot (<= 0: relative to now),
+    // ?points= (default 200), ?mode=minmax|lttb. Streamed with chunked encoding.
+    server.on("/api/history", HTTP_GET, [](AsyncWebServerRequest *request){
+        long now = (long)historyNow();
+        long to = request->hasParam("to") ? request->getParam("to")->value().toInt() : now;
+        if (to <= 0) to += now;
+        long from = request->hasParam("from") ? request->getParam("from")->value().toInt() : to - HISTORY_T0_SLOTS;
+        if (from <= 0 && request->hasParam("from")) from += now;
+        to = constrain(to, 0L, now);
+        from = constrain(from, 0L, to);
+        long points = request->hasParam("points") ? request->getParam("points")->value().toInt() : HISTORY_DEFAULT_POINTS;
+        HistoryMode mode = HISTORY_MINMAX;
+        if (request->hasParam("mode") && request->getParam("mode")->value() == "lttb") mode = HISTORY_LTTB;
+        request->send(historyBeginResponse(request, (uint32_t)from, (uint32_t)to,
+                                           (uint16_t)constrain(points, 2L, (long)HISTORY_MAX_POINTS), mode));
+    });
+
+    // RAM asset cache contents (for checking what is served without LittleFS)
+    server.on("/api/assets", HTTP_GET, [](AsyncWebServerRequest *request){
+        DynamicJsonDocument out(1536);
+        out["source"] = assetCacheEmbedded() ? "firmware" : "ram";
+#ifdef WEB_ASSETS_EMBEDDED
+        out["version"] = WEB_ASSETS_VERSION;
+#endif
+        out["arenaBytes"] = assetCacheArenaBytes();
+        out["misses"] = assetCacheMisses();
+        JsonArray arr = out.createNestedArray("entries");
+        for (size_t i = 0; i < assetCacheCount(); ++i) {
+            const AssetEntry* e = assetCacheEntry(i);
+            JsonObject o = arr.createNestedObject();
+            o["url"] = (const char*)e->url;
+            o["len"] = e->len;
+            o["encoding"] = assetEncodingName(e->encoding);
+            o["etag"] = (const char*)e->etag;
+            o["hits"] = e->hits;
+        }
+        String outStr; serializeJson(out, outStr);
+        request->send(200, "application/json", outStr);
+    });
+
     // Page 404
     server.onNotFound([](AsyncWebServerRequest *request) {
         Serial.printf("[404] %s %s\n", request->method() == HTTP_GET ? "GET" : request->method() == HTTP_POST ? "POST" : request->method() == HTTP_DELETE ? "DELETE" : request->method() == HTTP_PUT ? "PUT" : "OTHER", request->url().c_str());
@@ -905,23 +1572,31 @@ void setupWebServer() {
 }
 
 // Helper: push weight to TigerTag Cloud Function
-bool pushWeightToCloud(float w) {
+bool pushWeightToCloud(float w, int* httpCodeOut, const char* uid) {
+    if (httpCodeOut) *httpCodeOut = 0;
+    if (!uid) uid = currentUidDec;
     if (!wifiConnected || !WiFi.isConnected()) return false;
-    if (apiKey.length() == 0 || lastUID.length() == 0) return false;
+    if (apiKey.length() == 0 || !*uid) return false;
 
     HTTPClient http;
     const char* url = "https://us-central1-tigertag-connect.cloudfunctions.net/setSpoolWeightByRfid";
-    if (!http.begin(url)) return false;
+    metricsAdd(MC_PUSH_ATTEMPTS);
+    if (!http.begin(url)) { metricsAdd(MC_PUSH_FAILURE); return false; }
     http.addHeader("Content-Type", "application/json");
     http.addHeader("x-api-key", apiKey);
     int wInt = (int)(w + (w >= 0 ? 0.5f : -0.5f));
-    String payload = String("{\"uid\":\"") + lastUID + "\",\"weight\":" + String(wInt) + "}";
+    String payload = String("{\"uid\":\"") + uid + "\",\"weight\":" + String(wInt) + "}";
+    uint32_t startMs = millis();
     int code = http.POST(payload);
     String resp = http.getString();
     http.end();
+    metricsObservePushMs(millis() - startMs);
+    if (httpCodeOut) *httpCodeOut = code;
     if (code >= 200 && code < 300) {
+        metricsAdd(MC_PUSH_SUCCESS);
         return true;
     }
+    metricsAdd(MC_PUSH_FAILURE);
     Serial.printf("[AutoPush] Upstream error %d: %s\n", code, resp.c_str());
     return false;
 }
@@ -936,7 +1611,11 @@ void handleAutoPush(float w) {
     }
 
     // Preconditions to consider any auto-send
-    if (w < MIN_WEIGHT_TO_SEND_G || apiKey.length() == 0 || lastUID.length() == 0 || !WiFi.isConnected()) {
+    // 🔎 Several tags = several spools on the platform: the weight is a sum and
+    //    must not be pushed under one UID (it is only flagged, see /api/tags).
+    // A tag is pushed once per stay on the scale (see currentPushed).
+    if (w < MIN_WEIGHT_TO_SEND_G || apiKey.length() == 0 || currentUid.empty() || currentPushed ||
+        !WiFi.isConnected() || rfidTagCount() > 1) {
         sendPhase = "";            // idle
         sendCountdown = -1;
         stableSinceMs = 0;
@@ -983,29 +1662,28 @@ void handleAutoPush(float w) {
     sendPhase = "send";
     sendCountdown = 0;
 
-    displayMessage("Sending...", String("UID ") + lastUID, String(w, 1) + " g");
-    bool ok = pushWeightToCloud(w);
+    char uidLine[32], grams[16];
+    snprintf(uidLine, sizeof(uidLine), "UID %s", currentUidDec);
+    snprintf(grams, sizeof(grams), "%.1f g", w);
+    // Stays up through the blocking HTTPS push (the flush task draws it)
+    notify("Sending...", uidLine, grams, NOTIFY_SENDING_MS, NOTIFY_INFO, NOTIFY_KEY_PUSH);
+    int httpCode = 0;
+    bool ok = pushWeightToCloud(w, &httpCode);
+    int wInt = (int)(w + (w >= 0 ? 0.5f : -0.5f));
+    mqttPublishPushResult(ok, httpCode, wInt, currentUidDec);
     if (ok) {
-        int wInt = (int)(w + (w >= 0 ? 0.5f : -0.5f));
         lastPushedWeight = w;
         lastPushMs = now;
-        displayMessage("Synced \xE2\x9C\x93", String(wInt) + " g", "to cloud");
-        delay(700);
-        lastUID = "";
-        lastPushedWeight = NAN;
+        currentPushed = true;
         stableSinceMs = 0;
         stableCandidate = NAN;
-        char buf[64];
-        snprintf(buf, sizeof(buf), "{\"weight\":%d,\"uid\":\"%s\"}", wInt, lastUID.c_str());
-        ws.textAll(buf);
-        displayWeight((float)wInt, lastUID);
+        snprintf(grams, sizeof(grams), "%d g", wInt);
+        notify("Synced \xE2\x9C\x93", grams, "to cloud", NOTIFY_RESULT_MS, NOTIFY_RESULT, NOTIFY_KEY_PUSH);
         sendPhase = "success";
         sendPhaseLastChangeMs = millis();
         sendCountdown = -1;
     } else {
-        displayMessage("Sync failed", "Check Wi‑Fi/API", String(w, 1) + " g");
-        delay(700);
-        displayWeight(w, lastUID);
+        notify("Sync failed", "Check Wi-Fi/API", grams, NOTIFY_ERROR_MS, NOTIFY_ERROR, NOTIFY_KEY_PUSH);
         sendPhase = "error";
         sendPhaseLastChangeMs = millis();
         sendCountdown = -1;
@@ -1029,6 +1707,12 @@ void startMDNS() {
     }
 }
 
+void cacheWifiInfo() {
+    strlcpy(gWifiSsid, WiFi.SSID().c_str(), sizeof(gWifiSsid));
+    IPAddress ip = WiFi.localIP();
+    snprintf(gWifiIp, sizeof(gWifiIp), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+}
+
 void onWiFiEvent(WiFiEvent_t event) {
     switch (event) {
         case ARDUINO_EVENT_WIFI_STA_GOT_IP:
@@ -1036,7 +1720,8 @@ void onWiFiEvent(WiFiEvent_t event) {
         case SYSTEM_EVENT_STA_GOT_IP:
 #endif
             wifiConnected = true;
-            Serial.println("[WiFi] GOT_IP: " + WiFi.localIP().toString());
+            cacheWifiInfo();
+            Serial.printf("[WiFi] GOT_IP: %s\n", gWifiIp);
             startMDNS();
             break;
         case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
@@ -1044,6 +1729,7 @@ void onWiFiEvent(WiFiEvent_t event) {
         case SYSTEM_EVENT_STA_DISCONNECTED:
 #endif
             wifiConnected = false;
+            strlcpy(gWifiIp, "0.0.0.0", sizeof(gWifiIp));
             Serial.println("[WiFi] DISCONNECTED");
             MDNS.end();
             break;
@@ -1070,8 +1756,12 @@ float readWeight() {
         return currentWeight; // keep last value if ADC not ready
     }
 
-    // 1) Fast raw read (low latency)
-    float raw = scale.get_units(1);
+    // 1) Fast raw read (low latency). Counts are kept for the binary stream;
+    //    same conversion as get_units(1).
+    long counts = scale.read();
+    float raw = (float)(counts - scale.get_offset()) / scale.get_scale();
+    metricsAdd(MC_SAMPLES);
+    uint32_t filterStartUs = micros();
 
     // 2) Update small median window
     gMedianBuf[gMedianIdx] = raw;
@@ -1093,6 +1783,14 @@ float readWeight() {
     else { gEmaWeight = gEmaWeight + EMA_ALPHA * (med - gEmaWeight); }
 
     currentWeight = gEmaWeight; // smoothed float (can be negative)
+    metricsObserveFilterUs(micros() - filterStartUs);
+
+    uint8_t flags = 0;
+    if (holdMode) flags |= STREAM_FLAG_HOLD;
+    if (!currentUid.empty()) flags |= STREAM_FLAG_TAG;
+    if (rfidTagCount() > 1) flags |= STREAM_FLAG_MULTI;
+    sampleStreamPush((int32_t)counts, currentWeight, flags);
+    historyAddSample(currentWeight, millis());
     return currentWeight;
 }
 
@@ -1100,47 +1798,80 @@ float readWeight() {
 // GESTION RFID
 // ============================================================================
 
-static String u64ToDec(uint64_t v) {
-    if (v == 0) return String("0");
-    char buf[21];
-    buf[20] = '\0';
-    int i = 20;
-    while (v > 0 && i > 0) {
-        uint64_t q = v / 10ULL;
-        uint8_t r = (uint8_t)(v - q * 10ULL);
-        buf[--i] = '0' + r;
-        v = q;
-    }
-    return String(&buf[i]);
-}
-
 void setupRFID() {
-    SPI.begin();
-    rfid.PCD_Init();
+    tagCacheBegin(LittleFS);
+    rfidBegin(RC522_SS, RC522_RST, RC522_IRQ);
     displayMessage("RFID OK", "RC522 ready");
     delay(1000);
 }
 
-String readRFID() {
-    if (!rfid.PICC_IsNewCardPresent() || !rfid.PICC_ReadCardSerial()) {
-        return "";
-    }
+static void broadcastTagEvent(const char* event, const TagUid& uid, uint8_t count) {
+    char buf[112];
+    snprintf(buf, sizeof(buf), "{\"type\":\"tag\",\"event\":\"%s\",\"uid\":\"%s\",\"count\":%u}",
+             event, TagUidDec(uid).str, count);
+    ws.textAll(buf);
+}
+
+// Auto-push restarts from scratch for whatever is on the scale now
+static void resetAutoPushTracking() {
+    stableCandidate = NAN;
+    stableSinceMs = 0;
+    lastPushedWeight = NAN;
+    currentPushed = false;
+}
 
-    String hexStr; hexStr.reserve(rfid.uid.size * 2);
-    uint64_t decVal = 0ULL;
-    for (byte i = 0; i < rfid.uid.size; i++) {
-        byte b = rfid.uid.uidByte[i];
-        if (b < 0x10) hexStr += '0';
-        hexStr += String(b, HEX);
-        decVal = (decVal << 8) | b;
+static TigerTagInfo decodeSpool(const RfidTag& tag) {
+    TigerTagInfo spool;
+    if (!tag.hasUser || !tigertagDecode(tag.user, sizeof(tag.user), &spool)) spool.valid = false;
+    return spool;
+}
+
+// The most recent arrival is the tag auto-push and the UI refer to
+static void adoptTag(const RfidTag& tag) {
+    setCurrentUid(tag.uid);
+    gSpool = decodeSpool(tag);
+    resetAutoPushTracking();
+}
+
+static void onTagArrived(const RfidTag& tag) {
+    metricsAdd(MC_RFID_READS);
+    if (tag.uid == currentUid) { gSpool = decodeSpool(tag); return; }
+
+    adoptTag(tag);
+    Serial.printf("UID detected (DEC): %s  (HEX): %s\n", currentUidDec, currentUidHex);
+    if (gSpool.valid) {
+        Serial.printf("[TAG] material %u, nominal %lu g, tare %u g\n", gSpool.materialId,
+                      (unsigned long)gSpool.nominalG, gSpool.tareG);
     }
-    hexStr.toUpperCase();
+    if (rfidTagCount() > 1) Serial.printf("[TAG] %u tags on the platform\n", rfidTagCount());
+    broadcastTagEvent("arrived", currentUid, rfidTagCount());
+}
 
-    lastUIDHex = hexStr;
-    String decStr = u64ToDec(decVal);
+// 🔎 Without this, the UID outlived the spool until the next successful push,
+//    so a spool swapped before its push was sent under the previous UID.
+static void onTagRemoved(const RfidTag& tag) {
+    Serial.printf("[TAG] removed: %s\n", TagUidDec(tag.uid).str);
+    broadcastTagEvent("removed", tag.uid, rfidTagCount());
+    if (tag.uid != currentUid) return;   // another tag: the current one stays
 
-    rfid.PICC_HaltA();
-    return decStr;
+    if (rfidTagCount() > 0) {
+        adoptTag(*rfidTagAt(rfidTagCount() - 1));
+    } else {
+        setCurrentUid(TagUid());
+        gSpool.valid = false;
+        resetAutoPushTracking();
+    }
+}
+
+// 🔎 Non-blocking: rfidPoll() only sends a REQA/WUPA when its period is due
+//    and returns immediately; tags are read once, then probed for presence.
+void readRFID() {
+    RfidTag tag;
+    switch (rfidPoll(millis(), &tag)) {
+        case RFID_EVT_ARRIVED: onTagArrived(tag); break;
+        case RFID_EVT_REMOVED: onTagRemoved(tag); break;
+        default: break;
+    }
 }
 
 // ============================================================================
@@ -1182,13 +1913,15 @@ void setup() {
         Serial.println(F("Erreur OLED"));
         while (1);
     }
+    display.beginAsync(OLED_I2C_MAX_HZ, OLED_TASK_CORE);
     
     displayMessage("TigerTagScale", "Starting...", "v1.1.0");
     delay(2000);
     
     prefs.begin("config", true);
     apiKey = prefs.getString("apiKey", "");
-    calibrationFactor = prefs.getFloat("calFactor", calibrationFactor);
+    float storedFactor = prefs.getFloat("calFactor", calibrationFactor);
+    if (calibrationFactorValid(storedFactor)) calibrationFactor = storedFactor;
     apiDisplayName = prefs.getString("apiName", "");
     prefs.end();
     
@@ -1210,8 +1943,16 @@ void setup() {
         }
     }
     
+#ifdef WEB_ASSETS_EMBEDDED
+    // UI is part of the firmware: serve it before mounting LittleFS (images only)
+    assetCacheBeginEmbedded(kEmbeddedAssets, kEmbeddedAssetCount);
+    setupWebServer();
+    setupFileSystem();
+#else
     setupFileSystem();  // ← AJOUTÉ : Monte LittleFS
     setupWebServer();
+#endif
+    mqttSetup(gMdnsName);
     setupScale();
     setupRFID();
     
@@ -1221,6 +1962,7 @@ void setup() {
         gMdnsName + ".local",
         "Place an Spool.."
     );
+    refreshStatusSnapshot();
 }
 
 void loop() {
@@ -1232,22 +1974,21 @@ void loop() {
         lastBlink = millis();
     }
     
-    String uid = readRFID();
-    if (uid.length() > 0 && uid != lastUID) {
-        lastUID = uid;
-        Serial.println("UID detected (DEC): " + lastUID + "  (HEX): " + lastUIDHex);
-    }
+    uint32_t rfidStartUs = micros();
+    readRFID();
+    metricsObserveRfidUs(micros() - rfidStartUs);
     
     float weight = readWeight();
+    rfidNoteWeight(weight, millis());
 
     // --- Hold mode logic ---
-    float displayedWeight = weight;
     if (!holdMode) {
         if (fabs(weight - holdWeight) < HOLD_THRESHOLD_ENTER) {
             if (holdStartMs == 0) holdStartMs = millis();
             if (millis() - holdStartMs > HOLD_TIME_MS) {
                 holdMode = true;
                 holdWeight = weight;
+                mqttPublishStable((int)(holdWeight + (holdWeight >= 0 ? 0.5f : -0.5f)), currentUidDec);
             }
         } else {
             holdStartMs = 0;
@@ -1261,15 +2002,25 @@ void loop() {
         }
     }
     displayedWeight = holdMode ? holdWeight : weight;
+    refreshStatusSnapshot();
+
+    broadcastStatusDelta();
 
     if (millis() - lastUpdate > WS_UPDATE_INTERVAL_MS) {
-        displayWeight(displayedWeight, lastUID);
+        displayWeight(displayedWeight, currentUidDec);
         
         int wInt = (int)(displayedWeight + (displayedWeight >= 0 ? 0.5f : -0.5f));
-        String json = "{\"weight\":" + String(wInt) + 
-                      ",\"uid\":\"" + lastUID + "\"}";
-        ws.textAll(json);
-        ws.cleanupClients();
+        ws.cleanupClients(WS_MAX_TRACKED_CLIENTS);
+
+        // MQTT: retained topics only when the displayed integer / tag changes
+        static int lastMqttWeight = INT32_MIN;
+        static TagUid lastMqttUid;
+        if (currentUid != lastMqttUid) mqttPublishUid(currentUidDec);
+        if (wInt != lastMqttWeight || currentUid != lastMqttUid) {
+            mqttPublishWeight(wInt, currentUidDec);
+            lastMqttWeight = wInt;
+            lastMqttUid = currentUid;
+        }
         
         lastUpdate = millis();
     }
@@ -1288,6 +2039,9 @@ void loop() {
     }
 
     handleAutoPush(weight);
+    runDeferredJobs();
+    mqttLoop();
+    sampleStreamLoop();
     
     delay(10);
 }
\ No newline at end of file
@@ -0,0 +1,215 @@
+/*
+ * @file metrics.cpp
+ * @brief TigerTagScale - Compteurs atomiques + rendu du format texte Prometheus
+ */
+
+#include "metrics.h"
+
+#include <WiFi.h>
+#include <atomic>
+#include <stdarg.h>
+#include <esp_heap_caps.h>
+
+// Upper bounds of the push latency histogram, in milliseconds (+Inf is implicit)
+static const uint32_t kPushBucketsMs[] = { 250, 500, 1000, 2000, 5000, 10000 };
+#define PUSH_BUCKETS (sizeof(kPushBucketsMs) / sizeof(kPushBucketsMs[0]))
+
+static std::atomic<uint32_t> gCounters[MC_COUNT];
+static std::atomic<uint32_t> gFilterCount{0};
+static std::atomic<uint32_t> gFilterSumUs{0};
+static std::atomic<uint32_t> gFilterMaxUs{0};
+static std::atomic<uint32_t> gRfidCount{0};
+static std::atomic<uint32_t> gRfidSumUs{0};
+static std::atomic<uint32_t> gRfidMaxUs{0};
+static std::atomic<uint32_t> gOledCount{0};
+static std::atomic<uint32_t> gOledSumUs{0};
+static std::atomic<uint32_t> gOledMaxUs{0};
+static std::atomic<uint32_t> gOledLatCount{0};
+static std::atomic<uint32_t> gOledLatSumUs{0};
+static std::atomic<uint32_t> gOledLatMaxUs{0};
+static std::atomic<uint32_t> gPushBuckets[PUSH_BUCKETS + 1];   // non-cumulative, last = +Inf
+static std::atomic<uint32_t> gPushSumMs{0};
+static std::atomic<uint32_t> gTagReadCount[TAG_READ_PATHS];
+static std::atomic<uint32_t> gTagReadSumUs[TAG_READ_PATHS];
+static const char* const kTagReadPaths[TAG_READ_PATHS] = { "cache", "fast_read", "read" };
+
+struct CounterInfo {
+    const char* name;
+    const char* help;
+    const char* labels;    // nullptr or `key="value"`
+};
+
+// Same order as MetricCounter
+static const CounterInfo kCounters[MC_COUNT] = {
+    { "tigerscale_samples_total",          "HX711 conversions read",                                   nullptr },
+    { "tigerscale_samples_dropped_total",  "Samples dropped by /ws/stream backpressure",               nullptr },
+    { "tigerscale_rfid_reads_total",       "RFID tag UIDs read",                                       nullptr },
+    { "tigerscale_rfid_polls_total",       "REQA frames sent to detect a tag",                         nullptr },
+    { "tigerscale_rfid_spi_total",         "RC522 register accesses by the detection loop (excludes UID select)", nullptr },
+    { "tigerscale_rfid_removals_total",    "Tags that stopped answering presence probes",              nullptr },
+    { "tigerscale_rfid_set_full_total",    "Tags left out because the tag set was full",               nullptr },
+    { "tigerscale_push_attempts_total",    "Cloud weight pushes issued",                               nullptr },
+    { "tigerscale_push_success_total",     "Cloud weight pushes answered with 2xx",                    nullptr },
+    { "tigerscale_push_failures_total",    "Cloud weight pushes that failed (transport or non-2xx)",  nullptr },
+    { "tigerscale_ws_bytes_sent_total",    "WebSocket payload bytes queued to clients",                "channel=\"status\"" },
+    { "tigerscale_ws_bytes_sent_total",    nullptr,                                                    "channel=\"stream\"" },
+    { "tigerscale_ws_deltas_total",        "Status delta frames built",                                nullptr },
+    { "tigerscale_ws_keepalives_total",    "Status keepalive frames built",                            nullptr },
+    { "tigerscale_ws_coalesced_total",     "Status deltas deferred for a slow client",                 nullptr },
+    { "tigerscale_ws_catchups_total",      "Catch-up frames sent to clients that fell behind",         nullptr },
+    { "tigerscale_http_rejected_total",    "Requests refused by admission control (503)",              "reason=\"heap_low\"" },
+    { "tigerscale_http_rejected_total",    nullptr,                                                    "reason=\"heap_critical\"" },
+    { "tigerscale_http_rejected_total",    nullptr,                                                    "reason=\"busy\"" },
+    { "tigerscale_http_rejected_total",    nullptr,                                                    "reason=\"ws_clients\"" },
+    { "tigerscale_oled_flushes_total",     "OLED flushes, by whether the frame had changed",           "result=\"sent\"" },
+    { "tigerscale_oled_flushes_total",     nullptr,                                                    "result=\"unchanged\"" },
+    { "tigerscale_oled_i2c_bytes_total",   "Bytes sent on the I2C bus by OLED flushes",                nullptr },
+    { "tigerscale_oled_frames_total",      "Frames presented to the OLED flush task",                  nullptr },
+    { "tigerscale_oled_coalesced_total",   "OLED frames replaced by a newer one before being sent",    nullptr },
+};
+
+void metricsAdd(MetricCounter c, uint32_t n) {
+    gCounters[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+static void storeMax(std::atomic<uint32_t>& slot, uint32_t v) {
+    uint32_t cur = slot.load(std::memory_order_relaxed);
+    while (v > cur && !slot.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+}
+
+void metricsObserveFilterUs(uint32_t us) {
+    gFilterCount.fetch_add(1, std::memory_order_relaxed);
+    gFilterSumUs.fetch_add(us, std::memory_order_relaxed);
+    storeMax(gFilterMaxUs, us);
+}
+
+void metricsObserveRfidUs(uint32_t us) {
+    gRfidCount.fetch_add(1, std::memory_order_relaxed);
+    gRfidSumUs.fetch_add(us, std::memory_order_relaxed);
+    storeMax(gRfidMaxUs, us);
+}
+
+void metricsObserveOledFlushUs(uint32_t us) {
+    gOledCount.fetch_add(1, std::memory_order_relaxed);
+    gOledSumUs.fetch_add(us, std::memory_order_relaxed);
+    storeMax(gOledMaxUs, us);
+}
+
+void metricsObserveOledLatencyUs(uint32_t us) {
+    gOledLatCount.fetch_add(1, std::memory_order_relaxed);
+    gOledLatSumUs.fetch_add(us, std::memory_order_relaxed);
+    storeMax(gOledLatMaxUs, us);
+}
+
+void metricsObservePushMs(uint32_t ms) {
+    size_t i = 0;
+    while (i < PUSH_BUCKETS && ms > kPushBucketsMs[i]) i++;
+    gPushBuckets[i].fetch_add(1, std::memory_order_relaxed);
+    gPushSumMs.fetch_add(ms, std::memory_order_relaxed);
+}
+
+void metricsObserveTagReadUs(TagReadPath path, uint32_t us) {
+    gTagReadCount[path].fetch_add(1, std::memory_order_relaxed);
+    gTagReadSumUs[path].fetch_add(us, std::memory_order_relaxed);
+}
+
+// Appends to buf; sticky failure once the buffer is full
+struct Writer {
+    char*  buf;
+    size_t cap;
+    size_t len;
+    bool   full;
+
+    __attribute__((format(printf, 2, 3))) void add(const char* fmt, ...) {
+        if (full) return;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(buf + len, cap - len, fmt, ap);
+        va_end(ap);
+        if (n < 0 || (size_t)n >= cap - len) { full = true; return; }
+        len += n;
+    }
+
+    void header(const char* name, const char* type, const char* help) {
+        add("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    void gauge(const char* name, const char* help, double v) {
+        header(name, "gauge", help);
+        add("%s %.15g\n", name, v);
+    }
+};
+
+size_t metricsRender(char* buf, size_t cap, const MetricsGauges& gauges) {
+    Writer w = { buf, cap, 0, false };
+
+    for (size_t i = 0; i < MC_COUNT; ++i) {
+        const CounterInfo& c = kCounters[i];
+        if (c.help) w.header(c.name, "counter", c.help);
+        uint32_t v = gCounters[i].load(std::memory_order_relaxed);
+        if (c.labels) w.add("%s{%s} %u\n", c.name, c.labels, v);
+        else w.add("%s %u\n", c.name, v);
+    }
+
+    w.header("tigerscale_filter_latency_seconds", "summary", "Median + EMA filter time per sample");
+    w.add("tigerscale_filter_latency_seconds_sum %.6f\n", gFilterSumUs.load(std::memory_order_relaxed) / 1e6);
+    w.add("tigerscale_filter_latency_seconds_count %u\n", gFilterCount.load(std::memory_order_relaxed));
+    w.gauge("tigerscale_filter_latency_max_seconds", "Slowest filter pass since boot",
+            gFilterMaxUs.load(std::memory_order_relaxed) / 1e6);
+
+    w.header("tigerscale_rfid_stage_seconds", "summary", "RFID stage time per loop pass");
+    w.add("tigerscale_rfid_stage_seconds_sum %.6f\n", gRfidSumUs.load(std::memory_order_relaxed) / 1e6);
+    w.add("tigerscale_rfid_stage_seconds_count %u\n", gRfidCount.load(std::memory_order_relaxed));
+    w.gauge("tigerscale_rfid_stage_max_seconds", "Slowest RFID stage since boot",
+            gRfidMaxUs.load(std::memory_order_relaxed) / 1e6);
+
+    w.header("tigerscale_oled_flush_seconds", "summary", "I2C time of OLED flushes that sent something");
+    w.add("tigerscale_oled_flush_seconds_sum %.6f\n", gOledSumUs.load(std::memory_order_relaxed) / 1e6);
+    w.add("tigerscale_oled_flush_seconds_count %u\n", gOledCount.load(std::memory_order_relaxed));
+    w.gauge("tigerscale_oled_flush_max_seconds", "Slowest OLED flush since boot",
+            gOledMaxUs.load(std::memory_order_relaxed) / 1e6);
+
+    w.header("tigerscale_oled_frame_latency_seconds", "summary", "From display() to the frame on the panel");
+    w.add("tigerscale_oled_frame_latency_seconds_sum %.6f\n", gOledLatSumUs.load(std::memory_order_relaxed) / 1e6);
+    w.add("tigerscale_oled_frame_latency_seconds_count %u\n", gOledLatCount.load(std::memory_order_relaxed));
+    w.gauge("tigerscale_oled_frame_latency_max_seconds", "Slowest OLED frame since boot",
+            gOledLatMaxUs.load(std::memory_order_relaxed) / 1e6);
+
+    w.header("tigerscale_push_latency_seconds", "histogram", "Cloud weight push round-trip time");
+    uint32_t cumulative = 0;
+    for (size_t i = 0; i <= PUSH_BUCKETS; ++i) {
+        cumulative += gPushBuckets[i].load(std::memory_order_relaxed);
+        if (i < PUSH_BUCKETS) {
+            w.add("tigerscale_push_latency_seconds_bucket{le=\"%g\"} %u\n", kPushBucketsMs[i] / 1000.0, cumulative);
+        } else {
+            w.add("tigerscale_push_latency_seconds_bucket{le=\"+Inf\"} %u\n", cumulative);
+        }
+    }
+    w.add("tigerscale_push_latency_seconds_sum %.3f\n", gPushSumMs.load(std::memory_order_relaxed) / 1000.0);
+    w.add("tigerscale_push_latency_seconds_count %u\n", cumulative);
+
+    w.header("tigerscale_rfid_tag_read_seconds", "summary", "Time to get the TigerTag pages of a selected tag");
+    for (size_t i = 0; i < TAG_READ_PATHS; ++i) {
+        w.add("tigerscale_rfid_tag_read_seconds_sum{path=\"%s\"} %.6f\n", kTagReadPaths[i],
+              gTagReadSumUs[i].load(std::memory_order_relaxed) / 1e6);
+        w.add("tigerscale_rfid_tag_read_seconds_count{path=\"%s\"} %u\n", kTagReadPaths[i],
+              gTagReadCount[i].load(std::memory_order_relaxed));
+    }
+
+    w.gauge("tigerscale_ws_clients", "Clients connected to /ws", gauges.wsClients);
+    w.gauge("tigerscale_ws_stream_clients", "Clients connected to /ws/stream", gauges.streamClients);
+    w.gauge("tigerscale_http_inflight", "HTTP requests admitted and still connected", gauges.inflight);
+    w.gauge("tigerscale_admission_level", "Heap pressure level (0 ok, 1 low, 2 critical)", gauges.admitLevel);
+    w.gauge("tigerscale_rfid_poll_interval_seconds", "Current REQA period", gauges.rfidPollMs / 1000.0);
+    w.gauge("tigerscale_rfid_spi_clock_hz", "RC522 SPI clock passed by the boot self-test", gauges.rfidSpiHz);
+    w.gauge("tigerscale_heap_free_bytes", "Free heap", ESP.getFreeHeap());
+    w.gauge("tigerscale_heap_largest_free_block_bytes", "Largest allocatable heap block",
+            heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    w.gauge("tigerscale_heap_min_free_bytes", "Lowest free heap since boot", ESP.getMinFreeHeap());
+    if (WiFi.isConnected()) {
+        w.gauge("tigerscale_wifi_rssi_dbm", "WiFi signal strength", WiFi.RSSI());
+    }
+    w.gauge("tigerscale_uptime_seconds", "Time since boot", millis() / 1000.0);
+
+    return w.full ? 0 : w.len;
+}
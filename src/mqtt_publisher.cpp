@@ -0,0 +1,310 @@
+/*
+ * @file mqtt_publisher.cpp
+ * @brief TigerTagScale - Client MQTT asynchrone avec file d'envoi en RAM
+ *
+ * Les producteurs (loop(), handlers HTTP) déposent des messages dans une file
+ * fixe de MQTT_QUEUE_SLOTS emplacements. mqttLoop() la vide vers le broker en
+ * QoS1 avec au plus MQTT_MAX_INFLIGHT messages non acquittés. Quand la file est
+ * pleine, les mises à jour d'état (weight/uid) sont coalescées sur la dernière
+ * valeur et les plus anciennes sont évincées avant tout évènement.
+ *
+ * La file elle-même (emplacements, fenêtre QoS1, DUP) est dans mqtt_queue.h,
+ * testée sur le poste ; ici ne restent le client, la configuration et les
+ * producteurs.
+ */
+
+#include "mqtt_publisher.h"
+
+#include <WiFi.h>
+#include <Preferences.h>
+#include <AsyncMqttClient.h>
+
+#define MQTT_RECONNECT_MIN_MS    2000
+#define MQTT_RECONNECT_MAX_MS    60000
+
+// Fixed-size copy of a MqttConfig: can be copied under gMqttMux (no heap)
+struct MqttConfigRaw {
+    bool     enabled;
+    uint16_t port;
+    char     host[64];
+    char     user[48];
+    char     pass[64];
+    char     prefix[32];
+};
+
+static AsyncMqttClient gMqtt;
+static MqttConfig gCfg;            // running configuration, loop() only
+static MqttConfigRaw gRequested;   // latest configuration (running or staged), under gMqttMux
+static volatile bool gStaged = false;      // gRequested not applied yet, under gMqttMux
+static MqttQueue gQueue;             // under gMqttMux
+static portMUX_TYPE gMqttMux = portMUX_INITIALIZER_UNLOCKED;
+
+// AsyncMqttClient keeps raw pointers: storage must outlive the client
+static char gHost[64];
+static char gUser[48];
+static char gPass[64];
+static char gClientId[40];
+static char gBase[MQTT_TOPIC_MAX - 8];
+static char gWillTopic[MQTT_TOPIC_MAX];
+
+static volatile bool gConnected = false;
+static volatile bool gJustConnected = false;
+static uint32_t gLastAttemptMs = 0;
+static uint32_t gBackoffMs = MQTT_RECONNECT_MIN_MS;
+static String gDeviceName;
+
+// ============================================================================
+// FILE D'ENVOI
+// ============================================================================
+
+// Returns false when the message had to be dropped (queue full of events).
+static bool enqueue(const char* sub, const char* payload, bool retain, bool coalesce) {
+    if (!gCfg.enabled) return false;
+
+    char topic[MQTT_TOPIC_MAX];
+    snprintf(topic, sizeof(topic), "%s/%s", gBase, sub);
+
+    portENTER_CRITICAL(&gMqttMux);
+    bool ok = gQueue.enqueue(topic, payload, retain, coalesce);
+    portEXIT_CRITICAL(&gMqttMux);
+    return ok;
+}
+
+// Sends pending messages in FIFO order while the in-flight window allows it.
+static void drainQueue() {
+    const uint32_t now = millis();
+    while (gConnected) {
+        MqttOutgoing out;
+        portENTER_CRITICAL(&gMqttMux);
+        bool any = gQueue.next(now, &out);
+        portEXIT_CRITICAL(&gMqttMux);
+        if (!any) return;
+
+        uint16_t id = gMqtt.publish(out.topic, 1, out.retain, out.payload, strlen(out.payload),
+                                    out.dup, out.packetId);
+        portENTER_CRITICAL(&gMqttMux);
+        gQueue.sent(out, id);
+        portEXIT_CRITICAL(&gMqttMux);
+        // Refused (TCP buffer full / disconnected): retry on next loop.
+        // One retransmission per pass is enough.
+        if (id == 0 || out.dup) return;
+    }
+}
+
+// ============================================================================
+// CALLBACKS (tâche AsyncTCP)
+// ============================================================================
+
+static void onMqttConnect(bool sessionPresent) {
+    Serial.printf("[MQTT] connected to %s:%u\n", gHost, gCfg.port);
+    gConnected = true;
+    gJustConnected = true;
+    gBackoffMs = MQTT_RECONNECT_MIN_MS;
+}
+
+static void onMqttDisconnect(AsyncMqttClientDisconnectReason reason) {
+    if (gConnected) Serial.printf("[MQTT] disconnected (reason %d)\n", (int)reason);
+    gConnected = false;
+    // Unacked messages go back to pending: they are re-sent after reconnect
+    portENTER_CRITICAL(&gMqttMux);
+    gQueue.disconnected();
+    portEXIT_CRITICAL(&gMqttMux);
+}
+
+static void onMqttPublish(uint16_t packetId) {
+    portENTER_CRITICAL(&gMqttMux);
+    gQueue.acked(packetId);
+    portEXIT_CRITICAL(&gMqttMux);
+}
+
+// ============================================================================
+// CONFIGURATION & CYCLE DE VIE
+// ============================================================================
+
+static void configureClient() {
+    strlcpy(gHost, gCfg.host.c_str(), sizeof(gHost));
+    strlcpy(gUser, gCfg.user.c_str(), sizeof(gUser));
+    strlcpy(gPass, gCfg.pass.c_str(), sizeof(gPass));
+    strlcpy(gClientId, gDeviceName.c_str(), sizeof(gClientId));
+    snprintf(gBase, sizeof(gBase), "%s/%s", gCfg.prefix.c_str(), gDeviceName.c_str());
+    snprintf(gWillTopic, sizeof(gWillTopic), "%s/status", gBase);
+
+    gMqtt.setServer(gHost, gCfg.port);
+    gMqtt.setClientId(gClientId);
+    gMqtt.setKeepAlive(15);
+    gMqtt.setCleanSession(true);
+    gMqtt.setWill(gWillTopic, 1, true, "offline");
+    if (gUser[0]) gMqtt.setCredentials(gUser, gPass[0] ? gPass : nullptr);
+    else          gMqtt.setCredentials(nullptr, nullptr);
+}
+
+static void toRaw(const MqttConfig& c, MqttConfigRaw& r) {
+    r.enabled = c.enabled;
+    r.port = c.port;
+    strlcpy(r.host, c.host.c_str(), sizeof(r.host));
+    strlcpy(r.user, c.user.c_str(), sizeof(r.user));
+    strlcpy(r.pass, c.pass.c_str(), sizeof(r.pass));
+    strlcpy(r.prefix, c.prefix.c_str(), sizeof(r.prefix));
+}
+
+static void fromRaw(const MqttConfigRaw& r, MqttConfig& c) {
+    c.enabled = r.enabled;
+    c.port = r.port;
+    c.host = r.host;
+    c.user = r.user;
+    c.pass = r.pass;
+    c.prefix = r.prefix;
+}
+
+// Persists and switches to a staged configuration (loop() only)
+static void applyStaged(const MqttConfigRaw& raw) {
+    MqttConfig cfg;
+    fromRaw(raw, cfg);
+
+    Preferences p;
+    p.begin("config", false);
+    p.putBool("mqttOn", cfg.enabled);
+    p.putString("mqttHost", cfg.host);
+    p.putUShort("mqttPort", cfg.port);
+    p.putString("mqttUser", cfg.user);
+    p.putString("mqttPass", cfg.pass);
+    p.putString("mqttTopic", cfg.prefix);
+    p.end();
+
+    if (gMqtt.connected()) gMqtt.disconnect();
+    gCfg = cfg;
+    configureClient();
+    gLastAttemptMs = 0;
+    gBackoffMs = MQTT_RECONNECT_MIN_MS;
+    if (!gCfg.enabled) {
+        portENTER_CRITICAL(&gMqttMux);
+        gQueue.clear();
+        portEXIT_CRITICAL(&gMqttMux);
+    }
+    Serial.printf("[MQTT] config applied: %s host=%s:%u base=%s\n",
+                  gCfg.enabled ? "enabled" : "disabled", gHost, gCfg.port, gBase);
+}
+
+void mqttSetup(const String& deviceName) {
+    gDeviceName = deviceName;
+
+    Preferences p;
+    p.begin("config", true);
+    gCfg.enabled = p.getBool("mqttOn", false);
+    gCfg.host    = p.getString("mqttHost", "");
+    gCfg.port    = p.getUShort("mqttPort", 1883);
+    gCfg.user    = p.getString("mqttUser", "");
+    gCfg.pass    = p.getString("mqttPass", "");
+    gCfg.prefix  = p.getString("mqttTopic", "tigerscale");
+    p.end();
+
+    MqttConfigRaw raw;
+    toRaw(gCfg, raw);
+    portENTER_CRITICAL(&gMqttMux);
+    gRequested = raw;
+    portEXIT_CRITICAL(&gMqttMux);
+
+    gMqtt.onConnect(onMqttConnect);
+    gMqtt.onDisconnect(onMqttDisconnect);
+    gMqtt.onPublish(onMqttPublish);
+    configureClient();
+
+    Serial.printf("[MQTT] %s host=%s:%u base=%s\n", gCfg.enabled ? "enabled" : "disabled",
+                  gHost, gCfg.port, gBase);
+}
+
+// 🔎 Called from the AsyncTCP task (POST /api/mqtt): only stages a fixed-size
+//    copy. gCfg, the client and the buffers it points to belong to loop(),
+//    where mqttLoop() picks the staged copy up.
+void mqttApplyConfig(const MqttConfig& cfg) {
+    MqttConfigRaw raw;
+    toRaw(cfg, raw);
+    portENTER_CRITICAL(&gMqttMux);
+    gRequested = raw;
+    gStaged = true;
+    portEXIT_CRITICAL(&gMqttMux);
+}
+
+MqttConfig mqttConfig() {
+    MqttConfigRaw raw;
+    portENTER_CRITICAL(&gMqttMux);
+    raw = gRequested;
+    portEXIT_CRITICAL(&gMqttMux);
+    MqttConfig c;
+    fromRaw(raw, c);
+    return c;
+}
+
+MqttStats mqttStats() {
+    portENTER_CRITICAL(&gMqttMux);
+    const MqttQueueStats q = gQueue.stats();
+    const uint32_t queued = gQueue.queued();
+    portEXIT_CRITICAL(&gMqttMux);
+    MqttStats s;
+    s.queued = queued;
+    s.published = q.published;
+    s.coalesced = q.coalesced;
+    s.dropped = q.dropped;
+    s.retries = q.retries;
+    s.connected = gConnected;
+    return s;
+}
+
+void mqttLoop() {
+    if (gStaged) {
+        MqttConfigRaw raw;
+        bool staged;
+        portENTER_CRITICAL(&gMqttMux);
+        staged = gStaged;
+        raw = gRequested;
+        gStaged = false;
+        portEXIT_CRITICAL(&gMqttMux);
+        if (staged) applyStaged(raw);
+    }
+
+    if (!gCfg.enabled || gCfg.host.length() == 0) return;
+
+    if (!gConnected) {
+        const uint32_t now = millis();
+        if (WiFi.isConnected() && now - gLastAttemptMs > gBackoffMs) {
+            gLastAttemptMs = now;
+            gBackoffMs = min<uint32_t>(gBackoffMs * 2, MQTT_RECONNECT_MAX_MS);
+            gMqtt.connect();
+        }
+        return;
+    }
+
+    if (gJustConnected) {
+        gJustConnected = false;
+        // Clears the retained last-will from a previous session
+        gMqtt.publish(gWillTopic, 1, true, "online");
+    }
+    drainQueue();
+}
+
+// ============================================================================
+// PRODUCTEURS
+// ============================================================================
+
+void mqttPublishWeight(int weightG, const char* uid) {
+    char buf[MQTT_PAYLOAD_MAX];
+    snprintf(buf, sizeof(buf), "{\"weight\":%d,\"uid\":\"%s\"}", weightG, uid);
+    enqueue("weight", buf, true, true);
+}
+
+void mqttPublishUid(const char* uid) {
+    enqueue("uid", uid, true, true);
+}
+
+void mqttPublishStable(int weightG, const char* uid) {
+    char buf[MQTT_PAYLOAD_MAX];
+    snprintf(buf, sizeof(buf), "{\"weight\":%d,\"uid\":\"%s\"}", weightG, uid);
+    enqueue("stable", buf, false, false);
+}
+
+void mqttPublishPushResult(bool ok, int code, int weightG, const char* uid) {
+    char buf[MQTT_PAYLOAD_MAX];
+    snprintf(buf, sizeof(buf), "{\"ok\":%s,\"code\":%d,\"weight\":%d,\"uid\":\"%s\"}",
+             ok ? "true" : "false", code, weightG, uid);
+    enqueue("push", buf, false, false);
+}
@@ -0,0 +1,140 @@
+/*
+ * @file mqtt_queue.cpp
+ * @brief TigerTagScale - Emplacements, coalescence, éviction et fenêtre QoS1
+ */
+
+#include "mqtt_queue.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void copyStr(char* dst, const char* src, size_t cap) {
+    snprintf(dst, cap, "%s", src);
+}
+
+MqttQueue::MqttQueue() : slots_(), seq_(0), stats_() {}
+
+uint32_t MqttQueue::countState(SlotState s) const {
+    uint32_t n = 0;
+    for (const Slot& slot : slots_) n += slot.state == s;
+    return n;
+}
+
+uint32_t MqttQueue::queued() const {
+    return MQTT_QUEUE_SLOTS - countState(SLOT_FREE);
+}
+
+uint32_t MqttQueue::inflight() const {
+    return countState(SLOT_INFLIGHT);
+}
+
+bool MqttQueue::enqueue(const char* topic, const char* payload, bool retain, bool coalesce) {
+    if (coalesce) {
+        // Latest-value semantics: overwrite a not-yet-sent update on the same topic
+        for (Slot& s : slots_) {
+            if (s.state == SLOT_PENDING && s.coalesce && strcmp(s.topic, topic) == 0) {
+                copyStr(s.payload, payload, MQTT_PAYLOAD_MAX);
+                stats_.coalesced++;
+                return true;
+            }
+        }
+    }
+    int target = -1;
+    for (int i = 0; i < MQTT_QUEUE_SLOTS && target < 0; ++i) {
+        if (slots_[i].state == SLOT_FREE) target = i;
+    }
+    if (target < 0) {
+        // Backpressure: evict the oldest pending state update, never an event
+        uint32_t oldest = UINT32_MAX;
+        for (int i = 0; i < MQTT_QUEUE_SLOTS; ++i) {
+            if (slots_[i].state == SLOT_PENDING && slots_[i].coalesce && slots_[i].seq < oldest) {
+                oldest = slots_[i].seq;
+                target = i;
+            }
+        }
+        stats_.dropped++;
+        if (target < 0) return false;
+    }
+    Slot& s = slots_[target];
+    s.state = SLOT_PENDING;
+    s.retain = retain;
+    s.coalesce = coalesce;
+    s.packetId = 0;
+    s.seq = ++seq_;
+    s.sentMs = 0;
+    copyStr(s.topic, topic, MQTT_TOPIC_MAX);
+    copyStr(s.payload, payload, MQTT_PAYLOAD_MAX);
+    return true;
+}
+
+bool MqttQueue::next(uint32_t nowMs, MqttOutgoing* out) {
+    int pick = -1;
+    bool dup = false;
+    // 1) PUBACK timeouts first, re-sent with the same packet id and DUP
+    for (int i = 0; i < MQTT_QUEUE_SLOTS && pick < 0; ++i) {
+        if (slots_[i].state == SLOT_INFLIGHT && nowMs - slots_[i].sentMs > MQTT_ACK_TIMEOUT_MS) {
+            pick = i;
+            dup = true;
+        }
+    }
+    // 2) Otherwise the oldest pending slot, if the window has room
+    if (pick < 0 && inflight() < MQTT_MAX_INFLIGHT) {
+        uint32_t oldest = UINT32_MAX;
+        for (int i = 0; i < MQTT_QUEUE_SLOTS; ++i) {
+            if (slots_[i].state == SLOT_PENDING && slots_[i].seq < oldest) {
+                oldest = slots_[i].seq;
+                pick = i;
+            }
+        }
+    }
+    if (pick < 0) return false;
+
+    Slot& s = slots_[pick];
+    out->slot = (int8_t)pick;
+    out->retain = s.retain;
+    out->dup = dup;
+    out->packetId = dup ? s.packetId : 0;
+    copyStr(out->topic, s.topic, MQTT_TOPIC_MAX);
+    copyStr(out->payload, s.payload, MQTT_PAYLOAD_MAX);
+    s.state = SLOT_INFLIGHT;
+    s.sentMs = nowMs;
+    return true;
+}
+
+void MqttQueue::sent(const MqttOutgoing& out, uint16_t packetId) {
+    Slot& s = slots_[out.slot];
+    if (s.state != SLOT_INFLIGHT) return;      // acked or reset meanwhile
+    if (packetId == 0) {
+        // Client refused (TCP buffer full / disconnected): retry on a later pass
+        s.state = SLOT_PENDING;
+        return;
+    }
+    s.packetId = packetId;
+    if (out.dup) stats_.retries++;
+}
+
+bool MqttQueue::acked(uint16_t packetId) {
+    for (Slot& s : slots_) {
+        if (s.state == SLOT_INFLIGHT && s.packetId == packetId) {
+            s.state = SLOT_FREE;
+            stats_.published++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MqttQueue::disconnected() {
+    // Unacked messages go back to pending: they are re-sent after reconnect
+    for (Slot& s : slots_) {
+        if (s.state == SLOT_INFLIGHT) {
+            s.state = SLOT_PENDING;
+            s.packetId = 0;
+            stats_.retries++;
+        }
+    }
+}
+
+void MqttQueue::clear() {
+    for (Slot& s : slots_) s.state = SLOT_FREE;
+}
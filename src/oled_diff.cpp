@@ -0,0 +1,44 @@
+/*
+ * @file oled_diff.cpp
+ * @brief TigerTagScale - Découpage des pages SSD1306 modifiées en fenêtres
+ */
+
+#include "oled_diff.h"
+
+#include <string.h>
+
+OledDiff::OledDiff(uint8_t width, uint8_t pages)
+    : width_(width > OLED_WIDTH_MAX ? OLED_WIDTH_MAX : width),
+      pages_(pages > OLED_PAGES_MAX ? OLED_PAGES_MAX : pages),
+      valid_(false) {
+    memset(shadow_, 0, sizeof(shadow_));
+}
+
+OledFlushResult OledDiff::flush(const uint8_t* frame, OledTransport& out) {
+    OledFlushResult r = { 0, 0 };
+    for (uint8_t p = 0; p < pages_; ++p) {
+        const uint8_t* now = frame + p * width_;
+        uint8_t* was = shadow_ + p * width_;
+
+        uint16_t c = 0;
+        while (c < width_) {
+            if (valid_ && now[c] == was[c]) { c++; continue; }
+            // Extend the window over changes closer than OLED_MERGE_GAP
+            uint16_t start = c, end = c, same = 0;
+            for (c++; c < width_ && same < OLED_MERGE_GAP; c++) {
+                if (valid_ && now[c] == was[c]) { same++; continue; }
+                end = c;
+                same = 0;
+            }
+            uint16_t n = end - start + 1;
+            out.window(p, (uint8_t)start, (uint8_t)end);
+            out.data(now + start, n);
+            memcpy(was + start, now + start, n);
+            r.windows++;
+            r.dataBytes += n;
+            c = end + 1;
+        }
+    }
+    valid_ = true;
+    return r;
+}
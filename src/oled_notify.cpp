@@ -0,0 +1,87 @@
+/*
+ * @file oled_notify.cpp
+ * @brief TigerTagScale - File de notifications OLED
+ */
+
+#include "oled_notify.h"
+
+#include <string.h>
+
+OledNotifyQueue::OledNotifyQueue() : nextSeq_(0) {
+    clear();
+}
+
+void OledNotifyQueue::clear() {
+    memset(slots_, 0, sizeof(slots_));
+}
+
+uint8_t OledNotifyQueue::size() const {
+    uint8_t n = 0;
+    for (const OledNotice& s : slots_) n += s.used ? 1 : 0;
+    return n;
+}
+
+// a goes before b: higher priority, then older
+static bool before(const OledNotice& a, const OledNotice& b) {
+    if (a.priority != b.priority) return a.priority > b.priority;
+    return (int32_t)(a.seq - b.seq) < 0;
+}
+
+bool OledNotifyQueue::push(const char* l1, const char* l2, const char* l3, uint16_t durationMs,
+                           uint8_t priority, uint8_t key) {
+    OledNotice* slot = nullptr;
+    bool replacing = false;
+    if (key) {
+        for (OledNotice& s : slots_) {
+            if (s.used && s.key == key) { slot = &s; replacing = true; break; }
+        }
+    }
+    if (!slot) {
+        for (OledNotice& s : slots_) {
+            if (!s.used) { slot = &s; break; }
+        }
+    }
+    if (!slot) {
+        // Full: the least important notice, the oldest of them, gives way if
+        // it is not more important than the new one
+        OledNotice* victim = &slots_[0];
+        for (OledNotice& s : slots_) {
+            if (s.priority < victim->priority ||
+                (s.priority == victim->priority && (int32_t)(s.seq - victim->seq) < 0)) {
+                victim = &s;
+            }
+        }
+        if (victim->priority > priority) return false;
+        slot = victim;
+    }
+
+    uint32_t seq = replacing ? slot->seq : nextSeq_++;   // a replacement keeps its place
+    memset(slot, 0, sizeof(*slot));
+    const char* lines[OLED_NOTIFY_LINES] = { l1, l2, l3 };
+    for (uint8_t i = 0; i < OLED_NOTIFY_LINES; ++i) {
+        if (lines[i]) strncpy(slot->line[i], lines[i], OLED_NOTIFY_COLS);
+    }
+    slot->durationMs = durationMs;
+    slot->priority = priority;
+    slot->key = key;
+    slot->seq = seq;
+    slot->used = true;
+    return true;
+}
+
+const OledNotice* OledNotifyQueue::current(uint32_t nowMs) {
+    OledNotice* best = nullptr;
+    for (OledNotice& s : slots_) {
+        if (!s.used) continue;
+        if (s.shown && nowMs - s.shownAtMs >= s.durationMs) {
+            s.used = false;
+            continue;
+        }
+        if (!best || before(s, *best)) best = &s;
+    }
+    if (best && !best->shown) {
+        best->shown = true;
+        best->shownAtMs = nowMs;
+    }
+    return best;
+}
@@ -0,0 +1,156 @@
+/*
+ * @file oled_panel.cpp
+ * @brief TigerTagScale - Transport I2C des fenêtres SSD1306, tâche de flush + métriques
+ */
+
+#include "oled_panel.h"
+#include "metrics.h"
+
+// Bytes per Wire transmission: the address byte is not buffered, the control
+// byte is (ESP32 Wire buffers I2C_BUFFER_LENGTH bytes)
+#if defined(I2C_BUFFER_LENGTH)
+#define OLED_WIRE_MAX   I2C_BUFFER_LENGTH
+#else
+#define OLED_WIRE_MAX   32
+#endif
+
+#define SSD1306_CTRL_CMD_STREAM    0x00
+#define SSD1306_CTRL_DATA_STREAM   0x40
+#define SSD1306_NOP                0xE3
+
+// Candidate bus clocks, fastest first; maxHz caps them
+static const uint32_t kClocks[] = { 1000000u, 800000u, OLED_I2C_SAFE_HZ };
+
+OledPanel::OledPanel(uint8_t w, uint8_t h, TwoWire* twi, int8_t rstPin)
+    : Adafruit_SSD1306(w, h, twi, rstPin),
+      diff_(w, (h + 7) / 8),
+      busBytes_(0),
+      task_(nullptr),
+      mux_(portMUX_INITIALIZER_UNLOCKED),
+      pending_(frames_[0]),
+      flushing_(frames_[1]),
+      hasPending_(false),
+      pendingUs_(0) {}
+
+bool OledPanel::clockAcked(uint32_t hz) {
+    wire->setClock(hz);
+    for (uint8_t i = 0; i < OLED_CLOCK_PROBES; ++i) {
+        wire->beginTransmission(i2caddr);
+        wire->write((uint8_t)SSD1306_CTRL_CMD_STREAM);
+        wire->write((uint8_t)SSD1306_NOP);
+        if (wire->endTransmission() != 0) return false;
+    }
+    return true;
+}
+
+bool OledPanel::beginAsync(uint32_t maxHz, BaseType_t coreId) {
+    if (!getBuffer() || task_) return false;
+
+    // 🔎 Many SSD1306 modules run fine well above the 400 kHz of the
+    //    datasheet; an ACKed NOP burst is the cheapest check that this one does
+    uint32_t hz = OLED_I2C_SAFE_HZ;
+    for (uint32_t c : kClocks) {
+        if (c <= maxHz && clockAcked(c)) { hz = c; break; }
+    }
+    wireClk = hz;
+    restoreClk = hz;              // the panel is alone on this bus
+    wire->setClock(hz);
+    invalidate();
+
+    if (xTaskCreatePinnedToCore(taskMain, "oled", OLED_TASK_STACK, this, OLED_TASK_PRIORITY,
+                                &task_, coreId) != pdPASS) {
+        task_ = nullptr;
+        Serial.println("[OLED] flush task not started, flushing inline");
+        return false;
+    }
+    Serial.printf("[OLED] async flush, I2C %lu kHz\n", (unsigned long)(hz / 1000));
+    return true;
+}
+
+bool OledPanel::display() {
+    if (!getBuffer()) return false;      // begin() failed
+    if (!task_) return flush(getBuffer());
+
+    size_t len = (size_t)WIDTH * ((HEIGHT + 7) / 8);
+    bool coalesced;
+    portENTER_CRITICAL(&mux_);
+    coalesced = hasPending_;
+    memcpy(pending_, getBuffer(), len);
+    hasPending_ = true;
+    if (!coalesced) pendingUs_ = micros();   // latency counts from the oldest frame replaced
+    portEXIT_CRITICAL(&mux_);
+
+    metricsAdd(MC_OLED_FRAMES);
+    if (coalesced) metricsAdd(MC_OLED_COALESCED);
+    xTaskNotifyGive(task_);
+    return true;
+}
+
+void OledPanel::taskMain(void* arg) {
+    OledPanel* self = static_cast<OledPanel*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        bool have;
+        uint32_t presentedUs;
+        portENTER_CRITICAL(&self->mux_);
+        have = self->hasPending_;
+        if (have) {
+            uint8_t* t = self->pending_;
+            self->pending_ = self->flushing_;
+            self->flushing_ = t;
+            self->hasPending_ = false;
+        }
+        presentedUs = self->pendingUs_;
+        portEXIT_CRITICAL(&self->mux_);
+
+        if (have && self->flush(self->flushing_)) {
+            metricsObserveOledLatencyUs(micros() - presentedUs);
+        }
+    }
+}
+
+bool OledPanel::flush(const uint8_t* frame) {
+    uint32_t t0 = micros();
+    busBytes_ = 0;
+    wire->setClock(wireClk);
+    OledFlushResult r = diff_.flush(frame, *this);
+    wire->setClock(restoreClk);
+
+    if (r.windows == 0) {
+        metricsAdd(MC_OLED_SKIPPED);
+        return false;
+    }
+    metricsAdd(MC_OLED_FLUSHES);
+    metricsAdd(MC_OLED_I2C_BYTES, busBytes_);
+    metricsObserveOledFlushUs(micros() - t0);
+    return true;
+}
+
+// One command transmission: PAGEADDR p..p, COLUMNADDR c0..c1
+void OledPanel::window(uint8_t page, uint8_t col0, uint8_t col1) {
+    uint8_t colOffset = WIDTH == 64 ? 0x20 : 0;   // 64-wide panels start at column 32
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)SSD1306_CTRL_CMD_STREAM);
+    wire->write((uint8_t)SSD1306_PAGEADDR);
+    wire->write(page);
+    wire->write(page);
+    wire->write((uint8_t)SSD1306_COLUMNADDR);
+    wire->write((uint8_t)(col0 + colOffset));
+    wire->write((uint8_t)(col1 + colOffset));
+    wire->endTransmission();
+    busBytes_ += 8;
+}
+
+void OledPanel::data(const uint8_t* bytes, uint16_t n) {
+    while (n) {
+        uint16_t chunk = n < OLED_WIRE_MAX - 1 ? n : OLED_WIRE_MAX - 1;
+        wire->beginTransmission(i2caddr);
+        wire->write((uint8_t)SSD1306_CTRL_DATA_STREAM);
+        wire->write(bytes, chunk);
+        wire->endTransmission();
+        busBytes_ += chunk + 2;
+        bytes += chunk;
+        n -= chunk;
+    }
+}
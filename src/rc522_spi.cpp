@@ -0,0 +1,132 @@
+/*
+ * @file rc522_spi.cpp
+ * @brief TigerTagScale - Transport SPI groupé pour le RC522 + auto-test d'horloge
+ */
+
+#include "rc522_spi.h"
+
+#include <SPI.h>
+
+#define RC522_FIFO_SIZE     64
+#define RC522_RATE_READS    256         // register reads timed per path
+
+// Candidate clocks, fastest first (the ESP32 derives them exactly from 80 MHz)
+static const uint32_t kClocks[] = { RC522_SPI_MAX_HZ, 8000000u, 5000000u, RC522_SPI_MIN_HZ };
+
+static uint8_t gSsPin = 0;
+static uint32_t gClockHz = RC522_SPI_MIN_HZ;
+static Rc522SpiStats gStats = {};
+
+void rc522SpiBegin(uint8_t ssPin) {
+    gSsPin = ssPin;
+    pinMode(gSsPin, OUTPUT);
+    digitalWrite(gSsPin, HIGH);
+}
+
+Rc522Burst::Rc522Burst() {
+    SPI.beginTransaction(SPISettings(gClockHz, MSBFIRST, SPI_MODE0));
+}
+
+Rc522Burst::~Rc522Burst() {
+    SPI.endTransaction();
+}
+
+// One chip-select window = one transferBytes() of the whole frame
+static void frame(const uint8_t* tx, uint8_t* rx, uint8_t len) {
+    digitalWrite(gSsPin, LOW);
+    SPI.transferBytes(tx, rx, len);
+    digitalWrite(gSsPin, HIGH);
+}
+
+void rc522Write(MFRC522::PCD_Register reg, uint8_t value) {
+    uint8_t tx[2] = { (uint8_t)reg, value };   // MSB 0 = write
+    frame(tx, nullptr, sizeof(tx));
+}
+
+void rc522Write(MFRC522::PCD_Register reg, const uint8_t* values, uint8_t count) {
+    if (count > RC522_FIFO_SIZE) count = RC522_FIFO_SIZE;
+    uint8_t tx[RC522_FIFO_SIZE + 1];
+    tx[0] = (uint8_t)reg;
+    memcpy(tx + 1, values, count);
+    frame(tx, nullptr, count + 1);
+}
+
+uint8_t rc522Read(MFRC522::PCD_Register reg) {
+    uint8_t tx[2] = { (uint8_t)(0x80 | reg), 0x00 };
+    uint8_t rx[2];
+    frame(tx, rx, sizeof(tx));
+    return rx[1];
+}
+
+// Repeating the address while clocking keeps reading the same register
+// (datasheet 8.1.2.1); the final 0x00 ends the read.
+void rc522Read(MFRC522::PCD_Register reg, uint8_t* values, uint8_t count) {
+    if (count == 0) return;
+    if (count > RC522_FIFO_SIZE) count = RC522_FIFO_SIZE;
+    uint8_t tx[RC522_FIFO_SIZE + 1];
+    uint8_t rx[RC522_FIFO_SIZE + 1];
+    memset(tx, 0x80 | reg, count);
+    tx[count] = 0x00;
+    frame(tx, rx, count + 1);
+    memcpy(values, rx + 1, count);
+}
+
+// Pattern written to the FIFO then read back; the RC522 must be idle
+static bool fifoRoundTrip(uint8_t salt) {
+    uint8_t out[RC522_FIFO_SIZE], in[RC522_FIFO_SIZE];
+    for (uint8_t i = 0; i < sizeof(out); ++i) out[i] = (uint8_t)(i * 37 + salt) ^ (i & 1 ? 0xAA : 0x55);
+
+    Rc522Burst bus;
+    rc522Write(MFRC522::FIFOLevelReg, 0x80);                // flush
+    rc522Write(MFRC522::FIFODataReg, out, sizeof(out));
+    bool ok = rc522Read(MFRC522::FIFOLevelReg) == sizeof(out);
+    rc522Read(MFRC522::FIFODataReg, in, sizeof(in));
+    rc522Write(MFRC522::FIFOLevelReg, 0x80);
+    return ok && memcmp(out, in, sizeof(out)) == 0;
+}
+
+static bool clockPasses(uint32_t hz) {
+    gClockHz = hz;
+    for (uint8_t r = 0; r < RC522_SPI_TEST_ROUNDS; ++r) {
+        if (!fifoRoundTrip(r * 29)) return false;
+    }
+    return true;
+}
+
+const Rc522SpiStats& rc522SpiSelfTest(MFRC522& lib) {
+    gStats = {};
+    gClockHz = RC522_SPI_MIN_HZ;
+    for (uint32_t hz : kClocks) {
+        if (clockPasses(hz)) { gStats.clockHz = hz; break; }
+    }
+    if (!gStats.clockHz) {
+        gClockHz = RC522_SPI_MIN_HZ;
+        Serial.println("[RFID] SPI self-test failed (RC522 not answering?)");
+        return gStats;
+    }
+
+    // Rate of one register access, the unit of the detection loop
+    uint32_t t0 = micros();
+    {
+        Rc522Burst bus;
+        for (int i = 0; i < RC522_RATE_READS; ++i) (void)rc522Read(MFRC522::VersionReg);
+    }
+    uint32_t burstUs = micros() - t0;
+    t0 = micros();
+    for (int i = 0; i < RC522_RATE_READS; ++i) (void)lib.PCD_ReadRegister(MFRC522::VersionReg);
+    uint32_t libUs = micros() - t0;
+
+    gStats.burstRegPerS = burstUs ? (uint32_t)(RC522_RATE_READS * 1000000ULL / burstUs) : 0;
+    gStats.libraryRegPerS = libUs ? (uint32_t)(RC522_RATE_READS * 1000000ULL / libUs) : 0;
+    Serial.printf("[RFID] SPI %lu MHz: %lu reg/s batched, %lu reg/s through the library (%lu MHz)\n",
+                  (unsigned long)(gStats.clockHz / 1000000u), (unsigned long)gStats.burstRegPerS,
+                  (unsigned long)gStats.libraryRegPerS, (unsigned long)(MFRC522_SPICLOCK / 1000000u));
+    if (gStats.clockHz < MFRC522_SPICLOCK) {
+        Serial.println("[RFID] warning: MFRC522_SPICLOCK is above the verified clock, lower it in platformio.ini");
+    }
+    return gStats;
+}
+
+const Rc522SpiStats& rc522SpiStats() {
+    return gStats;
+}
@@ -0,0 +1,19 @@
+/*
+ * @file rfid_presence.cpp
+ * @brief TigerTagScale - Transition présent / retiré d'un tag
+ */
+
+#include "rfid_presence.h"
+
+RfidEvent rfidPresenceUpdate(RfidPresence& p, bool seen) {
+    if (seen) {
+        p.misses = 0;
+        if (p.present) return RFID_EVT_NONE;
+        p.present = true;
+        return RFID_EVT_ARRIVED;
+    }
+    if (!p.present || ++p.misses < RFID_REMOVE_MISSES) return RFID_EVT_NONE;
+    p.present = false;
+    p.misses = 0;
+    return RFID_EVT_REMOVED;
+}
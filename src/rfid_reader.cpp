@@ -0,0 +1,298 @@
+/*
+ * @file rfid_reader.cpp
+ * @brief TigerTagScale - RC522 derrière RfidPcd : REQA non bloquant, IRQ, lectures de pages
+ */
+
+#include "rfid_reader.h"
+#include "metrics.h"
+#include "rc522_spi.h"
+#include "tag_cache.h"
+
+#include <SPI.h>
+
+// ComIrqReg bits (same positions in ComIEnReg)
+#define RC522_IRQ_TX        0x40
+#define RC522_IRQ_RX        0x20
+#define RC522_IRQ_TIMER     0x01
+#define RC522_IEN_INVERT    0x80    // IRQ pin active low (open drain, pulled up on the ESP32 side)
+#define RFID_IRQ_MAX_MISSES 3       // timer expired without the pin firing: wiring problem
+#define NTAG_CMD_FAST_READ  0x3A
+#define RC522_TIMER_DEFAULT 1000        // x 25 us = 25 ms, as set by PCD_Init()
+#define RC522_TIMER_BURST   200         // 5 ms: an ATQA/SAK starts within ~100 us
+
+// HLTA with its CRC_A (ISO 14443-3 gives 50 00 57 CD)
+static const byte kHltaFrame[4] = { 0x50, 0x00, 0x57, 0xCD };
+
+static MFRC522 gRfid;
+static int8_t gIrqPin = -1;
+static volatile bool gIrqFired = false;
+static uint8_t gIrqMisses = 0;
+static bool gReqaDirty = false;         // a library exchange may have changed the REQA settings
+
+static RfidScanner gScanner;
+
+static void IRAM_ATTR onRfidIrq() {
+    gIrqFired = true;
+}
+
+// What PICC_IsNewCardPresent() resets before every REQA; PICC_Select() and
+// PICC_HaltA() may leave other values behind, so it is done after each read.
+static void restoreReqaSettings() {
+    Rc522Burst bus;
+    rc522Write(MFRC522::TxModeReg, 0x00);
+    rc522Write(MFRC522::RxModeReg, 0x00);
+    rc522Write(MFRC522::ModWidthReg, 0x26);
+    rc522Write(MFRC522::CollReg, rc522Read(MFRC522::CollReg) & ~0x80);   // ValuesAfterColl
+    metricsAdd(MC_RFID_SPI, 5);
+    gReqaDirty = false;
+}
+
+static void restoreIfDirty() {
+    if (gReqaDirty) restoreReqaSettings();
+}
+
+// Same register sequence as PCD_CommunicateWithPICC(), minus the busy wait.
+// REQA only reaches IDLE tags; WUPA also wakes a HALTed one.
+static void armRequest(byte cmd) {
+    Rc522Burst bus;
+    rc522Write(MFRC522::CommandReg, MFRC522::PCD_Idle);
+    rc522Write(MFRC522::ComIrqReg, 0x7F);       // clear every IRQ bit
+    gIrqFired = false;
+    rc522Write(MFRC522::FIFOLevelReg, 0x80);    // flush FIFO
+    rc522Write(MFRC522::FIFODataReg, cmd);
+    rc522Write(MFRC522::CommandReg, MFRC522::PCD_Transceive);
+    rc522Write(MFRC522::BitFramingReg, 0x87);   // StartSend, 7-bit short frame
+    metricsAdd(MC_RFID_SPI, 6);
+    metricsAdd(MC_RFID_POLLS);
+}
+
+// PICC_HaltA() waits for the 25 ms timeout that means "accepted": send the
+// frame with Transmit (no receive phase) and return. The next REQA/WUPA goes
+// out at least one loop() later, long after the 4 bytes have left.
+static void sendHalt() {     // caller holds the bus
+    rc522Write(MFRC522::CommandReg, MFRC522::PCD_Idle);
+    rc522Write(MFRC522::ComIrqReg, 0x7F);
+    rc522Write(MFRC522::FIFOLevelReg, 0x80);
+    rc522Write(MFRC522::FIFODataReg, kHltaFrame, sizeof(kHltaFrame));
+    rc522Write(MFRC522::BitFramingReg, 0x00);
+    rc522Write(MFRC522::CommandReg, MFRC522::PCD_Transmit);
+    metricsAdd(MC_RFID_SPI, 6);
+}
+
+// Inside an inventory burst the next command follows at once: let the HLTA
+// leave first (4 bytes at 106 kbit/s, ~0.4 ms), otherwise Idle would cut it
+static void waitHaltSent() {     // caller holds the bus
+    uint32_t t0 = micros();
+    while (!(rc522Read(MFRC522::ComIrqReg) & RC522_IRQ_TX) && micros() - t0 < 2000) {
+        metricsAdd(MC_RFID_SPI);
+    }
+}
+
+// Shorter "nobody answered" timeout while many frames are exchanged in a row
+static void setTimeout(uint16_t reload) {
+    Rc522Burst bus;
+    rc522Write(MFRC522::TReloadRegH, reload >> 8);
+    rc522Write(MFRC522::TReloadRegL, reload & 0xFF);
+    metricsAdd(MC_RFID_SPI, 2);
+}
+
+// What PICC_Select() needs to address a known tag
+static MFRC522::Uid toPicc(const TagUid& uid, uint8_t sak) {
+    MFRC522::Uid u = {};
+    u.size = uid.len;
+    memcpy(u.uidByte, uid.bytes, uid.len);
+    u.sak = sak;
+    return u;
+}
+
+// READ (0x30) returns 4 pages per command: pages 4..13 take three of them
+static bool readPages(uint8_t* out) {
+    for (int done = 0; done < TIGERTAG_BYTES; done += 16) {
+        byte buf[18];     // 16 data bytes + CRC_A
+        byte size = sizeof(buf);
+        if (gRfid.MIFARE_Read(TIGERTAG_FIRST_PAGE + done / 4, buf, &size) != MFRC522::STATUS_OK) {
+            return false;
+        }
+        memcpy(out + done, buf, min(16, TIGERTAG_BYTES - done));
+    }
+    return true;
+}
+
+// NTAG21x FAST_READ: the whole range in one frame (40 bytes + CRC_A fit the
+// 64-byte FIFO), instead of one round-trip per 16 bytes
+static bool fastReadPages(uint8_t* out) {
+    byte cmd[5] = { NTAG_CMD_FAST_READ, TIGERTAG_FIRST_PAGE, TIGERTAG_FIRST_PAGE + TIGERTAG_PAGES - 1 };
+    if (gRfid.PCD_CalculateCRC(cmd, 3, &cmd[3]) != MFRC522::STATUS_OK) return false;
+    byte buf[TIGERTAG_BYTES + 2];
+    byte len = sizeof(buf);
+    if (gRfid.PCD_TransceiveData(cmd, sizeof(cmd), buf, &len, nullptr, 0, true) != MFRC522::STATUS_OK ||
+        len != sizeof(buf)) {
+        return false;
+    }
+    memcpy(out, buf, TIGERTAG_BYTES);
+    return true;
+}
+
+// A NAK (Ultralight without FAST_READ) sends the tag back to IDLE: wake it
+// and select it again by its full UID (WUPA also wakes the other halted tags;
+// a known-UID SELECT leaves them out, and they return to HALT afterwards)
+static bool reselect(const RfidTag& tag) {
+    byte atqa[2];
+    byte size = sizeof(atqa);
+    MFRC522::StatusCode st = gRfid.PICC_WakeupA(atqa, &size);
+    if (st != MFRC522::STATUS_OK && st != MFRC522::STATUS_COLLISION) return false;
+    MFRC522::Uid u = toPicc(tag.uid, tag.sak);
+    return gRfid.PICC_Select(&u, u.size * 8) == MFRC522::STATUS_OK;
+}
+
+// The RC522 side of RfidScanner. Library exchanges (SELECT, READ, REQA)
+// mark the REQA settings dirty; they are restored once, before the next
+// frame that relies on them.
+class Rc522Pcd : public RfidPcd {
+public:
+    void request(bool wakeup) override {
+        restoreIfDirty();
+        armRequest(wakeup ? MFRC522::PICC_CMD_WUPA : MFRC522::PICC_CMD_REQA);
+    }
+
+    RfidAnswer answer(uint32_t elapsedMs) override {
+        if (gIrqPin >= 0) {
+            if (!gIrqFired && elapsedMs < RFID_REQA_TIMEOUT_MS) return RFID_ANSWER_PENDING;
+        } else if (elapsedMs < RFID_REQA_SETTLE_MS) {
+            return RFID_ANSWER_PENDING;
+        }
+
+        byte irq;
+        {
+            Rc522Burst bus;
+            irq = rc522Read(MFRC522::ComIrqReg);
+        }
+        metricsAdd(MC_RFID_SPI);
+
+        if (gIrqPin >= 0 && !gIrqFired && (irq & (RC522_IRQ_RX | RC522_IRQ_TIMER))) {
+            // 🔎 The RC522 raised the flag but the pin stayed high: not wired (or
+            //    wrong GPIO). Keep scanning by reading the register instead.
+            if (++gIrqMisses >= RFID_IRQ_MAX_MISSES) {
+                detachInterrupt(digitalPinToInterrupt(gIrqPin));
+                Serial.printf("[RFID] no edge on GPIO %d, falling back to polling mode\n", gIrqPin);
+                gIrqPin = -1;
+            }
+        } else if (gIrqFired) {
+            gIrqMisses = 0;
+        }
+        // No RxIRq: nobody answered (TimerIRq, or the answer is still pending
+        // in polling mode, which only happens for a marginal coupling)
+        return (irq & RC522_IRQ_RX) ? RFID_ANSWER_ATQA : RFID_ANSWER_NONE;
+    }
+
+    void burst(bool on) override {
+        setTimeout(on ? RC522_TIMER_BURST : RC522_TIMER_DEFAULT);
+        if (!on) restoreIfDirty();
+    }
+
+    bool selectAny(TagUid* uid, uint8_t* sak) override {
+        gReqaDirty = true;
+        if (!gRfid.PICC_ReadCardSerial()) return false;
+        *uid = TagUid(gRfid.uid.uidByte, gRfid.uid.size);
+        *sak = gRfid.uid.sak;
+        return true;
+    }
+
+    bool select(const TagUid& uid, uint8_t sak) override {
+        gReqaDirty = true;
+        MFRC522::Uid u = toPicc(uid, sak);
+        return gRfid.PICC_Select(&u, u.size * 8) == MFRC522::STATUS_OK;
+    }
+
+    bool requestAgain() override {
+        gReqaDirty = true;
+        byte atqa[2];
+        byte size = sizeof(atqa);
+        MFRC522::StatusCode st = gRfid.PICC_RequestA(atqa, &size);
+        return st == MFRC522::STATUS_OK || st == MFRC522::STATUS_COLLISION;
+    }
+
+    bool readUser(RfidTag* tag) override {
+        if (MFRC522::PICC_GetType(tag->sak) != MFRC522::PICC_TYPE_MIFARE_UL) return false;
+
+        uint32_t t0 = micros();
+        if (tagCacheLookup(tag->uid, tag->user)) {
+            tag->source = TAG_READ_CACHE;
+        } else if (fastReadPages(tag->user)) {
+            tag->source = TAG_READ_FAST;
+        } else if (reselect(*tag) && readPages(tag->user)) {
+            tag->source = TAG_READ_PAGES;
+        } else {
+            return false;
+        }
+        metricsObserveTagReadUs((TagReadPath)tag->source, micros() - t0);
+
+        // Blank tags are not cached: they may be programmed later
+        TigerTagInfo probe;
+        if (tag->source != TAG_READ_CACHE && tigertagDecode(tag->user, sizeof(tag->user), &probe)) {
+            tagCacheStore(tag->uid, tag->user);
+        }
+        return true;
+    }
+
+    void halt(bool wait) override {
+        restoreIfDirty();
+        Rc522Burst bus;
+        sendHalt();
+        if (wait) waitHaltSent();
+    }
+};
+
+static Rc522Pcd gPcd;
+
+uint8_t rfidTagCount() {
+    return gScanner.tagCount();
+}
+
+const RfidTag* rfidTagAt(uint8_t i) {
+    return gScanner.tagAt(i);
+}
+
+void rfidBegin(uint8_t ssPin, uint8_t rstPin, int8_t irqPin) {
+    SPI.begin();
+    gRfid.PCD_Init(ssPin, rstPin);
+    rc522SpiBegin(ssPin);
+    rc522SpiSelfTest(gRfid);
+    restoreReqaSettings();
+
+    gIrqPin = irqPin;
+    if (gIrqPin >= 0) {
+        Rc522Burst bus;
+        rc522Write(MFRC522::ComIEnReg, RC522_IEN_INVERT | RC522_IRQ_RX | RC522_IRQ_TIMER);
+        pinMode(gIrqPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(gIrqPin), onRfidIrq, FALLING);
+    }
+    gScanner.begin(millis());
+    Serial.printf("[RFID] %s, REQA every %u ms (%u ms after a weight change)\n",
+                  gIrqPin >= 0 ? "IRQ mode" : "polling mode", RFID_POLL_IDLE_MS, RFID_POLL_FAST_MS);
+}
+
+bool rfidIrqMode() {
+    return gIrqPin >= 0;
+}
+
+uint32_t rfidPollIntervalMs() {
+    return gScanner.pollIntervalMs(millis());
+}
+
+void rfidNoteWeight(float grams, uint32_t nowMs) {
+    gScanner.noteWeight(grams, nowMs);
+}
+
+RfidEvent rfidPoll(uint32_t nowMs, RfidTag* tag) {
+    uint32_t t0 = micros();
+    RfidEvent ev = gScanner.poll(nowMs, gPcd, tag);
+
+    const RfidInventoryResult& inv = gScanner.lastInventory();
+    if (inv.setFull) metricsAdd(MC_RFID_SET_FULL);
+    if (inv.found > 1) {
+        Serial.printf("[RFID] inventory: %u new tags in %lu us\n", inv.found, (unsigned long)(micros() - t0));
+    }
+    if (ev == RFID_EVT_REMOVED) metricsAdd(MC_RFID_REMOVALS);
+    return ev;
+}
@@ -0,0 +1,153 @@
+/*
+ * @file rfid_scanner.cpp
+ * @brief TigerTagScale - Inventaire ISO 14443-3 et sondes de présence, hors matériel
+ */
+
+#include "rfid_scanner.h"
+
+#include <math.h>
+#include <string.h>
+
+RfidScanner::RfidScanner()
+    : armed_(false), armedWakeup_(false), armedMs_(0), nextPollMs_(0),
+      tags_(), presence_(), tagCount_(0), probeIdx_(0), nextProbeMs_(0),
+      pending_(), pendingCount_(0), last_(),
+      fastActive_(false), fastUntilMs_(0), refInit_(false), refWeight_(0.0f) {}
+
+void RfidScanner::begin(uint32_t nowMs) {
+    armed_ = false;
+    nextPollMs_ = nowMs;
+}
+
+uint32_t RfidScanner::pollIntervalMs(uint32_t nowMs) {
+    if (fastActive_ && (int32_t)(nowMs - fastUntilMs_) >= 0) fastActive_ = false;
+    return fastActive_ ? RFID_POLL_FAST_MS : RFID_POLL_IDLE_MS;
+}
+
+void RfidScanner::noteWeight(float grams, uint32_t nowMs) {
+    if (!refInit_) { refWeight_ = grams; refInit_ = true; return; }
+    if (fabsf(grams - refWeight_) < RFID_WAKE_DELTA_G) return;
+
+    refWeight_ = grams;
+    fastActive_ = true;
+    fastUntilMs_ = nowMs + RFID_FAST_WINDOW_MS;
+    // Pull the next REQA forward instead of waiting out the idle period
+    if (!armed_ && (int32_t)(nextPollMs_ - (nowMs + RFID_POLL_FAST_MS)) > 0) {
+        nextPollMs_ = nowMs + RFID_POLL_FAST_MS;
+    }
+}
+
+int RfidScanner::findTag(const TagUid& uid) const {
+    for (uint8_t i = 0; i < tagCount_; ++i) {
+        if (tags_[i].uid == uid) return i;
+    }
+    return -1;
+}
+
+// Swap-remove; the pending list never points past a removal (it is drained
+// before the next probe runs)
+void RfidScanner::removeTag(uint8_t i) {
+    tagCount_--;
+    if (i != tagCount_) {
+        tags_[i] = tags_[tagCount_];
+        presence_[i] = presence_[tagCount_];
+    }
+    if (probeIdx_ >= tagCount_) probeIdx_ = 0;
+}
+
+// 🔎 ISO 14443-3 inventory: an ATQA came back, so at least one IDLE tag is
+//    in READY. Select one (anticollision resolves collisions bit by bit),
+//    read it, HLTA it, and send REQA again: halted tags stay silent, so each
+//    round yields the next one until nobody answers. Tags already in the set
+//    are halted too and never answer REQA, so only newcomers are enumerated.
+void RfidScanner::inventory(uint32_t nowMs, RfidPcd& pcd) {
+    pcd.burst(true);
+    TagUid seen;
+    uint8_t sak;
+    while (pcd.selectAny(&seen, &sak)) {
+        int i = findTag(seen);
+        if (i >= 0) {
+            rfidPresenceUpdate(presence_[i], true);     // known tag that lost power
+        } else if (tagCount_ < RFID_MAX_TAGS) {
+            i = tagCount_++;
+            RfidTag& t = tags_[i];
+            t.uid = seen;
+            t.sak = sak;
+            t.hasUser = pcd.readUser(&t);
+            presence_[i] = {};
+            rfidPresenceUpdate(presence_[i], true);
+            pending_[pendingCount_++] = i;
+            last_.found++;
+        } else {
+            // Set full: the tag is left out and answers again next REQA
+            last_.setFull = true;
+            break;
+        }
+        pcd.halt(true);
+        if (!pcd.requestAgain()) break;
+    }
+    pcd.burst(false);
+    if (last_.found) nextProbeMs_ = nowMs + RFID_PRESENCE_MS;
+}
+
+// 🔎 Presence probe of one tag of the set: WUPA woke every halted tag, a
+//    SELECT carrying this tag's full UID makes only it answer. The others
+//    go back to HALT with the HLTA (or the next REQA).
+bool RfidScanner::probeTag(uint8_t i, RfidPcd& pcd) {
+    pcd.burst(true);
+    bool seen = pcd.select(tags_[i].uid, tags_[i].sak);
+    if (seen) pcd.halt(false);
+    pcd.burst(false);
+    return seen;
+}
+
+RfidEvent RfidScanner::popPending(RfidTag* tag) {
+    uint8_t i = pending_[0];
+    pendingCount_--;
+    memmove(pending_, pending_ + 1, pendingCount_);
+    *tag = tags_[i];
+    return RFID_EVT_ARRIVED;
+}
+
+RfidEvent RfidScanner::poll(uint32_t nowMs, RfidPcd& pcd, RfidTag* tag) {
+    last_ = {};
+    if (pendingCount_) return popPending(tag);
+
+    if (!armed_) {
+        if ((int32_t)(nowMs - nextPollMs_) < 0) return RFID_EVT_NONE;
+        // Alternate with REQA so tags added next to the present ones are seen
+        bool probe = tagCount_ > 0 && !armedWakeup_ && (int32_t)(nowMs - nextProbeMs_) >= 0;
+        pcd.request(probe);
+        armedWakeup_ = probe;
+        armedMs_ = nowMs;
+        armed_ = true;
+        return RFID_EVT_NONE;
+    }
+
+    RfidAnswer a = pcd.answer(nowMs - armedMs_);
+    if (a == RFID_ANSWER_PENDING) return RFID_EVT_NONE;
+    armed_ = false;
+    nextPollMs_ = nowMs + pollIntervalMs(nowMs);
+
+    bool answered = a == RFID_ANSWER_ATQA;
+    if (armedWakeup_) {
+        // One tag per probe slot: with N tags each is checked every
+        // N x RFID_PRESENCE_MS (x2 with the interleaved REQA slots)
+        uint8_t i = probeIdx_;
+        probeIdx_ = (probeIdx_ + 1) % tagCount_;
+        nextProbeMs_ = nowMs + RFID_PRESENCE_MS;
+        bool seen = answered && probeTag(i, pcd);
+        if (rfidPresenceUpdate(presence_[i], seen) != RFID_EVT_REMOVED) return RFID_EVT_NONE;
+        *tag = tags_[i];
+        removeTag(i);
+        return RFID_EVT_REMOVED;
+    }
+
+    // Nobody answered the REQA
+    if (!answered) return RFID_EVT_NONE;
+
+    // An ATQA (possibly collided) came back: enumerate the newcomers. This
+    // blocks a few ms per tag, but only when tags actually arrive.
+    inventory(nowMs, pcd);
+    return pendingCount_ ? popPending(tag) : RFID_EVT_NONE;
+}
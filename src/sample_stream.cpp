@@ -0,0 +1,156 @@
+/*
+ * @file sample_stream.cpp
+ * @brief TigerTagScale - Trames binaires par lots pour /ws/stream
+ *
+ * Tout se passe dans la tâche loop() : readWeight() empile, la trame est
+ * envoyée dès que le lot est plein (ou trop vieux). Si la file d'un client est
+ * saturée, le lot est abandonné plutôt que d'accumuler de la RAM ; le drapeau
+ * GAP et le trou de séquence le signalent au navigateur.
+ */
+
+#include "sample_stream.h"
+#include "metrics.h"
+
+#include <ESPAsyncWebServer.h>
+
+struct __attribute__((packed)) StreamHeader {
+    uint8_t  version;
+    uint8_t  count;
+    uint16_t sampleSize;
+    uint32_t firstSeq;
+};
+
+struct __attribute__((packed)) StreamSample {
+    uint32_t tUs;
+    int32_t  raw;
+    float    filtered;
+    uint8_t  flags;
+    uint8_t  pad[3];
+};
+
+static_assert(sizeof(StreamHeader) == 8, "stream header must stay 8 bytes");
+static_assert(sizeof(StreamSample) == 16, "stream sample must stay 16 bytes");
+
+#define STREAM_FRAME_MAX (sizeof(StreamHeader) + STREAM_BATCH_SAMPLES * sizeof(StreamSample))
+
+static AsyncWebSocket gStream("/ws/stream");
+
+// Frame under construction (header is filled at flush time)
+static uint8_t  gFrame[STREAM_FRAME_MAX];
+static uint8_t  gCount = 0;
+static uint32_t gSeq = 0;            // sequence number of the next sample
+static uint32_t gBatchStartMs = 0;
+static bool     gGapPending = false;
+static volatile bool gTarePending = false;
+
+static StreamStats gStats = {};
+
+// Per-second accounting
+static uint32_t gWindowStartMs = 0;
+static uint32_t gWindowFrames = 0;
+static uint32_t gWindowSamples = 0;
+static uint32_t gWindowBusyUs = 0;
+
+static void onStreamEvent(AsyncWebSocket *server, AsyncWebSocketClient *client,
+                          AwsEventType type, void *arg, uint8_t *data, size_t len) {
+    if (type != WS_EVT_CONNECT) return;
+    // Each subscriber costs a send queue at full rate: keep it small
+    if (server->count() > STREAM_MAX_CLIENTS) {
+        client->close(1013, "stream busy");
+        return;
+    }
+    Serial.printf("[STREAM] client #%u connected\n", client->id());
+}
+
+static void flushFrame() {
+    if (gCount == 0) return;
+    uint32_t t0 = micros();
+
+    StreamHeader h;
+    h.version = STREAM_PROTO_VERSION;
+    h.count = gCount;
+    h.sampleSize = sizeof(StreamSample);
+    h.firstSeq = gSeq - gCount;
+    memcpy(gFrame, &h, sizeof(h));
+    size_t len = sizeof(StreamHeader) + gCount * sizeof(StreamSample);
+
+    // 🔎 Backpressure: binaryAll() would queue one more message on every
+    //    client; a slow one would pile up 32 frames before the library drops
+    //    them. Drop the batch here instead and flag the hole.
+    if (gStream.availableForWriteAll()) {
+        gStream.binaryAll(gFrame, len);
+        metricsAdd(MC_WS_STREAM_BYTES, len * gStream.count());
+        gStats.frames++;
+        gStats.samples += gCount;
+        gWindowFrames++;
+        gWindowSamples += gCount;
+    } else {
+        gStats.dropped += gCount;
+        metricsAdd(MC_STREAM_DROPPED, gCount);
+        gGapPending = true;
+    }
+    gCount = 0;
+
+    uint32_t dt = micros() - t0;
+    gWindowBusyUs += dt;
+    if (dt > gStats.maxFlushUs) gStats.maxFlushUs = dt;
+}
+
+void sampleStreamSetup(AsyncWebServer& server) {
+    gStream.onEvent(onStreamEvent);
+    server.addHandler(&gStream);
+}
+
+void sampleStreamMarkTare() {
+    gTarePending = true;
+}
+
+void sampleStreamPush(int32_t rawCounts, float filteredG, uint8_t flags) {
+    if (gStream.count() == 0) {
+        // Nobody listening: keep the sequence running so reconnects see time pass
+        gSeq++;
+        gCount = 0;
+        gTarePending = false;
+        return;
+    }
+    uint32_t t0 = micros();
+
+    if (gTarePending) { flags |= STREAM_FLAG_TARE; gTarePending = false; }
+    if (gGapPending)  { flags |= STREAM_FLAG_GAP;  gGapPending = false; }
+
+    StreamSample s;
+    s.tUs = t0;
+    s.raw = rawCounts;
+    s.filtered = filteredG;
+    s.flags = flags;
+    s.pad[0] = s.pad[1] = s.pad[2] = 0;
+    memcpy(gFrame + sizeof(StreamHeader) + gCount * sizeof(StreamSample), &s, sizeof(s));
+
+    if (gCount == 0) gBatchStartMs = millis();
+    gCount++;
+    gSeq++;
+    gWindowBusyUs += micros() - t0;
+
+    if (gCount >= STREAM_BATCH_SAMPLES) flushFrame();
+}
+
+void sampleStreamLoop() {
+    uint32_t now = millis();
+    if (gCount && now - gBatchStartMs >= STREAM_MAX_BATCH_MS) flushFrame();
+
+    if (now - gWindowStartMs >= 1000) {
+        float secs = (now - gWindowStartMs) / 1000.0f;
+        gStats.framesPerSec = gWindowFrames / secs;
+        gStats.samplesPerSec = gWindowSamples / secs;
+        gStats.busyUsPerSec = (uint32_t)(gWindowBusyUs / secs);
+        gWindowFrames = gWindowSamples = gWindowBusyUs = 0;
+        gWindowStartMs = now;
+        gStream.cleanupClients(STREAM_MAX_CLIENTS);
+    }
+}
+
+StreamStats sampleStreamStats() {
+    StreamStats s = gStats;
+    s.clients = gStream.count();
+    return s;
+}
@@ -0,0 +1,205 @@
+/*
+ * @file status_json.cpp
+ * @brief TigerTagScale - Sérialisation de /api/status dans un tampon fixe
+ */
+
+#include "status_json.h"
+
+#include <string.h>
+
+static const char* const kFieldNames[] = {
+    "weight", "rawWeight", "smoothWeight", "hold", "holdWeight", "uid", "uid_hex",
+    "wifi", "ip", "mdns", "cloud", "apiKey", "apiValid", "displayName",
+    "calibrationFactor", "uptime_ms", "uptime_s", "sendToCloud", "spool", "tags"
+};
+static const size_t kFieldCount = sizeof(kFieldNames) / sizeof(kFieldNames[0]);
+
+uint32_t statusParseFields(const char* list) {
+    if (!list || !*list) return SF_ALL;
+    uint32_t mask = 0;
+    const char* p = list;
+    while (*p) {
+        const char* end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        for (size_t i = 0; i < kFieldCount; ++i) {
+            if (strlen(kFieldNames[i]) == n && strncmp(kFieldNames[i], p, n) == 0) {
+                mask |= 1u << i;
+                break;
+            }
+        }
+        if (!end) break;
+        p = end + 1;
+    }
+    return mask;
+}
+
+uint32_t statusDiff(const StatusSnapshot& a, const StatusSnapshot& b) {
+    uint32_t m = 0;
+    if (a.weight != b.weight)                         m |= SF_WEIGHT;
+    if (a.rawWeight != b.rawWeight)                   m |= SF_RAW_WEIGHT;
+    if (a.smoothWeight != b.smoothWeight)             m |= SF_SMOOTH_WEIGHT;
+    if (a.hold != b.hold)                             m |= SF_HOLD;
+    if (a.holdWeight != b.holdWeight)                 m |= SF_HOLD_WEIGHT;
+    if (strcmp(a.uid, b.uid))                         m |= SF_UID;
+    if (strcmp(a.uidHex, b.uidHex))                   m |= SF_UID_HEX;
+    if (strcmp(a.wifi, b.wifi))                       m |= SF_WIFI;
+    if (strcmp(a.ip, b.ip))                           m |= SF_IP;
+    if (strcmp(a.mdns, b.mdns))                       m |= SF_MDNS;
+    if (a.cloudOK != b.cloudOK)                       m |= SF_CLOUD;
+    if (strcmp(a.apiKey, b.apiKey))                   m |= SF_API_KEY;
+    if (a.apiValid != b.apiValid)                     m |= SF_API_VALID;
+    if (strcmp(a.displayName, b.displayName))         m |= SF_DISPLAY_NAME;
+    if (a.calibrationFactor != b.calibrationFactor)   m |= SF_CALIBRATION;
+    if (a.uptimeMs != b.uptimeMs)                     m |= SF_UPTIME_MS;
+    if (a.uptimeMs / 1000 != b.uptimeMs / 1000)       m |= SF_UPTIME_S;
+    if (strcmp(a.sendToCloud, b.sendToCloud))         m |= SF_SEND_TO_CLOUD;
+    if (a.spoolValid != b.spoolValid || a.materialId != b.materialId || a.nominalG != b.nominalG ||
+        a.tareG != b.tareG || a.hasNet != b.hasNet || a.netG != b.netG)
+                                                      m |= SF_SPOOL;
+    if (a.tagCount != b.tagCount)                     m |= SF_TAGS;
+    return m;
+}
+
+// Bounded writer: every append checks the remaining room and latches overflow.
+struct JsonWriter {
+    char*  p;
+    char*  end;
+    bool   overflow;
+    bool   first;
+
+    void raw(const char* s, size_t n) {
+        if (overflow || (size_t)(end - p) <= n) { overflow = true; return; }
+        memcpy(p, s, n);
+        p += n;
+    }
+    void raw(const char* s) { raw(s, strlen(s)); }
+    void ch(char c) { raw(&c, 1); }
+
+    void key(const char* k) {
+        if (!first) ch(',');
+        first = false;
+        ch('"'); raw(k); raw("\":", 2);
+    }
+
+    void str(const char* s) {
+        ch('"');
+        for (; *s; ++s) {
+            unsigned char c = (unsigned char)*s;
+            if (c == '"' || c == '\\') { ch('\\'); ch((char)c); }
+            else if (c < 0x20) {
+                static const char hex[] = "0123456789abcdef";
+                char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                raw(esc, 6);
+            }
+            else ch((char)c);
+        }
+        ch('"');
+    }
+
+    void u64(uint64_t v) {
+        char tmp[21];
+        int i = 20;
+        tmp[i] = '\0';
+        do { tmp[--i] = (char)('0' + v % 10); v /= 10; } while (v && i > 0);
+        raw(&tmp[i], 20 - i);
+    }
+
+    void i32(int32_t v) {
+        if (v < 0) { ch('-'); u64((uint64_t)(-(int64_t)v)); }
+        else u64((uint64_t)v);
+    }
+
+    // Fixed-point formatting (avoids newlib's dtoa, which allocates)
+    void fixed(float f, int decimals) {
+        static const uint32_t kPow10[] = { 1, 10, 100, 1000, 10000 };
+        // NaN/inf are not valid JSON, and beyond 1e15 the scaled value would
+        // not fit in uint64_t (converting it is undefined behaviour)
+        if (!(f > -1e15f && f < 1e15f)) { raw("null"); return; }
+        uint32_t scale = kPow10[decimals];
+        double v = (double)f;
+        bool neg = v < 0;
+        if (neg) v = -v;
+        uint64_t scaled = (uint64_t)(v * scale + 0.5);
+        if (neg && scaled) ch('-');
+        u64(scaled / scale);
+        if (decimals) {
+            ch('.');
+            uint32_t frac = (uint32_t)(scaled % scale);
+            for (int d = decimals - 1; d >= 0; --d) {
+                ch((char)('0' + (frac / kPow10[d]) % 10));
+            }
+        }
+    }
+
+    void boolean(bool b) { raw(b ? "true" : "false"); }
+};
+
+size_t statusSerialize(const StatusSnapshot& s, uint32_t fields, char* out, size_t cap) {
+    if (!out || cap == 0) return 0;
+    JsonWriter w = { out, out + cap, false, true };
+
+    w.ch('{');
+    if (fields & SF_WEIGHT)        { w.key("weight");            w.i32(s.weight); }
+    if (fields & SF_RAW_WEIGHT)    { w.key("rawWeight");         w.fixed(s.rawWeight, 2); }
+    if (fields & SF_SMOOTH_WEIGHT) { w.key("smoothWeight");      w.i32(s.smoothWeight); }
+    if (fields & SF_HOLD)          { w.key("hold");              w.boolean(s.hold); }
+    if (fields & SF_HOLD_WEIGHT)   { w.key("holdWeight");        w.i32(s.holdWeight); }
+    if (fields & SF_UID)           { w.key("uid");               w.str(s.uid); }
+    if (fields & SF_UID_HEX)       { w.key("uid_hex");           w.str(s.uidHex); }
+    if (fields & SF_WIFI)          { w.key("wifi");              w.str(s.wifi); }
+    if (fields & SF_IP)            { w.key("ip");                w.str(s.ip); }
+    if (fields & SF_MDNS)          { w.key("mdns");              w.str(s.mdns); }
+    if (fields & SF_CLOUD)         { w.key("cloud");             w.str(s.cloudOK ? "ok" : "down"); }
+    if (fields & SF_API_KEY)       { w.key("apiKey");            w.str(s.apiKey); }
+    if (fields & SF_API_VALID)     { w.key("apiValid");          w.boolean(s.apiValid); }
+    if (fields & SF_DISPLAY_NAME)  { w.key("displayName");       w.str(s.displayName); }
+    if (fields & SF_CALIBRATION)   { w.key("calibrationFactor"); w.fixed(s.calibrationFactor, 4); }
+    if (fields & SF_UPTIME_MS)     { w.key("uptime_ms");         w.u64(s.uptimeMs); }
+    if (fields & SF_UPTIME_S)      { w.key("uptime_s");          w.u64(s.uptimeMs / 1000); }
+    if (fields & SF_SEND_TO_CLOUD) { w.key("sendToCloud");       w.str(s.sendToCloud); }
+    if (fields & SF_SPOOL) {
+        w.key("spool");
+        if (!s.spoolValid) w.raw("null");
+        else {
+            w.raw("{\"material\":");  w.u64(s.materialId);
+            w.raw(",\"nominal\":");   w.u64(s.nominalG);
+            w.raw(",\"tare\":");      if (s.tareG) w.u64(s.tareG); else w.raw("null");
+            w.raw(",\"net\":");       if (s.hasNet) w.i32(s.netG); else w.raw("null");
+            w.ch('}');
+        }
+    }
+    if (fields & SF_TAGS)          { w.key("tags");              w.u64(s.tagCount); }
+    w.ch('}');
+
+    if (w.overflow || w.p >= w.end) { out[0] = '\0'; return 0; }
+    *w.p = '\0';
+    return (size_t)(w.p - out);
+}
+
+size_t tagsSerialize(const TagSnap* tags, uint8_t n, bool apportioned, char* out, size_t cap) {
+    if (!out || cap == 0) return 0;
+    JsonWriter w = { out, out + cap, false, true };
+
+    w.raw("{\"count\":");        w.u64(n);
+    w.raw(",\"apportioned\":");  w.boolean(apportioned);
+    w.raw(",\"tags\":[");
+    for (uint8_t i = 0; i < n && !w.overflow; ++i) {
+        const TagSnap& t = tags[i];
+        if (i) w.ch(',');
+        w.raw("{\"uid\":");      w.str(TagUidDec(t.uid).str);
+        if (!t.info.valid) {
+            w.raw(",\"material\":null,\"tare\":null,\"net\":null}");
+            continue;
+        }
+        w.raw(",\"material\":"); w.u64(t.info.materialId);
+        w.raw(",\"nominal\":");  w.u64(t.info.nominalG);
+        w.raw(",\"tare\":");     if (t.info.tareG) w.u64(t.info.tareG); else w.raw("null");
+        w.raw(",\"net\":");      if (apportioned) w.i32(t.netG); else w.raw("null");
+        w.ch('}');
+    }
+    w.raw("]}");
+
+    if (w.overflow || w.p >= w.end) { out[0] = '\0'; return 0; }
+    *w.p = '\0';
+    return w.p - out;
+}
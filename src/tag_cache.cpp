@@ -0,0 +1,113 @@
+/*
+ * @file tag_cache.cpp
+ * @brief TigerTagScale - Cache UID → pages TigerTag, persisté dans LittleFS
+ */
+
+#include "tag_cache.h"
+#include "tigertag.h"
+
+#define TAG_CACHE_MAGIC     0x31435454u   // "TTC1"
+
+struct TagCacheEntry {
+    TagUid   uid;                         // empty = free slot (same layout as len + 10 bytes)
+    uint8_t  pad;
+    uint32_t hash;                        // FNV-1a of user
+    uint32_t lastUsed;                    // LRU tick
+    uint8_t  user[TIGERTAG_BYTES];
+};
+
+struct TagCacheHeader {
+    uint32_t magic;
+    uint16_t entrySize;                   // layout check (TIGERTAG_BYTES may grow)
+    uint16_t count;
+};
+
+static TagCacheEntry gEntries[TAG_CACHE_ENTRIES];
+static fs::FS* gFs = nullptr;
+static uint32_t gTick = 0;
+
+static uint32_t fnv1a(const uint8_t* p, size_t n) {
+    uint32_t h = 2166136261u;
+    while (n--) { h ^= *p++; h *= 16777619u; }
+    return h;
+}
+
+static TagCacheEntry* find(const TagUid& uid) {
+    for (TagCacheEntry& e : gEntries) {
+        if (!e.uid.empty() && e.uid == uid) return &e;
+    }
+    return nullptr;
+}
+
+static void save() {
+    if (!gFs) return;
+    File f = gFs->open(TAG_CACHE_PATH, "w");
+    if (!f) { Serial.println("[TAGCACHE] write failed"); return; }
+    TagCacheHeader h = { TAG_CACHE_MAGIC, sizeof(TagCacheEntry), TAG_CACHE_ENTRIES };
+    f.write((const uint8_t*)&h, sizeof(h));
+    f.write((const uint8_t*)gEntries, sizeof(gEntries));
+    f.close();
+}
+
+void tagCacheBegin(fs::FS& fs) {
+    gFs = &fs;
+    for (TagCacheEntry& e : gEntries) e = TagCacheEntry{};
+    File f = fs.open(TAG_CACHE_PATH, "r");
+    if (!f) return;
+
+    TagCacheHeader h;
+    if (f.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || h.magic != TAG_CACHE_MAGIC ||
+        h.entrySize != sizeof(TagCacheEntry)) {
+        f.close();
+        return;
+    }
+    uint8_t loaded = 0;
+    for (uint16_t i = 0; i < h.count && loaded < TAG_CACHE_ENTRIES; ++i) {
+        TagCacheEntry& e = gEntries[loaded];
+        if (f.read((uint8_t*)&e, sizeof(e)) != sizeof(e)) break;
+        if (e.uid.empty() || e.uid.len > TAG_UID_MAX || e.hash != fnv1a(e.user, sizeof(e.user))) {
+            e = TagCacheEntry{};
+            continue;
+        }
+        if (e.lastUsed > gTick) gTick = e.lastUsed;
+        loaded++;
+    }
+    f.close();
+    Serial.printf("[TAGCACHE] %u tags restored\n", loaded);
+}
+
+bool tagCacheLookup(const TagUid& uid, uint8_t* user) {
+    TagCacheEntry* e = find(uid);
+    if (!e) return false;
+    e->lastUsed = ++gTick;
+    memcpy(user, e->user, sizeof(e->user));
+    return true;
+}
+
+void tagCacheStore(const TagUid& uid, const uint8_t* user) {
+    if (uid.empty()) return;
+    uint32_t hash = fnv1a(user, TIGERTAG_BYTES);
+
+    TagCacheEntry* e = find(uid);
+    if (e && e->hash == hash) { e->lastUsed = ++gTick; return; }
+    if (!e) {
+        // Free slot first, otherwise the least recently used one
+        e = &gEntries[0];
+        for (TagCacheEntry& c : gEntries) {
+            if (c.uid.empty()) { e = &c; break; }
+            if (c.lastUsed < e->lastUsed) e = &c;
+        }
+    }
+    *e = TagCacheEntry{};
+    e->uid = uid;
+    e->hash = hash;
+    e->lastUsed = ++gTick;
+    memcpy(e->user, user, TIGERTAG_BYTES);
+    save();
+}
+
+uint8_t tagCacheCount() {
+    uint8_t n = 0;
+    for (const TagCacheEntry& e : gEntries) n += e.uid.empty() ? 0 : 1;
+    return n;
+}
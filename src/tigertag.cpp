@@ -0,0 +1,85 @@
+/*
+ * @file tigertag.cpp
+ * @brief TigerTagScale - Décodeur des pages TigerTag + calcul du filament net
+ */
+
+#include "tigertag.h"
+
+#include <string.h>
+
+static uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint32_t be24(const uint8_t* p) {
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+static uint16_t be16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Byte offset of a page inside the dump
+static const uint8_t* page(const uint8_t* user, int n) {
+    return user + (n - TIGERTAG_FIRST_PAGE) * 4;
+}
+
+bool tigertagDecode(const uint8_t* user, size_t len, TigerTagInfo* out) {
+    memset(out, 0, sizeof(*out));
+    if (!user || len < TIGERTAG_BYTES) return false;
+
+    out->formatId = be32(page(user, 4));
+    if (out->formatId == 0 || out->formatId == 0xFFFFFFFFu) return false;   // blank NTAG
+
+    out->productId  = be32(page(user, 5));
+    out->materialId = be16(page(user, 6));
+    out->aspect1    = page(user, 6)[2];
+    out->aspect2    = page(user, 6)[3];
+    out->typeId     = page(user, 7)[0];
+    out->diameterId = page(user, 7)[1];
+    out->brandId    = be16(page(user, 7) + 2);
+    out->colorRgba  = be32(page(user, 8));
+
+    uint32_t measure = be24(page(user, 9));
+    switch (page(user, 9)[3]) {
+        case TIGERTAG_UNIT_G:  out->nominalG = measure; break;
+        case TIGERTAG_UNIT_KG: out->nominalG = measure * 1000; break;
+        default:               out->nominalG = 0; break;   // length-based or unknown unit
+    }
+
+    out->nozzleMinC = be16(page(user, 10));
+    out->nozzleMaxC = be16(page(user, 10) + 2);
+    out->dryTempC   = page(user, 11)[0];
+    out->dryHours   = page(user, 11)[1];
+    out->timestamp  = be32(page(user, 12));
+    out->tareG      = be16(page(user, 13));
+
+    if (out->nominalG > TIGERTAG_MAX_NOMINAL_G || out->tareG > TIGERTAG_MAX_NOMINAL_G) return false;
+    out->valid = true;
+    return true;
+}
+
+bool tigertagApportion(const TigerTagInfo* infos, uint8_t n, float gross, int32_t* net) {
+    if (n == 0) return false;
+    uint32_t tare = 0, nominal = 0;
+    for (uint8_t i = 0; i < n; ++i) {
+        if (!infos[i].valid || infos[i].tareG == 0) return false;
+        tare += infos[i].tareG;
+        nominal += infos[i].nominalG;
+    }
+    float total = gross - (float)tare;
+    if (total < 0) total = 0;
+    for (uint8_t i = 0; i < n; ++i) {
+        float share = nominal ? total * (float)infos[i].nominalG / (float)nominal : total / n;
+        net[i] = (int32_t)(share + 0.5f);
+    }
+    return true;
+}
+
+bool tigertagNetGrams(const TigerTagInfo& info, float gross, int32_t* net) {
+    if (!info.valid || info.tareG == 0) return false;
+    float n = gross - (float)info.tareG;
+    if (n < 0) n = 0;
+    *net = (int32_t)(n + 0.5f);
+    return true;
+}
@@ -0,0 +1,47 @@
+/*
+ * @file weight_history.cpp
+ * @brief TigerTagScale - HistoryStore du firmware : horloge, verrou, réponse chunked
+ */
+
+#include "weight_history.h"
+
+#include <ESPAsyncWebServer.h>
+#include <memory>
+
+// Writers: loop task. Readers: AsyncTCP task, one bucket at a time.
+static portMUX_TYPE gHistMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void historyLock() { portENTER_CRITICAL(&gHistMux); }
+static void historyUnlock() { portEXIT_CRITICAL(&gHistMux); }
+
+static HistoryStore gStore(historyLock, historyUnlock);
+
+uint32_t historyNow() {
+    return millis() / 1000;
+}
+
+void historyAddSample(float grams, uint32_t nowMs) {
+    gStore.addSample(grams, nowMs / 1000);
+}
+
+AsyncWebServerResponse* historyBeginResponse(AsyncWebServerRequest* request, uint32_t from,
+                                             uint32_t to, uint16_t points, HistoryMode mode) {
+    // Owned by the response's filler: freed with it, even if the client disconnects mid-way
+    std::shared_ptr<HistoryQuery> q(new HistoryQuery());
+    historyQueryBegin(gStore, *q, from, to, points, mode, historyNow());
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("application/json",
+        [q](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+            size_t written = 0;
+            while (written < maxLen) {
+                if (q->outPos == q->outLen && !historyQueryRender(gStore, *q)) break;
+                size_t take = min((size_t)(q->outLen - q->outPos), maxLen - written);
+                memcpy(buf + written, q->out + q->outPos, take);
+                q->outPos += take;
+                written += take;
+            }
+            return written;   // 0 ends the chunked body
+        });
+    response->addHeader("Cache-Control", "no-store");
+    return response;
+}
@@ -0,0 +1,78 @@
+/*
+ * @file ws_clients.cpp
+ * @brief TigerTagScale - Décision d'envoi par client WebSocket (delta, rattrapage, coalescence)
+ */
+
+#include "ws_clients.h"
+
+#include <string.h>
+
+WsClientTable::WsClientTable() {
+    memset(slots_, 0, sizeof(slots_));
+}
+
+WsClientTable::Slot* WsClientTable::find(uint32_t id) {
+    for (Slot& s : slots_) {
+        if (s.used && s.id == id) return &s;
+    }
+    return nullptr;
+}
+
+const WsClientTable::Slot* WsClientTable::find(uint32_t id) const {
+    for (const Slot& s : slots_) {
+        if (s.used && s.id == id) return &s;
+    }
+    return nullptr;
+}
+
+bool WsClientTable::track(uint32_t id) {
+    if (find(id)) return true;
+    for (Slot& s : slots_) {
+        if (!s.used) {
+            s.used = true;
+            s.id = id;
+            s.pendingMask = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WsClientTable::untrack(uint32_t id) {
+    Slot* s = find(id);
+    if (s) s->used = false;
+}
+
+uint8_t WsClientTable::ids(uint32_t* out) const {
+    uint8_t n = 0;
+    for (const Slot& s : slots_) {
+        if (s.used) out[n++] = s.id;
+    }
+    return n;
+}
+
+WsSendPlan WsClientTable::plan(uint32_t id, uint32_t changed, bool slow) {
+    WsSendPlan p = { WS_SEND_NONE, 0 };
+    Slot* s = find(id);
+    if (!s) return p;
+    if (slow) {
+        if (changed) {
+            s->pendingMask |= changed;
+            p.action = WS_SEND_COALESCED;
+        }
+        return p;
+    }
+    if (s->pendingMask) {
+        p.action = WS_SEND_CATCHUP;
+        p.mask = s->pendingMask | changed;
+        s->pendingMask = 0;
+        return p;
+    }
+    if (changed) p.action = WS_SEND_SHARED;
+    return p;
+}
+
+uint32_t WsClientTable::pending(uint32_t id) const {
+    const Slot* s = find(id);
+    return s ? s->pendingMask : 0;
+}
@@ -0,0 +1,230 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de l'admission (tas et requêtes en cours simulés)
+ */
+
+#include <unity.h>
+
+#include "admission_policy.h"
+
+static uint32_t gRng;
+static uint32_t rnd() {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+void setUp() { gRng = 0x3C6EF372u; }
+void tearDown() {}
+
+void test_levels() {
+    TEST_ASSERT_EQUAL(ADMIT_LEVEL_OK, admissionLevelFor(ADMIT_LOW_FREE, ADMIT_LOW_BLOCK));
+    TEST_ASSERT_EQUAL(ADMIT_LEVEL_LOW, admissionLevelFor(ADMIT_LOW_FREE - 1, ADMIT_LOW_BLOCK));
+    TEST_ASSERT_EQUAL(ADMIT_LEVEL_LOW, admissionLevelFor(100000, ADMIT_LOW_BLOCK - 1));     // fragmented
+    TEST_ASSERT_EQUAL(ADMIT_LEVEL_LOW, admissionLevelFor(ADMIT_CRITICAL_FREE, ADMIT_CRITICAL_BLOCK));
+    TEST_ASSERT_EQUAL(ADMIT_LEVEL_CRITICAL, admissionLevelFor(ADMIT_CRITICAL_FREE - 1, 20000));
+    TEST_ASSERT_EQUAL(ADMIT_LEVEL_CRITICAL, admissionLevelFor(100000, ADMIT_CRITICAL_BLOCK - 1));
+    TEST_ASSERT_EQUAL_STRING("critical", admissionLevelName(ADMIT_LEVEL_CRITICAL));
+}
+
+void test_route_costs() {
+    AdmitCost c;
+    TEST_ASSERT_TRUE(admissionRouteCost("/api/status", &c));
+    TEST_ASSERT_EQUAL(ADMIT_ESSENTIAL, c);
+    TEST_ASSERT_TRUE(admissionRouteCost("/metrics", &c));
+    TEST_ASSERT_EQUAL(ADMIT_ESSENTIAL, c);
+    TEST_ASSERT_TRUE(admissionRouteCost("/api/history?points=500", &c));
+    TEST_ASSERT_EQUAL(ADMIT_EXPENSIVE, c);
+    TEST_ASSERT_TRUE(admissionRouteCost("/ws/stream", &c));
+    TEST_ASSERT_EQUAL(ADMIT_EXPENSIVE, c);
+    TEST_ASSERT_TRUE(admissionRouteCost("/ws", &c));
+    TEST_ASSERT_EQUAL(ADMIT_NORMAL, c);
+    TEST_ASSERT_TRUE(admissionRouteCost("/api/wifi", &c));
+    TEST_ASSERT_EQUAL(ADMIT_NORMAL, c);
+    TEST_ASSERT_FALSE(admissionRouteCost("/", &c));                    // static: asset cache decides
+    TEST_ASSERT_FALSE(admissionRouteCost("/img/custom.png", &c));
+}
+
+void test_levels_shed_in_order() {
+    // OK: everything goes through
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, admissionDecide(ADMIT_LEVEL_OK, ADMIT_ESSENTIAL, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, admissionDecide(ADMIT_LEVEL_OK, ADMIT_NORMAL, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, admissionDecide(ADMIT_LEVEL_OK, ADMIT_EXPENSIVE, false, 0, 0));
+    // LOW: expensive routes only
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, admissionDecide(ADMIT_LEVEL_LOW, ADMIT_ESSENTIAL, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, admissionDecide(ADMIT_LEVEL_LOW, ADMIT_NORMAL, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_LOW, admissionDecide(ADMIT_LEVEL_LOW, ADMIT_EXPENSIVE, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_RETRY_LOW_S, admissionRetryAfter(ADMIT_REJECT_LOW));
+    // CRITICAL: essential only
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, admissionDecide(ADMIT_LEVEL_CRITICAL, ADMIT_ESSENTIAL, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_CRITICAL, admissionDecide(ADMIT_LEVEL_CRITICAL, ADMIT_NORMAL, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_CRITICAL, admissionDecide(ADMIT_LEVEL_CRITICAL, ADMIT_EXPENSIVE, false, 0, 0));
+    TEST_ASSERT_EQUAL(ADMIT_RETRY_CRITICAL_S, admissionRetryAfter(ADMIT_REJECT_CRITICAL));
+
+    // A late rejection (POST body) reports the level's own delay
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_CRITICAL, admissionShedVerdict(ADMIT_LEVEL_CRITICAL));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_LOW, admissionShedVerdict(ADMIT_LEVEL_LOW));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_BUSY, admissionShedVerdict(ADMIT_LEVEL_OK));
+}
+
+void test_websocket_caps() {
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, admissionDecide(ADMIT_LEVEL_OK, ADMIT_NORMAL, true, 0, ADMIT_MAX_WS_CLIENTS - 1));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_WS, admissionDecide(ADMIT_LEVEL_OK, ADMIT_NORMAL, true, 0, ADMIT_MAX_WS_CLIENTS));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_WS, admissionDecide(ADMIT_LEVEL_LOW, ADMIT_NORMAL, true, 0, ADMIT_MAX_WS_CLIENTS_LOW));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_WS, admissionDecide(ADMIT_LEVEL_CRITICAL, ADMIT_NORMAL, true, 0, 0));
+
+    // Upgrades are never counted in flight
+    AdmissionGate g;
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, g.admit(ADMIT_LEVEL_OK, ADMIT_NORMAL, true, true, 0));
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, g.admit(ADMIT_LEVEL_OK, ADMIT_EXPENSIVE, true, false, 0));   // /ws/stream
+    TEST_ASSERT_EQUAL(0, g.inflight());
+}
+
+void test_inflight_cap_and_drain() {
+    AdmissionGate g;
+    for (int i = 0; i < ADMIT_MAX_INFLIGHT; ++i) {
+        TEST_ASSERT_EQUAL(ADMIT_ACCEPT, g.admit(ADMIT_LEVEL_OK, ADMIT_NORMAL, false, false, 0));
+    }
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_BUSY, g.admit(ADMIT_LEVEL_OK, ADMIT_NORMAL, false, false, 0));
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_BUSY, g.admit(ADMIT_LEVEL_OK, ADMIT_EXPENSIVE, false, false, 0));
+    TEST_ASSERT_EQUAL(ADMIT_RETRY_BUSY_S, admissionRetryAfter(ADMIT_REJECT_BUSY));
+    TEST_ASSERT_EQUAL(ADMIT_MAX_INFLIGHT, g.inflight());                 // rejections are not counted
+
+    // Status keeps answering up to twice the cap
+    for (int i = 0; i < ADMIT_MAX_INFLIGHT; ++i) {
+        TEST_ASSERT_EQUAL(ADMIT_ACCEPT, g.admit(ADMIT_LEVEL_OK, ADMIT_ESSENTIAL, false, false, 0));
+    }
+    TEST_ASSERT_EQUAL(ADMIT_REJECT_BUSY, g.admit(ADMIT_LEVEL_OK, ADMIT_ESSENTIAL, false, false, 0));
+
+    // Drain below the cap: admitted again
+    for (int i = 0; i < ADMIT_MAX_INFLIGHT + 1; ++i) g.release();
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, g.admit(ADMIT_LEVEL_OK, ADMIT_NORMAL, false, false, 0));
+    for (int i = 0; i < 3 * ADMIT_MAX_INFLIGHT; ++i) g.release();      // never wraps
+    TEST_ASSERT_EQUAL(0, g.inflight());
+}
+
+// Simulated server: every admitted request holds some heap until it
+// completes a few ticks later, on top of a background that drifts (TLS
+// session, WebSocket buffers). Clients send a browser-like mix each tick.
+#define BASE_FREE       90000
+#define TICKS_LOAD      4000
+#define TICKS_DRAIN     200
+#define BG_RAMP         40          // bytes per tick the background moves by
+#define MAX_HOLD_TICKS  65
+
+struct Req {
+    bool     used;
+    AdmitCost cost;
+    uint32_t heap;
+    uint32_t doneAt;
+};
+
+static uint32_t heapOf(AdmitCost c) {
+    return c == ADMIT_ESSENTIAL ? 600 : c == ADMIT_NORMAL ? 3000 : 14000;
+}
+
+struct Sim {
+    AdmissionGate gate;
+    Req reqs[64] = {};
+    uint32_t used = 0;              // heap held by requests in flight
+    uint32_t background = 10000;
+
+    uint32_t freeHeap() const { return BASE_FREE - used - background; }
+    // Fragmentation: the largest block shrinks faster than the free total
+    AdmitLevel level() const { return admissionLevelFor(freeHeap(), freeHeap() * 3 / 5); }
+
+    void complete(uint32_t now) {
+        for (Req& r : reqs) {
+            if (r.used && (int32_t)(now - r.doneAt) >= 0) {
+                r.used = false;
+                used -= r.heap;
+                gate.release();
+            }
+        }
+    }
+
+    AdmitVerdict send(uint32_t now, AdmitCost cost) {
+        AdmitVerdict v = gate.admit(level(), cost, false, false, 0);
+        if (v != ADMIT_ACCEPT) return v;
+        for (Req& r : reqs) {
+            if (r.used) continue;
+            r = { true, cost, heapOf(cost), now + 5 + rnd() % (cost == ADMIT_EXPENSIVE ? MAX_HOLD_TICKS - 5 : 15) };
+            used += r.heap;
+            return v;
+        }
+        TEST_FAIL_MESSAGE("more requests in flight than the caps allow");
+        return v;
+    }
+};
+
+void test_simulated_load_sheds_and_recovers() {
+    static Sim sim;
+    uint32_t accepted[3] = {}, rejected[3] = {}, shedLow = 0, shedCritical = 0;
+    uint32_t levelsSeen = 0;
+    uint32_t now = 0;
+
+    for (; now < TICKS_LOAD; ++now) {
+        sim.complete(now);
+        // Background pressure ramps up, peaks, then eases off
+        uint32_t phase = now * 4 / TICKS_LOAD;
+        uint32_t target = phase == 0 ? 10000 : phase == 1 ? 35000 : phase == 2 ? 55000 : 20000;
+        if (sim.background + BG_RAMP < target) sim.background += BG_RAMP;
+        else if (sim.background > target + BG_RAMP) sim.background -= BG_RAMP;
+        levelsSeen |= 1u << sim.level();
+
+        for (int n = rnd() % 4; n > 0; --n) {
+            uint32_t pick = rnd() % 100;
+            AdmitCost cost = pick < 40 ? ADMIT_ESSENTIAL : pick < 70 ? ADMIT_NORMAL : ADMIT_EXPENSIVE;
+            AdmitLevel before = sim.level();
+            uint32_t inflight = sim.gate.inflight();
+            AdmitVerdict v = sim.send(now, cost);
+            if (v == ADMIT_ACCEPT) {
+                accepted[cost]++;
+                if (cost == ADMIT_EXPENSIVE) TEST_ASSERT_EQUAL(ADMIT_LEVEL_OK, before);
+                if (cost == ADMIT_NORMAL) TEST_ASSERT_NOT_EQUAL(ADMIT_LEVEL_CRITICAL, before);
+                continue;
+            }
+            rejected[cost]++;
+            TEST_ASSERT_TRUE(admissionRetryAfter(v) >= ADMIT_RETRY_BUSY_S);
+            if (v == ADMIT_REJECT_LOW) shedLow++;
+            if (v == ADMIT_REJECT_CRITICAL) shedCritical++;
+            // Status is only ever refused for the concurrency cap
+            if (cost == ADMIT_ESSENTIAL) {
+                TEST_ASSERT_EQUAL(ADMIT_REJECT_BUSY, v);
+                TEST_ASSERT_TRUE(inflight >= 2 * ADMIT_MAX_INFLIGHT);
+            }
+        }
+        TEST_ASSERT_TRUE(sim.gate.inflight() <= 2 * ADMIT_MAX_INFLIGHT);
+        // Admission keeps the heap clear of exhaustion: at worst one normal
+        // request admitted at the CRITICAL edge, every essential slot taken,
+        // and the background drift while the oldest request still holds
+        TEST_ASSERT_TRUE(sim.freeHeap() > ADMIT_CRITICAL_FREE - heapOf(ADMIT_NORMAL)
+                                            - 2 * ADMIT_MAX_INFLIGHT * heapOf(ADMIT_ESSENTIAL)
+                                            - MAX_HOLD_TICKS * BG_RAMP);
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x7, levelsSeen);                   // went through OK, LOW, CRITICAL
+    TEST_ASSERT_TRUE(shedLow > 0);
+    TEST_ASSERT_TRUE(shedCritical > 0);
+    TEST_ASSERT_TRUE(accepted[ADMIT_ESSENTIAL] > 10 * rejected[ADMIT_ESSENTIAL]);
+    TEST_ASSERT_TRUE(accepted[ADMIT_EXPENSIVE] > 0);
+
+    // Load stops: once the requests in flight drain, the heap is back to OK
+    // and the expensive routes are admitted again
+    sim.background = 10000;
+    for (uint32_t end = now + TICKS_DRAIN; now < end; ++now) sim.complete(now);
+    TEST_ASSERT_EQUAL(0, sim.gate.inflight());
+    TEST_ASSERT_EQUAL(ADMIT_LEVEL_OK, sim.level());
+    TEST_ASSERT_EQUAL(ADMIT_ACCEPT, sim.send(now, ADMIT_EXPENSIVE));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_levels);
+    RUN_TEST(test_route_costs);
+    RUN_TEST(test_levels_shed_in_order);
+    RUN_TEST(test_websocket_caps);
+    RUN_TEST(test_inflight_cap_and_drain);
+    RUN_TEST(test_simulated_load_sheds_and_recovers);
+    return UNITY_END();
+}
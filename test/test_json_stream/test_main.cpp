@@ -0,0 +1,220 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de JsonStreamParser (découpage, fuzz, débit)
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "json_stream.h"
+
+// Callback trace: every field appended as key|type|value;
+struct Trace {
+    char   text[4096];
+    size_t len;
+    int    fields;
+};
+
+static void record(void* ctx, const char* key, JsonValueType type, const char* value, size_t) {
+    Trace* t = (Trace*)ctx;
+    t->fields++;
+    int n = snprintf(t->text + t->len, sizeof(t->text) - t->len, "%s|%d|%s;", key, (int)type, value);
+    if (n > 0) t->len += (size_t)n;
+    if (t->len >= sizeof(t->text)) t->len = sizeof(t->text) - 1;
+}
+
+enum Outcome { OUT_DONE, OUT_FAILED, OUT_INCOMPLETE };
+
+// Feeds doc in chunks cut at the given offsets (sorted, < len)
+static Outcome parseChunked(const char* doc, size_t len, const size_t* cuts, size_t nCuts, Trace& t) {
+    memset(&t, 0, sizeof(t));
+    JsonStreamParser p;
+    p.begin(record, &t);
+    size_t from = 0;
+    for (size_t i = 0; i <= nCuts; ++i) {
+        size_t to = i < nCuts ? cuts[i] : len;
+        if (!p.feed((const uint8_t*)doc + from, to - from)) break;
+        from = to;
+    }
+    if (p.failed()) return OUT_FAILED;
+    return p.done() ? OUT_DONE : OUT_INCOMPLETE;
+}
+
+static Outcome parseWhole(const char* doc, Trace& t) {
+    return parseChunked(doc, strlen(doc), nullptr, 0, t);
+}
+
+// xorshift32: reproducible runs
+static uint32_t gRng = 0x12345678u;
+static uint32_t rnd() {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+void setUp() { gRng = 0x12345678u; }
+void tearDown() {}
+
+void test_fields_and_types() {
+    Trace t;
+    TEST_ASSERT_EQUAL(OUT_DONE, parseWhole(
+        "{\"apiKey\":\"ab\\\"c\",\"weight\":-12.5e1,\"on\":true,\"x\":null,\"n\":{\"a\":[1,\"}\"]}}", t));
+    TEST_ASSERT_EQUAL_STRING("apiKey|0|ab\"c;weight|1|-12.5e1;on|2|true;x|3|null;", t.text);
+}
+
+void test_unicode_escape() {
+    Trace t;
+    TEST_ASSERT_EQUAL(OUT_DONE, parseWhole("{\"u\":\"\\u00e9\\u20ac\"}", t));
+    TEST_ASSERT_EQUAL_STRING("u|0|\xC3\xA9\xE2\x82\xAC;", t.text);
+}
+
+void test_rejects_malformed() {
+    static const char* const bad[] = {
+        "[1]", "{\"a\" 1}", "{\"a\":}", "{\"a\":1,}", "{,}", "{\"a\":01x}", "{\"a\":1.}",
+        "{\"a\":\"\\q\"}", "{\"a\":\"\x01\"}", "{\"a\":1} x", "{\"a\":tru}", "{\"a\":1e}"
+    };
+    for (const char* doc : bad) {
+        Trace t;
+        TEST_ASSERT_EQUAL_MESSAGE(OUT_FAILED, parseWhole(doc, t), doc);
+    }
+}
+
+void test_value_too_long_fails() {
+    char doc[JSON_STREAM_VALUE_MAX + 16];
+    memset(doc, 'a', sizeof(doc));
+    memcpy(doc, "{\"k\":\"", 6);
+    memcpy(doc + sizeof(doc) - 3, "\"}", 3);
+    Trace t;
+    TEST_ASSERT_EQUAL(OUT_FAILED, parseWhole(doc, t));
+}
+
+void test_long_key_is_skipped() {
+    char doc[JSON_STREAM_KEY_MAX + 32];
+    memset(doc, 'k', sizeof(doc));
+    doc[0] = '{';
+    doc[1] = '"';
+    snprintf(doc + JSON_STREAM_KEY_MAX + 4, 28, "\":1,\"b\":2}");
+    Trace t;
+    TEST_ASSERT_EQUAL(OUT_DONE, parseWhole(doc, t));
+    TEST_ASSERT_EQUAL_STRING("b|1|2;", t.text);
+}
+
+// Every split of a valid body gives the same fields as the whole body
+void test_every_two_chunk_split() {
+    const char* doc = "{\"host\":\"mqtt.local\",\"port\":1883,\"enabled\":true,\"pass\":\"p\\u0041ss\",\"skip\":[{\"a\":\"]\"}]}";
+    size_t len = strlen(doc);
+    Trace whole;
+    TEST_ASSERT_EQUAL(OUT_DONE, parseWhole(doc, whole));
+    for (size_t cut = 1; cut < len; ++cut) {
+        Trace t;
+        TEST_ASSERT_EQUAL(OUT_DONE, parseChunked(doc, len, &cut, 1, t));
+        TEST_ASSERT_EQUAL_STRING(whole.text, t.text);
+    }
+}
+
+// Random bytes from a JSON-heavy alphabet, mutated valid bodies and random
+// chunkings: the parser must never overrun, and the outcome and the fields
+// seen must not depend on where the TCP chunks were cut.
+void test_fuzz_chunk_invariance() {
+    static const char kAlphabet[] = "{}[]\":,\\ 0123456789.-+eEtrufalsn\"u\x01\xC3\xA9" "ab";
+    static const char* const kSeeds[] = {
+        "{\"weight\":12.5,\"uid\":\"04112233\"}",
+        "{\"factor\":\"406.2\",\"value\":1}",
+        "{\"enabled\":false,\"host\":\"h\",\"n\":[[{}],\"x\"],\"t\":\"\\u00e9\"}",
+    };
+    char doc[256];
+    int done = 0, failed = 0;
+    for (int iter = 0; iter < 20000; ++iter) {
+        size_t len;
+        if (iter & 1) {
+            len = rnd() % (sizeof(doc) - 1);
+            for (size_t i = 0; i < len; ++i) doc[i] = kAlphabet[rnd() % (sizeof(kAlphabet) - 1)];
+            if (len) doc[0] = '{';
+        } else {
+            const char* seed = kSeeds[rnd() % 3];
+            len = strlen(seed);
+            memcpy(doc, seed, len);
+            for (uint32_t m = rnd() % 4; m; --m) doc[rnd() % len] = kAlphabet[rnd() % (sizeof(kAlphabet) - 1)];
+        }
+        doc[len] = '\0';
+
+        Trace whole;
+        Outcome expected = parseChunked(doc, len, nullptr, 0, whole);
+        size_t cuts[8];
+        size_t nCuts = len > 1 ? rnd() % 8 : 0;
+        for (size_t i = 0; i < nCuts; ++i) cuts[i] = 1 + rnd() % (len - 1);
+        for (size_t i = 1; i < nCuts; ++i) {           // insertion sort
+            for (size_t j = i; j > 0 && cuts[j - 1] > cuts[j]; --j) {
+                size_t tmp = cuts[j]; cuts[j] = cuts[j - 1]; cuts[j - 1] = tmp;
+            }
+        }
+        Trace t;
+        TEST_ASSERT_EQUAL_MESSAGE(expected, parseChunked(doc, len, cuts, nCuts, t), doc);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(whole.text, t.text, doc);
+        done += expected == OUT_DONE;
+        failed += expected == OUT_FAILED;
+    }
+    // The corpus must exercise both paths, not only rejections
+    TEST_ASSERT_GREATER_THAN(1000, done);
+    TEST_ASSERT_GREATER_THAN(1000, failed);
+}
+
+void test_parse_float() {
+    float f = 0;
+    TEST_ASSERT_TRUE(jsonParseFloat(JSON_VALUE_NUMBER, "406.5", f));
+    TEST_ASSERT_EQUAL_FLOAT(406.5f, f);
+    TEST_ASSERT_TRUE(jsonParseFloat(JSON_VALUE_STRING, "-2e3", f));
+    TEST_ASSERT_EQUAL_FLOAT(-2000.0f, f);
+    TEST_ASSERT_FALSE(jsonParseFloat(JSON_VALUE_STRING, "inf", f));
+    TEST_ASSERT_FALSE(jsonParseFloat(JSON_VALUE_STRING, "-Infinity", f));
+    TEST_ASSERT_FALSE(jsonParseFloat(JSON_VALUE_STRING, "nan", f));
+    TEST_ASSERT_FALSE(jsonParseFloat(JSON_VALUE_NUMBER, "1e39", f));
+    TEST_ASSERT_FALSE(jsonParseFloat(JSON_VALUE_STRING, "12g", f));
+    TEST_ASSERT_FALSE(jsonParseFloat(JSON_VALUE_STRING, "", f));
+    TEST_ASSERT_FALSE(jsonParseFloat(JSON_VALUE_BOOL, "true", f));
+    TEST_ASSERT_EQUAL_FLOAT(-2000.0f, f);              // untouched on failure
+}
+
+static void ignoreField(void*, const char*, JsonValueType, const char*, size_t) {}
+
+// Host throughput on a typical /api/mqtt body fed in 64-byte chunks. Reported
+// only: the ESP32 figure is what matters, this catches order-of-magnitude
+// regressions when compared run to run.
+void test_throughput() {
+    const char* doc = "{\"enabled\":true,\"host\":\"broker.example.org\",\"port\":8883,"
+                      "\"user\":\"scale\",\"pass\":\"s3cr\\u00e9t\",\"topic\":\"tigerscale\"}";
+    size_t len = strlen(doc);
+    const int kRuns = 200000;
+    clock_t t0 = clock();
+    for (int r = 0; r < kRuns; ++r) {
+        JsonStreamParser p;
+        p.begin(ignoreField, nullptr);
+        for (size_t off = 0; off < len; off += 64) {
+            p.feed((const uint8_t*)doc + off, len - off < 64 ? len - off : 64);
+        }
+        TEST_ASSERT_TRUE(p.done());
+    }
+    double s = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%.1f MB/s, %.2f us per body (host)",
+             s > 0 ? (double)len * kRuns / s / 1e6 : 0.0, s * 1e6 / kRuns);
+    TEST_MESSAGE(msg);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fields_and_types);
+    RUN_TEST(test_unicode_escape);
+    RUN_TEST(test_rejects_malformed);
+    RUN_TEST(test_value_too_long_fails);
+    RUN_TEST(test_long_key_is_skipped);
+    RUN_TEST(test_every_two_chunk_split);
+    RUN_TEST(test_fuzz_chunk_invariance);
+    RUN_TEST(test_parse_float);
+    RUN_TEST(test_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,264 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de MqttQueue (broker simulé : identifiants, PUBACK, coupures)
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mqtt_queue.h"
+
+static uint16_t gNextId;
+
+void setUp() { gNextId = 1; }
+void tearDown() {}
+
+// Publishes one message the way mqtt_publisher's drainQueue() does; returns
+// its packet id (the reused one for a DUP)
+static uint16_t sendOne(MqttQueue& q, uint32_t nowMs, MqttOutgoing* out) {
+    TEST_ASSERT_TRUE(q.next(nowMs, out));
+    uint16_t id = out->dup ? out->packetId : gNextId++;
+    q.sent(*out, id);
+    return id;
+}
+
+void test_fifo_and_window() {
+    MqttQueue q;
+    char topic[16];
+    for (int i = 0; i < 6; ++i) {
+        snprintf(topic, sizeof(topic), "base/e%d", i);
+        TEST_ASSERT_TRUE(q.enqueue(topic, "x", false, false));
+    }
+    TEST_ASSERT_EQUAL(6, q.queued());
+
+    // At most MQTT_MAX_INFLIGHT unacked, in enqueue order
+    MqttOutgoing out;
+    for (int i = 0; i < MQTT_MAX_INFLIGHT; ++i) {
+        sendOne(q, 0, &out);
+        snprintf(topic, sizeof(topic), "base/e%d", i);
+        TEST_ASSERT_EQUAL_STRING(topic, out.topic);
+        TEST_ASSERT_FALSE(out.dup);
+    }
+    TEST_ASSERT_FALSE(q.next(0, &out));
+    TEST_ASSERT_EQUAL(MQTT_MAX_INFLIGHT, q.inflight());
+
+    // A PUBACK opens the window again
+    TEST_ASSERT_TRUE(q.acked(2));
+    TEST_ASSERT_FALSE(q.acked(2));
+    TEST_ASSERT_FALSE(q.acked(99));
+    sendOne(q, 0, &out);
+    TEST_ASSERT_EQUAL_STRING("base/e4", out.topic);
+    TEST_ASSERT_EQUAL(5, q.queued());
+    TEST_ASSERT_EQUAL(1, q.stats().published);
+}
+
+void test_coalesce_pending_state() {
+    MqttQueue q;
+    q.enqueue("base/weight", "{\"weight\":1}", true, true);
+    q.enqueue("base/stable", "{\"weight\":1}", false, false);
+    q.enqueue("base/weight", "{\"weight\":2}", true, true);
+    q.enqueue("base/weight", "{\"weight\":3}", true, true);
+    TEST_ASSERT_EQUAL(2, q.queued());
+    TEST_ASSERT_EQUAL(2, q.stats().coalesced);
+
+    // Latest value, first place in the FIFO
+    MqttOutgoing out;
+    sendOne(q, 0, &out);
+    TEST_ASSERT_EQUAL_STRING("base/weight", out.topic);
+    TEST_ASSERT_EQUAL_STRING("{\"weight\":3}", out.payload);
+    TEST_ASSERT_TRUE(out.retain);
+
+    // Already in flight: a new value takes a new slot, never rewrites it
+    q.enqueue("base/weight", "{\"weight\":4}", true, true);
+    TEST_ASSERT_EQUAL(3, q.queued());
+    TEST_ASSERT_EQUAL(2, q.stats().coalesced);
+
+    // Events never coalesce
+    q.enqueue("base/stable", "{\"weight\":4}", false, false);
+    TEST_ASSERT_EQUAL(4, q.queued());
+}
+
+void test_full_queue_evicts_oldest_state() {
+    MqttQueue q;
+    char topic[16];
+    // Oldest first: state s0, events, state s1, then events up to full
+    q.enqueue("base/s0", "old", true, true);
+    for (int i = 0; i < 4; ++i) {
+        snprintf(topic, sizeof(topic), "base/e%d", i);
+        q.enqueue(topic, "x", false, false);
+    }
+    q.enqueue("base/s1", "old", true, true);
+    for (int i = 4; i < MQTT_QUEUE_SLOTS - 2; ++i) {
+        snprintf(topic, sizeof(topic), "base/e%d", i);
+        q.enqueue(topic, "x", false, false);
+    }
+    TEST_ASSERT_EQUAL(MQTT_QUEUE_SLOTS, q.queued());
+
+    // s0 gives way, then s1; the evicted message counts as dropped
+    TEST_ASSERT_TRUE(q.enqueue("base/late0", "x", false, false));
+    TEST_ASSERT_EQUAL(1, q.stats().dropped);
+    TEST_ASSERT_TRUE(q.enqueue("base/late1", "x", false, false));
+    TEST_ASSERT_EQUAL(2, q.stats().dropped);
+    TEST_ASSERT_EQUAL(MQTT_QUEUE_SLOTS, q.queued());
+
+    // Only events left: the new one is refused
+    TEST_ASSERT_FALSE(q.enqueue("base/late2", "x", false, false));
+    TEST_ASSERT_FALSE(q.enqueue("base/s2", "x", true, true));
+    TEST_ASSERT_EQUAL(4, q.stats().dropped);
+
+    // Survivors drain in FIFO order: e0..e9, late0, late1
+    MqttOutgoing out;
+    int n = 0;
+    while (q.next(0, &out)) {
+        q.sent(out, gNextId);
+        q.acked(gNextId++);
+        if (n < MQTT_QUEUE_SLOTS - 2) {
+            snprintf(topic, sizeof(topic), "base/e%d", n);
+            TEST_ASSERT_EQUAL_STRING(topic, out.topic);
+        }
+        n++;
+    }
+    TEST_ASSERT_EQUAL(MQTT_QUEUE_SLOTS, n);
+    TEST_ASSERT_EQUAL_STRING("base/late1", out.topic);
+    TEST_ASSERT_EQUAL(0, q.queued());
+}
+
+void test_in_flight_state_not_evicted() {
+    MqttQueue q;
+    q.enqueue("base/weight", "1", true, true);
+    MqttOutgoing out;
+    sendOne(q, 0, &out);
+    char topic[16];
+    for (int i = 1; i < MQTT_QUEUE_SLOTS; ++i) {
+        snprintf(topic, sizeof(topic), "base/e%d", i);
+        q.enqueue(topic, "x", false, false);
+    }
+    // The only state message is in flight: nothing to evict
+    TEST_ASSERT_FALSE(q.enqueue("base/e99", "x", false, false));
+    TEST_ASSERT_EQUAL(1, q.inflight());
+}
+
+void test_puback_timeout_resends_dup() {
+    MqttQueue q;
+    q.enqueue("base/a", "1", false, false);
+    q.enqueue("base/b", "2", false, false);
+    MqttOutgoing out;
+    uint16_t idA = sendOne(q, 1000, &out);
+    uint16_t idB = sendOne(q, 1500, &out);
+
+    // Not yet: the timeout is strict
+    TEST_ASSERT_FALSE(q.next(1000 + MQTT_ACK_TIMEOUT_MS, &out));
+
+    // a times out first: same id, DUP set, still in flight
+    TEST_ASSERT_TRUE(q.next(1001 + MQTT_ACK_TIMEOUT_MS, &out));
+    TEST_ASSERT_TRUE(out.dup);
+    TEST_ASSERT_EQUAL(idA, out.packetId);
+    TEST_ASSERT_EQUAL_STRING("base/a", out.topic);
+    q.sent(out, out.packetId);
+    TEST_ASSERT_EQUAL(1, q.stats().retries);
+    TEST_ASSERT_EQUAL(2, q.inflight());
+
+    // Its timer restarted; b is next
+    TEST_ASSERT_TRUE(q.next(1501 + MQTT_ACK_TIMEOUT_MS, &out));
+    TEST_ASSERT_TRUE(out.dup);
+    TEST_ASSERT_EQUAL(idB, out.packetId);
+    q.sent(out, out.packetId);
+    TEST_ASSERT_FALSE(q.next(1501 + MQTT_ACK_TIMEOUT_MS, &out));
+
+    // The PUBACK of the DUP frees the slot
+    TEST_ASSERT_TRUE(q.acked(idA));
+    TEST_ASSERT_TRUE(q.acked(idB));
+    TEST_ASSERT_EQUAL(0, q.queued());
+    TEST_ASSERT_EQUAL(2, q.stats().published);
+
+    // Clock wrap: the timeout is a difference
+    q.enqueue("base/c", "3", false, false);
+    sendOne(q, 0xFFFFFF00u, &out);
+    TEST_ASSERT_FALSE(q.next(0x00000100u, &out));
+    TEST_ASSERT_TRUE(q.next(0xFFFFFF01u + MQTT_ACK_TIMEOUT_MS, &out));
+    TEST_ASSERT_TRUE(out.dup);
+}
+
+void test_refused_goes_back_to_pending() {
+    MqttQueue q;
+    q.enqueue("base/a", "1", false, false);
+    q.enqueue("base/b", "2", false, false);
+    MqttOutgoing out;
+    TEST_ASSERT_TRUE(q.next(0, &out));
+    q.sent(out, 0);                         // client refused: TCP buffer full
+    TEST_ASSERT_EQUAL(0, q.inflight());
+    TEST_ASSERT_EQUAL(2, q.queued());
+
+    // Retried first, as a fresh publish
+    sendOne(q, 10, &out);
+    TEST_ASSERT_EQUAL_STRING("base/a", out.topic);
+    TEST_ASSERT_FALSE(out.dup);
+    TEST_ASSERT_EQUAL(0, q.stats().retries);
+}
+
+void test_disconnect_returns_in_flight() {
+    MqttQueue q;
+    q.enqueue("base/a", "1", false, false);
+    q.enqueue("base/b", "2", false, false);
+    q.enqueue("base/c", "3", false, false);
+    MqttOutgoing out;
+    uint16_t idA = sendOne(q, 0, &out);
+    sendOne(q, 0, &out);
+    TEST_ASSERT_EQUAL(2, q.inflight());
+
+    q.disconnected();
+    TEST_ASSERT_EQUAL(0, q.inflight());
+    TEST_ASSERT_EQUAL(3, q.queued());
+    TEST_ASSERT_EQUAL(2, q.stats().retries);
+
+    // A late PUBACK for the old session matches nothing
+    TEST_ASSERT_FALSE(q.acked(idA));
+
+    // After reconnect: same order, fresh packets (clean session), no DUP
+    const char* expected[] = { "base/a", "base/b", "base/c" };
+    for (const char* e : expected) {
+        uint16_t id = sendOne(q, 100, &out);
+        TEST_ASSERT_EQUAL_STRING(e, out.topic);
+        TEST_ASSERT_FALSE(out.dup);
+        TEST_ASSERT_TRUE(id > idA);
+    }
+
+    // Pending messages are state again: they coalesce and can be evicted
+    q.clear();
+    q.enqueue("base/weight", "1", true, true);
+    sendOne(q, 0, &out);
+    q.disconnected();
+    q.enqueue("base/weight", "2", true, true);
+    TEST_ASSERT_EQUAL(1, q.queued());
+    TEST_ASSERT_TRUE(q.next(0, &out));
+    TEST_ASSERT_EQUAL_STRING("2", out.payload);
+}
+
+void test_long_topic_and_payload_truncated() {
+    MqttQueue q;
+    char topic[200], payload[400];
+    memset(topic, 't', sizeof(topic) - 1);
+    topic[sizeof(topic) - 1] = '\0';
+    memset(payload, 'p', sizeof(payload) - 1);
+    payload[sizeof(payload) - 1] = '\0';
+    TEST_ASSERT_TRUE(q.enqueue(topic, payload, false, false));
+    MqttOutgoing out;
+    TEST_ASSERT_TRUE(q.next(0, &out));
+    TEST_ASSERT_EQUAL(MQTT_TOPIC_MAX - 1, strlen(out.topic));
+    TEST_ASSERT_EQUAL(MQTT_PAYLOAD_MAX - 1, strlen(out.payload));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_and_window);
+    RUN_TEST(test_coalesce_pending_state);
+    RUN_TEST(test_full_queue_evicts_oldest_state);
+    RUN_TEST(test_in_flight_state_not_evicted);
+    RUN_TEST(test_puback_timeout_resends_dup);
+    RUN_TEST(test_refused_goes_back_to_pending);
+    RUN_TEST(test_disconnect_returns_in_flight);
+    RUN_TEST(test_long_topic_and_payload_truncated);
+    return UNITY_END();
+}
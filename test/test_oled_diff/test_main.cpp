@@ -0,0 +1,193 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte d'OledDiff (transport simulé = GDDRAM du SSD1306)
+ */
+
+#include <unity.h>
+
+#include <string.h>
+
+#include "oled_diff.h"
+
+#define W       128
+#define PAGES   8
+
+// Records the windows and plays the data into a copy of the controller RAM
+class PanelMock : public OledTransport {
+public:
+    uint8_t ram[W * PAGES];
+    uint16_t windows = 0;
+    uint16_t bytes = 0;
+    uint8_t page = 0, col0 = 0, col1 = 0;
+    int lastEndOnPage[PAGES];
+
+    PanelMock() { memset(ram, 0, sizeof(ram)); reset(); }
+    void reset() {
+        windows = bytes = 0;
+        for (int& e : lastEndOnPage) e = -1000;
+    }
+
+    void window(uint8_t p, uint8_t c0, uint8_t c1) override {
+        TEST_ASSERT_TRUE(p < PAGES && c0 <= c1 && c1 < W);
+        // Windows of one flush come in column order and never closer than
+        // OLED_MERGE_GAP (those would have been merged)
+        TEST_ASSERT_TRUE(c0 - lastEndOnPage[p] - 1 >= OLED_MERGE_GAP);
+        lastEndOnPage[p] = c1;
+        page = p; col0 = c0; col1 = c1;
+        windows++;
+    }
+
+    void data(const uint8_t* d, uint16_t n) override {
+        TEST_ASSERT_EQUAL(col1 - col0 + 1, n);
+        memcpy(ram + page * W + col0, d, n);
+        bytes += n;
+    }
+};
+
+static uint32_t gRng;
+static uint32_t rnd() {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+static uint8_t gFrame[W * PAGES];
+
+void setUp() {
+    gRng = 0xBB67AE85u;
+    memset(gFrame, 0, sizeof(gFrame));
+}
+void tearDown() {}
+
+void test_first_flush_sends_everything() {
+    OledDiff diff(W, PAGES);
+    PanelMock panel;
+    OledFlushResult r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(PAGES, r.windows);
+    TEST_ASSERT_EQUAL(W * PAGES, r.dataBytes);
+    TEST_ASSERT_EQUAL(W * PAGES, panel.bytes);
+}
+
+void test_no_change_sends_nothing() {
+    OledDiff diff(W, PAGES);
+    PanelMock panel;
+    diff.flush(gFrame, panel);
+    for (int i = 0; i < 3; ++i) {
+        panel.reset();
+        OledFlushResult r = diff.flush(gFrame, panel);
+        TEST_ASSERT_EQUAL(0, r.windows);
+        TEST_ASSERT_EQUAL(0, r.dataBytes);
+        TEST_ASSERT_EQUAL(0, panel.windows);
+    }
+}
+
+void test_single_byte() {
+    OledDiff diff(W, PAGES);
+    PanelMock panel;
+    diff.flush(gFrame, panel);
+    panel.reset();
+    gFrame[5 * W + 77] = 0x3C;
+    OledFlushResult r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(1, r.windows);
+    TEST_ASSERT_EQUAL(1, r.dataBytes);
+    TEST_ASSERT_EQUAL(5, panel.page);
+    TEST_ASSERT_EQUAL(77, panel.col0);
+    TEST_ASSERT_EQUAL(77, panel.col1);
+    TEST_ASSERT_EQUAL_HEX8(0x3C, panel.ram[5 * W + 77]);
+}
+
+void test_merge_around_gap() {
+    OledDiff diff(W, PAGES);
+    PanelMock panel;
+    diff.flush(gFrame, panel);
+
+    // OLED_MERGE_GAP - 1 identical bytes between two changes: one window
+    panel.reset();
+    gFrame[10] = 1;
+    gFrame[10 + OLED_MERGE_GAP] = 1;
+    OledFlushResult r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(1, r.windows);
+    TEST_ASSERT_EQUAL(OLED_MERGE_GAP + 1, r.dataBytes);
+    TEST_ASSERT_EQUAL(10, panel.col0);
+    TEST_ASSERT_EQUAL(10 + OLED_MERGE_GAP, panel.col1);
+
+    // OLED_MERGE_GAP identical bytes: two windows, changed bytes only
+    panel.reset();
+    gFrame[40] = 2;
+    gFrame[40 + OLED_MERGE_GAP + 1] = 2;
+    r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(2, r.windows);
+    TEST_ASSERT_EQUAL(2, r.dataBytes);
+
+    // Changes on two pages never share a window
+    panel.reset();
+    gFrame[W - 1] = 3;
+    gFrame[W] = 3;
+    r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(2, r.windows);
+
+    // Window reaching the last column
+    panel.reset();
+    gFrame[2 * W + W - 3] = 4;
+    gFrame[2 * W + W - 1] = 4;
+    r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(1, r.windows);
+    TEST_ASSERT_EQUAL(3, r.dataBytes);
+    TEST_ASSERT_EQUAL(W - 1, panel.col1);
+}
+
+void test_invalidate_resends() {
+    OledDiff diff(W, PAGES);
+    PanelMock panel;
+    diff.flush(gFrame, panel);
+    diff.invalidate();
+    panel.reset();
+    OledFlushResult r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(PAGES, r.windows);
+    TEST_ASSERT_EQUAL(W * PAGES, r.dataBytes);
+    panel.reset();
+    TEST_ASSERT_EQUAL(0, diff.flush(gFrame, panel).windows);
+}
+
+void test_smaller_panel() {
+    OledDiff diff(W, 4);                            // 128x32
+    PanelMock panel;
+    OledFlushResult r = diff.flush(gFrame, panel);
+    TEST_ASSERT_EQUAL(4, r.windows);
+    TEST_ASSERT_EQUAL(W * 4, r.dataBytes);
+}
+
+// Random edits (digits, bars, full redraws): after every flush the mock
+// RAM equals the frame, and never more bytes than the frame are sent
+void test_fuzz_panel_matches_frame() {
+    OledDiff diff(W, PAGES);
+    PanelMock panel;
+    diff.flush(gFrame, panel);
+    for (int round = 0; round < 5000; ++round) {
+        int edits = rnd() % 6;
+        for (int e = 0; e < edits; ++e) {
+            int at = rnd() % (W * PAGES);
+            int len = 1 + rnd() % 24;
+            for (int i = at; i < at + len && i < W * PAGES; ++i) gFrame[i] = (uint8_t)rnd();
+        }
+        if (rnd() % 500 == 0) diff.invalidate();
+        panel.reset();
+        OledFlushResult r = diff.flush(gFrame, panel);
+        TEST_ASSERT_EQUAL_MEMORY(gFrame, panel.ram, sizeof(gFrame));
+        TEST_ASSERT_TRUE(r.dataBytes <= W * PAGES);
+        if (edits == 0 && r.windows) TEST_ASSERT_EQUAL(PAGES, r.windows);   // only after invalidate()
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_flush_sends_everything);
+    RUN_TEST(test_no_change_sends_nothing);
+    RUN_TEST(test_single_byte);
+    RUN_TEST(test_merge_around_gap);
+    RUN_TEST(test_invalidate_resends);
+    RUN_TEST(test_smaller_panel);
+    RUN_TEST(test_fuzz_panel_matches_frame);
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte d'OledNotifyQueue (horloge simulée)
+ */
+
+#include <unity.h>
+
+#include "oled_notify.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_empty() {
+    OledNotifyQueue q;
+    TEST_ASSERT_NULL(q.current(0));
+    TEST_ASSERT_EQUAL(0, q.size());
+}
+
+void test_lines() {
+    OledNotifyQueue q;
+    TEST_ASSERT_TRUE(q.push("Synced", nullptr, "0123456789012345678901234", 1000, NOTIFY_RESULT));
+    const OledNotice* n = q.current(0);
+    TEST_ASSERT_NOT_NULL(n);
+    TEST_ASSERT_EQUAL_STRING("Synced", n->line[0]);
+    TEST_ASSERT_EQUAL_STRING("", n->line[1]);
+    TEST_ASSERT_EQUAL_STRING("012345678901234567890", n->line[2]);   // cut at OLED_NOTIFY_COLS
+}
+
+void test_priority_order() {
+    OledNotifyQueue q;
+    q.push("info 1", nullptr, nullptr, 1000, NOTIFY_INFO);
+    q.push("result", nullptr, nullptr, 1000, NOTIFY_RESULT);
+    q.push("info 2", nullptr, nullptr, 1000, NOTIFY_INFO);
+    q.push("error", nullptr, nullptr, 1000, NOTIFY_ERROR);
+
+    // Each shown for its full duration, most important first, then oldest
+    const char* expected[] = { "error", "result", "info 1", "info 2" };
+    uint32_t t = 0;
+    for (const char* e : expected) {
+        const OledNotice* n = q.current(t);
+        TEST_ASSERT_NOT_NULL(n);
+        TEST_ASSERT_EQUAL_STRING(e, n->line[0]);
+        TEST_ASSERT_EQUAL_STRING(e, q.current(t + 999)->line[0]);
+        t += 1000;
+    }
+    TEST_ASSERT_NULL(q.current(t));
+    TEST_ASSERT_EQUAL(0, q.size());
+}
+
+void test_expiry_from_first_frame() {
+    OledNotifyQueue q;
+    q.push("a", nullptr, nullptr, 1000, NOTIFY_RESULT);
+    TEST_ASSERT_EQUAL_STRING("a", q.current(100)->line[0]);    // first frame: timer starts at 100
+
+    // A more important notice masks it; its own time keeps running
+    q.push("err", nullptr, nullptr, 3000, NOTIFY_ERROR);
+    TEST_ASSERT_EQUAL_STRING("err", q.current(500)->line[0]);
+    TEST_ASSERT_EQUAL_STRING("err", q.current(1099)->line[0]);
+    TEST_ASSERT_EQUAL(2, q.size());
+    TEST_ASSERT_EQUAL_STRING("err", q.current(1100)->line[0]);
+    TEST_ASSERT_EQUAL(1, q.size());                             // "a" expired behind it
+    TEST_ASSERT_EQUAL_STRING("err", q.current(3499)->line[0]);
+    TEST_ASSERT_NULL(q.current(3500));
+
+    // Queued but never drawn: the duration has not started
+    q.push("err", nullptr, nullptr, 500, NOTIFY_ERROR);
+    q.push("later", nullptr, nullptr, 500, NOTIFY_INFO);
+    q.current(10000);
+    TEST_ASSERT_EQUAL_STRING("later", q.current(10500)->line[0]);
+    TEST_ASSERT_EQUAL_STRING("later", q.current(10999)->line[0]);
+    TEST_ASSERT_NULL(q.current(11000));
+
+    // Clock wrap: durations are differences
+    q.push("wrap", nullptr, nullptr, 1000, NOTIFY_INFO);
+    TEST_ASSERT_NOT_NULL(q.current(0xFFFFFE00u));
+    TEST_ASSERT_NOT_NULL(q.current(0x000001E7u));
+    TEST_ASSERT_NULL(q.current(0x000001E8u));
+}
+
+void test_same_key_replaces() {
+    OledNotifyQueue q;
+    q.push("other", nullptr, nullptr, 1000, NOTIFY_INFO);
+    q.push("Sending...", nullptr, nullptr, 5000, NOTIFY_INFO, 7);
+    TEST_ASSERT_EQUAL_STRING("other", q.current(0)->line[0]);
+    TEST_ASSERT_EQUAL_STRING("Sending...", q.current(1000)->line[0]);
+
+    // Replaced in place: same slot, timer restarts from the next frame
+    TEST_ASSERT_TRUE(q.push("Synced", "1012 g", nullptr, 1500, NOTIFY_RESULT, 7));
+    TEST_ASSERT_EQUAL(1, q.size());
+    const OledNotice* n = q.current(4000);
+    TEST_ASSERT_EQUAL_STRING("Synced", n->line[0]);
+    TEST_ASSERT_EQUAL_STRING("1012 g", n->line[1]);
+    TEST_ASSERT_EQUAL(NOTIFY_RESULT, n->priority);
+    TEST_ASSERT_NOT_NULL(q.current(5499));
+    TEST_ASSERT_NULL(q.current(5500));
+
+    // Key 0 never replaces
+    q.push("x", nullptr, nullptr, 1000, NOTIFY_INFO);
+    q.push("y", nullptr, nullptr, 1000, NOTIFY_INFO);
+    TEST_ASSERT_EQUAL(2, q.size());
+}
+
+void test_replace_keeps_place() {
+    OledNotifyQueue q;
+    q.push("first", nullptr, nullptr, 1000, NOTIFY_RESULT, 3);
+    q.push("second", nullptr, nullptr, 1000, NOTIFY_RESULT);
+    q.push("first v2", nullptr, nullptr, 1000, NOTIFY_RESULT, 3);
+    TEST_ASSERT_EQUAL_STRING("first v2", q.current(0)->line[0]);
+}
+
+void test_eviction_when_full() {
+    OledNotifyQueue q;
+    q.push("info old", nullptr, nullptr, 1000, NOTIFY_INFO);
+    q.push("info new", nullptr, nullptr, 1000, NOTIFY_INFO);
+    q.push("result", nullptr, nullptr, 1000, NOTIFY_RESULT);
+    q.push("error", nullptr, nullptr, 1000, NOTIFY_ERROR);
+    TEST_ASSERT_EQUAL(OLED_NOTIFY_SLOTS, q.size());
+
+    // The least important, oldest first, gives way
+    TEST_ASSERT_TRUE(q.push("result 2", nullptr, nullptr, 1000, NOTIFY_RESULT));
+    TEST_ASSERT_EQUAL(OLED_NOTIFY_SLOTS, q.size());
+    const char* expected[] = { "error", "result", "result 2", "info new" };
+    uint32_t t = 0;
+    for (const char* e : expected) {
+        TEST_ASSERT_EQUAL_STRING(e, q.current(t)->line[0]);
+        t += 1000;
+    }
+    TEST_ASSERT_NULL(q.current(t));
+
+    // Full of more important notices: refused
+    for (int i = 0; i < OLED_NOTIFY_SLOTS; ++i) q.push("error", nullptr, nullptr, 1000, NOTIFY_ERROR);
+    TEST_ASSERT_FALSE(q.push("info", nullptr, nullptr, 1000, NOTIFY_INFO));
+    TEST_ASSERT_FALSE(q.push("result", nullptr, nullptr, 1000, NOTIFY_RESULT));
+    TEST_ASSERT_TRUE(q.push("error 2", nullptr, nullptr, 1000, NOTIFY_ERROR));
+
+    // A same-key push is a replacement, never an eviction
+    q.clear();
+    q.push("keyed", nullptr, nullptr, 1000, NOTIFY_ERROR, 9);
+    for (int i = 1; i < OLED_NOTIFY_SLOTS; ++i) q.push("error", nullptr, nullptr, 1000, NOTIFY_ERROR);
+    TEST_ASSERT_TRUE(q.push("keyed v2", nullptr, nullptr, 1000, NOTIFY_INFO, 9));
+    TEST_ASSERT_EQUAL(OLED_NOTIFY_SLOTS, q.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty);
+    RUN_TEST(test_lines);
+    RUN_TEST(test_priority_order);
+    RUN_TEST(test_expiry_from_first_frame);
+    RUN_TEST(test_same_key_replaces);
+    RUN_TEST(test_replace_keeps_place);
+    RUN_TEST(test_eviction_when_full);
+    return UNITY_END();
+}
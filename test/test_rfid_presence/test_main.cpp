@@ -0,0 +1,92 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de l'anti-rebond de présence (lecteur simulé)
+ */
+
+#include <unity.h>
+
+#include "rfid_presence.h"
+
+static uint32_t gRng;
+static uint32_t rnd() {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+void setUp() { gRng = 0x2545F491u; }
+void tearDown() {}
+
+void test_arrive_once() {
+    RfidPresence p = {};
+    TEST_ASSERT_EQUAL(RFID_EVT_NONE, rfidPresenceUpdate(p, false));    // nothing there yet
+    TEST_ASSERT_EQUAL(RFID_EVT_ARRIVED, rfidPresenceUpdate(p, true));
+    TEST_ASSERT_TRUE(p.present);
+    for (int i = 0; i < 10; ++i) TEST_ASSERT_EQUAL(RFID_EVT_NONE, rfidPresenceUpdate(p, true));
+}
+
+void test_debounce() {
+    RfidPresence p = {};
+    rfidPresenceUpdate(p, true);
+    for (int i = 0; i < RFID_REMOVE_MISSES - 1; ++i) {
+        TEST_ASSERT_EQUAL(RFID_EVT_NONE, rfidPresenceUpdate(p, false));
+    }
+    TEST_ASSERT_EQUAL(RFID_REMOVE_MISSES - 1, p.misses);
+    TEST_ASSERT_EQUAL(RFID_EVT_NONE, rfidPresenceUpdate(p, true));     // answered again: count restarts
+    TEST_ASSERT_EQUAL(0, p.misses);
+    for (int i = 0; i < RFID_REMOVE_MISSES - 1; ++i) {
+        TEST_ASSERT_EQUAL(RFID_EVT_NONE, rfidPresenceUpdate(p, false));
+    }
+    TEST_ASSERT_EQUAL(RFID_EVT_REMOVED, rfidPresenceUpdate(p, false));
+    TEST_ASSERT_FALSE(p.present);
+    TEST_ASSERT_EQUAL(0, p.misses);
+    TEST_ASSERT_EQUAL(RFID_EVT_NONE, rfidPresenceUpdate(p, false));    // removed once only
+    TEST_ASSERT_EQUAL(RFID_EVT_ARRIVED, rfidPresenceUpdate(p, true));  // put back
+}
+
+// 🔎 Simulated reader: one probe every RFID_PRESENCE_MS; the tag answers
+//    while it is on the platform, except when the coupling drops a probe
+//    (never RFID_REMOVE_MISSES in a row, as a spool moving on the tray).
+void test_removal_latency() {
+    for (int run = 0; run < 200; ++run) {
+        RfidPresence p = {};
+        uint32_t placedMs = rnd() % 1000;
+        uint32_t removedMs = placedMs + 2000 + rnd() % 20000;
+        uint32_t arrivedAt = 0, removedAt = 0;
+        int arrivals = 0, removals = 0, drops = 0, dropsBefore = -1;
+
+        for (uint32_t t = 0; t < removedMs + 5000; t += RFID_PRESENCE_MS) {
+            bool onPlatform = t >= placedMs && t < removedMs;
+            if (t >= removedMs && dropsBefore < 0) dropsBefore = drops;
+            bool seen = onPlatform;
+            if (onPlatform && drops < RFID_REMOVE_MISSES - 1 && rnd() % 4 == 0) {
+                seen = false;
+                drops++;
+            } else if (seen) {
+                drops = 0;
+            }
+            switch (rfidPresenceUpdate(p, seen)) {
+                case RFID_EVT_ARRIVED: arrivals++; arrivedAt = t; break;
+                case RFID_EVT_REMOVED: removals++; removedAt = t; break;
+                default: break;
+            }
+        }
+        TEST_ASSERT_EQUAL(1, arrivals);
+        TEST_ASSERT_EQUAL(1, removals);
+        TEST_ASSERT_TRUE(arrivedAt >= placedMs);
+        // Dropped probes never add up to a removal; the real one is reported
+        // on the RFID_REMOVE_MISSES-th silent probe in a row, sooner when the
+        // last probes before the tag left were already dropped
+        TEST_ASSERT_TRUE(removedAt >= removedMs + (RFID_REMOVE_MISSES - 1 - dropsBefore) * RFID_PRESENCE_MS);
+        TEST_ASSERT_TRUE(removedAt < removedMs + RFID_REMOVE_MISSES * RFID_PRESENCE_MS);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_arrive_once);
+    RUN_TEST(test_debounce);
+    RUN_TEST(test_removal_latency);
+    return UNITY_END();
+}
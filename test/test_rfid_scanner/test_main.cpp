@@ -0,0 +1,387 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de RfidScanner avec un lecteur PCD scripté
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rfid_scanner.h"
+
+// 🔎 Air-time model of the RC522 exchanges, for the inventory estimate:
+//    ISO 14443A at 106 kbit/s sends 9 bits per byte (parity) ~ 85 us, the
+//    tag answers ~90 us after the end of a frame, and each exchange costs
+//    about 100 us of register setup and FIFO access on the 10 MHz SPI.
+#define AIR_BYTE_US        85
+#define FDT_US             90
+#define SPI_FRAME_US       100
+#define BURST_TIMEOUT_US   5000        // RC522_TIMER_BURST: nobody answered
+
+static uint32_t frameUs(uint8_t txBytes, uint8_t rxBytes) {
+    return SPI_FRAME_US + (txBytes + rxBytes) * AIR_BYTE_US + FDT_US;
+}
+
+#define MAX_FIELD   12
+
+enum PiccState : uint8_t { PICC_IDLE, PICC_READY, PICC_READY_HALTED, PICC_ACTIVE, PICC_HALT };
+
+struct FakeTag {
+    TagUid    uid;
+    bool      inField;
+    bool      cached;            // pages already in tag_cache: no FAST_READ
+    PiccState state;
+};
+
+// Scripted field of ISO 14443-3 tags: the state transitions of each tag
+// follow REQA / WUPA / SELECT / HLTA, and every exchange adds its air time.
+class FakePcd : public RfidPcd {
+public:
+    FakeTag tags[MAX_FIELD];
+    uint8_t count = 0;
+    uint32_t airUs = 0;                 // estimated time of the exchanges so far
+
+    uint8_t add(const TagUid& uid) {
+        FakeTag& t = tags[count];
+        t.uid = uid;
+        t.inField = false;
+        t.cached = false;
+        t.state = PICC_IDLE;
+        return count++;
+    }
+    void place(uint8_t i) { tags[i].inField = true; tags[i].state = PICC_IDLE; }
+    void remove(uint8_t i) { tags[i].inField = false; tags[i].state = PICC_IDLE; }   // loses power
+
+    void request(bool wakeup) override { answered_ = wake(wakeup); }
+
+    RfidAnswer answer(uint32_t elapsedMs) override {
+        if (elapsedMs < 2) return RFID_ANSWER_PENDING;          // polling mode settle
+        return answered_ ? RFID_ANSWER_ATQA : RFID_ANSWER_NONE;
+    }
+
+    void burst(bool) override {}
+
+    // MFRC522 anticollision: at every collision the tags sending a 1 win
+    bool selectAny(TagUid* uid, uint8_t* sak) override {
+        bool cand[MAX_FIELD];
+        uint8_t left = 0;
+        for (uint8_t i = 0; i < count; ++i) {
+            cand[i] = ready(i);
+            left += cand[i];
+        }
+        if (!left) { spend(BURST_TIMEOUT_US); return false; }
+
+        uint8_t levels = tags[first(cand)].uid.len == 4 ? 1 : tags[first(cand)].uid.len == 7 ? 2 : 3;
+        for (uint8_t lvl = 0; lvl < levels; ++lvl) {
+            spend(frameUs(2, 5));                                // ANTICOLL
+            for (int bit = 0; bit < 32 && left > 1; ++bit) {
+                uint8_t ones = 0;
+                for (uint8_t i = 0; i < count; ++i) ones += cand[i] && cascadeBit(tags[i].uid, lvl, bit);
+                if (ones == 0 || ones == left) continue;
+                spend(frameUs(2 + bit / 8 + 1, 5 - bit / 8));   // resend with the known bits
+                for (uint8_t i = 0; i < count; ++i) {
+                    if (cand[i] && !cascadeBit(tags[i].uid, lvl, bit)) { cand[i] = false; left--; }
+                }
+            }
+            spend(frameUs(9, 3));                                // SELECT
+        }
+        uint8_t w = first(cand);
+        activate(w);
+        *uid = tags[w].uid;
+        *sak = 0x00;                                             // NTAG21x
+        return true;
+    }
+
+    bool select(const TagUid& uid, uint8_t) override {
+        uint8_t levels = uid.len == 4 ? 1 : uid.len == 7 ? 2 : 3;
+        for (uint8_t i = 0; i < count; ++i) {
+            if (ready(i) && tags[i].uid == uid) {
+                spend(levels * frameUs(9, 3));
+                activate(i);
+                return true;
+            }
+        }
+        spend(BURST_TIMEOUT_US);
+        for (uint8_t i = 0; i < count; ++i) fallBack(i);
+        return false;
+    }
+
+    bool requestAgain() override {
+        if (wake(false)) return true;
+        spend(BURST_TIMEOUT_US);
+        return false;
+    }
+
+    bool readUser(RfidTag* tag) override {
+        for (uint8_t i = 0; i < count; ++i) {
+            if (tags[i].state != PICC_ACTIVE) continue;
+            if (!tags[i].cached) spend(frameUs(5, TIGERTAG_BYTES + 2));   // FAST_READ
+            memset(tag->user, i + 1, sizeof(tag->user));
+            tag->source = tags[i].cached ? 0 : 1;
+            return true;
+        }
+        return false;
+    }
+
+    void halt(bool wait) override {
+        spend(SPI_FRAME_US + (wait ? 4 * AIR_BYTE_US : 0));
+        for (uint8_t i = 0; i < count; ++i) {
+            if (tags[i].state == PICC_ACTIVE) tags[i].state = PICC_HALT;
+        }
+    }
+
+private:
+    bool answered_ = false;
+
+    void spend(uint32_t us) { airUs += us; }
+
+    bool ready(uint8_t i) const {
+        return tags[i].inField && (tags[i].state == PICC_READY || tags[i].state == PICC_READY_HALTED);
+    }
+
+    static uint8_t first(const bool* cand) {
+        uint8_t i = 0;
+        while (!cand[i]) i++;
+        return i;
+    }
+
+    bool wake(bool wakeup) {
+        spend(frameUs(1, 2));
+        bool any = false;
+        for (uint8_t i = 0; i < count; ++i) {
+            FakeTag& t = tags[i];
+            if (!t.inField) continue;
+            if (t.state == PICC_ACTIVE) { t.state = PICC_IDLE; continue; }     // unexpected frame, silent
+            if (t.state == PICC_IDLE) { t.state = PICC_READY; any = true; }
+            else if (wakeup && t.state == PICC_HALT) { t.state = PICC_READY_HALTED; any = true; }
+        }
+        return any;
+    }
+
+    // Tags that saw a SELECT for another UID go back where they came from
+    void fallBack(uint8_t i) {
+        if (tags[i].state == PICC_READY) tags[i].state = PICC_IDLE;
+        else if (tags[i].state == PICC_READY_HALTED) tags[i].state = PICC_HALT;
+    }
+
+    void activate(uint8_t w) {
+        for (uint8_t i = 0; i < count; ++i) {
+            if (i == w) tags[i].state = PICC_ACTIVE;
+            else fallBack(i);
+        }
+    }
+
+    // Bit of cascade level lvl as sent on air (CT 0x88 leads a level that
+    // does not hold the last bytes of the UID)
+    static bool cascadeBit(const TagUid& u, uint8_t lvl, int bit) {
+        uint8_t b[4];
+        uint8_t levels = u.len == 4 ? 1 : u.len == 7 ? 2 : 3;
+        uint8_t off = lvl * 3;
+        if (lvl + 1 < levels) {
+            b[0] = 0x88;
+            memcpy(b + 1, u.bytes + off, 3);
+        } else {
+            memcpy(b, u.bytes + off, 4);
+        }
+        return (b[bit / 8] >> (bit % 8)) & 1;    // LSB first
+    }
+};
+
+static uint32_t gRng;
+static uint32_t rnd() {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+// NTAG21x: 7-byte UID, manufacturer byte 0x04 first
+static TagUid ntagUid() {
+    uint8_t b[7] = { 0x04 };
+    for (int i = 1; i < 7; ++i) b[i] = (uint8_t)rnd();
+    return TagUid(b, 7);
+}
+
+struct Events {
+    uint8_t arrived = 0;
+    uint8_t removed = 0;
+    TagUid lastArrived;
+    TagUid lastRemoved;
+    uint32_t lastRemovedMs = 0;
+};
+
+static uint32_t gNow;
+
+// loop() calls rfidPoll() about every millisecond
+static void run(RfidScanner& s, FakePcd& pcd, Events& ev, uint32_t ms) {
+    for (uint32_t end = gNow + ms; gNow < end; ++gNow) {
+        RfidTag tag;
+        switch (s.poll(gNow, pcd, &tag)) {
+            case RFID_EVT_ARRIVED: ev.arrived++; ev.lastArrived = tag.uid; break;
+            case RFID_EVT_REMOVED: ev.removed++; ev.lastRemoved = tag.uid; ev.lastRemovedMs = gNow; break;
+            default: break;
+        }
+    }
+}
+
+void setUp() {
+    gRng = 0x6A09E667u;
+    gNow = 1000;
+}
+void tearDown() {}
+
+void test_single_tag() {
+    RfidScanner s;
+    FakePcd pcd;
+    Events ev;
+    s.begin(gNow);
+    uint8_t a = pcd.add(ntagUid());
+
+    run(s, pcd, ev, 1000);
+    TEST_ASSERT_EQUAL(0, ev.arrived);
+
+    pcd.place(a);
+    run(s, pcd, ev, RFID_POLL_IDLE_MS + 10);
+    TEST_ASSERT_EQUAL(1, ev.arrived);
+    TEST_ASSERT_TRUE(ev.lastArrived == pcd.tags[a].uid);
+    TEST_ASSERT_EQUAL(1, s.tagCount());
+    TEST_ASSERT_TRUE(s.tagAt(0)->hasUser);
+    TEST_ASSERT_EQUAL(PICC_HALT, pcd.tags[a].state);
+
+    run(s, pcd, ev, 10000);                         // probes keep answering
+    TEST_ASSERT_EQUAL(1, ev.arrived);
+    TEST_ASSERT_EQUAL(0, ev.removed);
+
+    // A spool taken off moves the weight: fast polling, ~1 s to the event
+    pcd.remove(a);
+    uint32_t removedAt = gNow;
+    s.noteWeight(0.0f, gNow);
+    s.noteWeight(800.0f, gNow);
+    run(s, pcd, ev, 3000);
+    TEST_ASSERT_EQUAL(1, ev.removed);
+    TEST_ASSERT_TRUE(ev.lastRemoved == pcd.tags[a].uid);
+    TEST_ASSERT_EQUAL(0, s.tagCount());
+    TEST_ASSERT_TRUE(ev.lastRemovedMs - removedAt <= 1200);
+}
+
+void test_tray_of_eight() {
+    RfidScanner s;
+    FakePcd pcd;
+    Events ev;
+    s.begin(gNow);
+    for (int i = 0; i < RFID_MAX_TAGS; ++i) pcd.place(pcd.add(ntagUid()));
+
+    run(s, pcd, ev, RFID_POLL_IDLE_MS + 20);
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS, ev.arrived);    // one ARRIVED per poll
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS, s.tagCount());
+    for (uint8_t i = 0; i < pcd.count; ++i) {
+        bool inSet = false;
+        for (uint8_t j = 0; j < s.tagCount(); ++j) inSet |= s.tagAt(j)->uid == pcd.tags[i].uid;
+        TEST_ASSERT_TRUE(inSet);
+        TEST_ASSERT_EQUAL(PICC_HALT, pcd.tags[i].state);
+    }
+
+    run(s, pcd, ev, 20000);                         // every tag probed in turn, none lost
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS, ev.arrived);
+    TEST_ASSERT_EQUAL(0, ev.removed);
+
+    pcd.remove(3);
+    run(s, pcd, ev, 2 * RFID_MAX_TAGS * RFID_REMOVE_MISSES * RFID_POLL_IDLE_MS);
+    TEST_ASSERT_EQUAL(1, ev.removed);
+    TEST_ASSERT_TRUE(ev.lastRemoved == pcd.tags[3].uid);
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS - 1, s.tagCount());
+}
+
+void test_set_full_then_room() {
+    RfidScanner s;
+    FakePcd pcd;
+    Events ev;
+    s.begin(gNow);
+    for (int i = 0; i < RFID_MAX_TAGS + 1; ++i) pcd.place(pcd.add(ntagUid()));
+
+    run(s, pcd, ev, RFID_POLL_IDLE_MS + 20);
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS, ev.arrived);
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS, s.tagCount());
+
+    // The one left out is still IDLE and answers every REQA; it gets in
+    // once a tag of the set is removed
+    uint8_t gone = 0;
+    while (pcd.tags[gone].state != PICC_HALT) gone++;
+    pcd.remove(gone);
+    run(s, pcd, ev, 2 * RFID_MAX_TAGS * RFID_REMOVE_MISSES * RFID_POLL_IDLE_MS);
+    TEST_ASSERT_EQUAL(1, ev.removed);
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS + 1, ev.arrived);
+    TEST_ASSERT_EQUAL(RFID_MAX_TAGS, s.tagCount());
+}
+
+void test_newcomer_and_power_blip() {
+    RfidScanner s;
+    FakePcd pcd;
+    Events ev;
+    s.begin(gNow);
+    uint8_t a = pcd.add(ntagUid());
+    uint8_t b = pcd.add(ntagUid());
+    pcd.place(a);
+    run(s, pcd, ev, 1000);
+    TEST_ASSERT_EQUAL(1, ev.arrived);
+
+    // Added next to the present one: found by the interleaved REQA slots
+    pcd.place(b);
+    run(s, pcd, ev, 2 * RFID_POLL_IDLE_MS + 10);
+    TEST_ASSERT_EQUAL(2, ev.arrived);
+    TEST_ASSERT_TRUE(ev.lastArrived == pcd.tags[b].uid);
+
+    // Lifted and put back between two probes: the tag powers up IDLE and
+    // answers REQA, but it is already in the set, so no new event
+    pcd.remove(a);
+    pcd.place(a);
+    run(s, pcd, ev, 5000);
+    TEST_ASSERT_EQUAL(2, ev.arrived);
+    TEST_ASSERT_EQUAL(0, ev.removed);
+    TEST_ASSERT_EQUAL(2, s.tagCount());
+}
+
+// 🔎 Throughput goal: 4-8 tags placed together enumerated in under 100 ms.
+//    The time is the air-time model above summed over the exchanges of the
+//    inventory burst (anticollision rounds depend on the UIDs), worst case
+//    over random trays. An estimate: on the board, the serial log prints the
+//    measured "[RFID] inventory: N new tags in X us".
+void test_inventory_time_estimate() {
+    char msg[120];
+    for (int tags = 4; tags <= RFID_MAX_TAGS; tags += 4) {
+        for (int cached = 0; cached <= 1; ++cached) {
+            uint32_t worstUs = 0;
+            for (int run = 0; run < 200; ++run) {
+                RfidScanner s;
+                FakePcd pcd;
+                s.begin(0);
+                for (int i = 0; i < tags; ++i) {
+                    uint8_t k = pcd.add(ntagUid());
+                    pcd.tags[k].cached = cached;
+                    pcd.place(k);
+                }
+                RfidTag tag;
+                s.poll(0, pcd, &tag);                    // REQA armed
+                pcd.airUs = 0;
+                TEST_ASSERT_EQUAL(RFID_EVT_ARRIVED, s.poll(5, pcd, &tag));
+                TEST_ASSERT_EQUAL(tags, s.lastInventory().found);
+                if (pcd.airUs > worstUs) worstUs = pcd.airUs;
+            }
+            snprintf(msg, sizeof(msg), "inventory of %d tags (%s): %.1f ms worst case (estimate)",
+                     tags, cached ? "pages cached" : "FAST_READ", worstUs / 1000.0);
+            TEST_MESSAGE(msg);
+            TEST_ASSERT_TRUE(worstUs < 100000);
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_tag);
+    RUN_TEST(test_tray_of_eight);
+    RUN_TEST(test_set_full_then_room);
+    RUN_TEST(test_newcomer_and_power_blip);
+    RUN_TEST(test_inventory_time_estimate);
+    return UNITY_END();
+}
@@ -0,0 +1,209 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de la sérialisation /api/status (+ mesure)
+ */
+
+#include <unity.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "status_json.h"
+
+static StatusSnapshot gSnap;
+
+// Largest realistic snapshot: every string field filled to capacity
+static void fillSnapshot(StatusSnapshot& s) {
+    memset(&s, 0, sizeof(s));
+    s.weight = 1234;
+    s.smoothWeight = 1233;
+    s.rawWeight = 1233.456f;
+    s.hold = true;
+    s.holdWeight = 1234;
+    s.cloudOK = true;
+    s.apiValid = true;
+    s.calibrationFactor = 406.25f;
+    s.uptimeMs = 4000000000u;
+    memset(s.uid, '9', sizeof(s.uid) - 1);
+    memset(s.uidHex, 'F', sizeof(s.uidHex) - 1);
+    memset(s.wifi, 'w', sizeof(s.wifi) - 1);
+    strcpy(s.ip, "192.168.100.200");
+    memset(s.mdns, 'm', sizeof(s.mdns) - 1);
+    memset(s.apiKey, 'k', sizeof(s.apiKey) - 1);
+    memset(s.displayName, '"', sizeof(s.displayName) - 1);   // worst case: every char escaped
+    strcpy(s.sendToCloud, "success");
+    s.spoolValid = true;
+    s.materialId = 65535;
+    s.nominalG = 4000000000u;
+    s.tareG = 65535;
+    s.hasNet = true;
+    s.netG = -2147483647;
+    s.tagCount = 8;
+}
+
+void setUp() { fillSnapshot(gSnap); }
+void tearDown() {}
+
+void test_small_snapshot() {
+    StatusSnapshot s;
+    memset(&s, 0, sizeof(s));
+    s.weight = -3;
+    s.rawWeight = -2.5f;
+    strcpy(s.uid, "1234");
+    strcpy(s.displayName, "a\"b\\c\n");
+    s.calibrationFactor = 406.0f;
+    char out[STATUS_JSON_MAX];
+    size_t n = statusSerialize(s, SF_WEIGHT | SF_RAW_WEIGHT | SF_UID | SF_DISPLAY_NAME | SF_CALIBRATION | SF_SPOOL,
+                               out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("{\"weight\":-3,\"rawWeight\":-2.50,\"uid\":\"1234\","
+                             "\"displayName\":\"a\\\"b\\\\c\\u000a\",\"calibrationFactor\":406.0000,"
+                             "\"spool\":null}", out);
+    TEST_ASSERT_EQUAL(strlen(out), n);
+}
+
+void test_worst_case_fits() {
+    char out[STATUS_JSON_MAX];
+    size_t n = statusSerialize(gSnap, SF_ALL, out, sizeof(out));
+    TEST_ASSERT_GREATER_THAN(0, n);
+    TEST_ASSERT_EQUAL(strlen(out), n);
+    char msg[48];
+    snprintf(msg, sizeof(msg), "worst case %u of %u bytes", (unsigned)n, (unsigned)STATUS_JSON_MAX);
+    TEST_MESSAGE(msg);
+}
+
+void test_overflow_returns_zero() {
+    char out[STATUS_JSON_MAX];
+    size_t full = statusSerialize(gSnap, SF_ALL, out, sizeof(out));
+    for (size_t cap = 1; cap <= full; ++cap) {
+        out[0] = 'x';
+        TEST_ASSERT_EQUAL(0, statusSerialize(gSnap, SF_ALL, out, cap));
+        TEST_ASSERT_EQUAL_CHAR('\0', out[0]);
+    }
+    TEST_ASSERT_EQUAL(full, statusSerialize(gSnap, SF_ALL, out, full + 1));
+}
+
+static void fillTags(TagSnap* tags, uint8_t n) {
+    for (uint8_t i = 0; i < n; ++i) {
+        uint8_t b[10];
+        memset(b, 0xFF, sizeof(b));                     // longest decimal UID
+        b[9] = i;
+        memset(&tags[i], 0, sizeof(tags[i]));
+        tags[i].uid = TagUid(b, sizeof(b));
+        tags[i].info.valid = true;
+        tags[i].info.materialId = 65535;
+        tags[i].info.nominalG = 4000000000u;
+        tags[i].info.tareG = 65535;
+        tags[i].netG = -2147483647;
+    }
+}
+
+void test_tags_format() {
+    TagSnap tags[2];
+    fillTags(tags, 2);
+    const uint8_t b[4] = { 0x01, 0x02, 0x03, 0x04 };
+    tags[0].uid = TagUid(b, 4);
+    tags[0].info.materialId = 38219;
+    tags[0].info.nominalG = 1000;
+    tags[0].info.tareG = 0;
+    tags[0].netG = 250;
+    tags[1].info.valid = false;
+    char out[512];
+    TEST_ASSERT_GREATER_THAN(0, tagsSerialize(tags, 2, true, out, sizeof(out)));
+    char expected[256];
+    snprintf(expected, sizeof(expected),
+             "{\"count\":2,\"apportioned\":true,\"tags\":[{\"uid\":\"%s\",\"material\":38219,"
+             "\"nominal\":1000,\"tare\":null,\"net\":250},{\"uid\":\"%s\",\"material\":null,"
+             "\"tare\":null,\"net\":null}]}", TagUidDec(tags[0].uid).str, TagUidDec(tags[1].uid).str);
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+    TEST_ASSERT_GREATER_THAN(0, tagsSerialize(tags, 0, false, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("{\"count\":0,\"apportioned\":false,\"tags\":[]}", out);
+}
+
+// Every cap from 1 to the full length: 0 and nothing written past cap (ASan
+// sees the exact-size heap block)
+void test_tags_worst_case_and_overflow() {
+    const uint8_t kTags = 8;
+    TagSnap tags[kTags];
+    fillTags(tags, kTags);
+    char big[64 + kTags * TAGS_JSON_ENTRY_MAX];
+    size_t full = tagsSerialize(tags, kTags, true, big, sizeof(big));
+    TEST_ASSERT_GREATER_THAN(0, full);
+    TEST_ASSERT_EQUAL(strlen(big), full);
+    for (size_t cap = 1; cap <= full; ++cap) {
+        char* out = new char[cap];
+        TEST_ASSERT_EQUAL(0, tagsSerialize(tags, kTags, true, out, cap));
+        TEST_ASSERT_EQUAL_CHAR('\0', out[0]);
+        delete[] out;
+    }
+}
+
+void test_non_finite_floats_are_null() {
+    const float bad[] = { NAN, INFINITY, -INFINITY, 1e30f, -1e16f };
+    for (float f : bad) {
+        gSnap.rawWeight = f;
+        gSnap.calibrationFactor = f;
+        char out[128];
+        statusSerialize(gSnap, SF_RAW_WEIGHT | SF_CALIBRATION, out, sizeof(out));
+        TEST_ASSERT_EQUAL_STRING("{\"rawWeight\":null,\"calibrationFactor\":null}", out);
+    }
+    gSnap.rawWeight = 9.99e14f;
+    char out[128];
+    TEST_ASSERT_GREATER_THAN(0, statusSerialize(gSnap, SF_RAW_WEIGHT, out, sizeof(out)));
+}
+
+void test_parse_fields() {
+    TEST_ASSERT_EQUAL_HEX32(SF_ALL, statusParseFields(nullptr));
+    TEST_ASSERT_EQUAL_HEX32(SF_ALL, statusParseFields(""));
+    TEST_ASSERT_EQUAL_HEX32(SF_WEIGHT | SF_UID | SF_TAGS, statusParseFields("weight,uid,nope,tags"));
+    TEST_ASSERT_EQUAL_HEX32(0, statusParseFields("weigh,uids"));
+}
+
+void test_diff() {
+    StatusSnapshot b = gSnap;
+    TEST_ASSERT_EQUAL_HEX32(0, statusDiff(gSnap, b));
+    b.weight++;
+    b.uptimeMs += 10;
+    b.netG = 0;
+    TEST_ASSERT_EQUAL_HEX32(SF_WEIGHT | SF_UPTIME_MS | SF_SPOOL, statusDiff(gSnap, b));
+    b.uptimeMs += 1000;
+    TEST_ASSERT_TRUE(statusDiff(gSnap, b) & SF_UPTIME_S);
+}
+
+// Serializer cost for the full and the WebSocket-delta field sets. Reported
+// only (host figures); compare run to run to spot regressions.
+void test_benchmark() {
+    const int kRuns = 200000;
+    const uint32_t sets[] = { SF_ALL, SF_WEIGHT | SF_SPOOL };
+    const char* names[] = { "full", "delta weight+spool" };
+    char out[STATUS_JSON_MAX];
+    for (int k = 0; k < 2; ++k) {
+        size_t bytes = 0;
+        clock_t t0 = clock();
+        for (int r = 0; r < kRuns; ++r) {
+            gSnap.weight = r;
+            bytes += statusSerialize(gSnap, sets[k], out, sizeof(out));
+        }
+        double s = (double)(clock() - t0) / CLOCKS_PER_SEC;
+        TEST_ASSERT_GREATER_THAN(0, bytes);
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s: %.3f us per body, %u bytes (host)",
+                 names[k], s * 1e6 / kRuns, (unsigned)(bytes / kRuns));
+        TEST_MESSAGE(msg);
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_small_snapshot);
+    RUN_TEST(test_worst_case_fits);
+    RUN_TEST(test_overflow_returns_zero);
+    RUN_TEST(test_tags_format);
+    RUN_TEST(test_tags_worst_case_and_overflow);
+    RUN_TEST(test_non_finite_floats_are_null);
+    RUN_TEST(test_parse_fields);
+    RUN_TEST(test_diff);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,188 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Compteur d'allocations : une lecture de tag ne touche pas le tas
+ *
+ * operator new est remplacé par une version qui compte les appels. Le
+ * parcours d'un tag (anticollision et lecture par RfidScanner, copie de
+ * RfidTag, décodage TigerTag, net, formatage et comparaison du TagUid)
+ * doit laisser le compteur à 0.
+ *
+ * Hors périmètre : broadcastTagEvent() (main.cpp) passe par
+ * AsyncWebSocket::textAll(), qui alloue un tampon de message par envoi, et
+ * tagCacheStore() réécrit le fichier LittleFS quand un contenu nouveau
+ * entre dans le cache. Ni l'un ni l'autre n'est construit sur le poste.
+ */
+
+#include <unity.h>
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rfid_scanner.h"
+#include "tag_uid.h"
+#include "tigertag.h"
+
+static size_t gAllocs = 0;
+
+void* operator new(size_t n) {
+    gAllocs++;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    gAllocs++;
+    return malloc(n ? n : 1);
+}
+void* operator new[](size_t n, const std::nothrow_t& t) noexcept { return operator new(n, t); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// PLA 1 kg, tare 250 g (same layout as test_tigertag)
+static const uint8_t kSpool[TIGERTAG_BYTES] = {
+    0xBC, 0x0F, 0xCB, 0x97, 0x00, 0x01, 0x23, 0x45, 0x00, 0x26, 0x68, 0x00,
+    0x8E, 0x38, 0x00, 0x2A, 0xFF, 0x66, 0x00, 0xFF, 0x00, 0x03, 0xE8, 0x01,
+    0x00, 0xBE, 0x00, 0xDC, 0x32, 0x04, 0x00, 0x00, 0x65, 0x4F, 0x2A, 0x00,
+    0x00, 0xFA, 0x00, 0x00,
+};
+
+// Tags in the field answer in order; no air-time or collision model (see
+// test_rfid_scanner for that), only the calls the read path makes
+class ListPcd : public RfidPcd {
+public:
+    TagUid uids[4];
+    bool inField[4] = {};
+    bool halted[4] = {};
+    uint8_t count = 0;
+    int8_t active = -1;
+
+    void request(bool wakeup) override { answered_ = wake(wakeup); }
+    RfidAnswer answer(uint32_t elapsedMs) override {
+        if (elapsedMs < 2) return RFID_ANSWER_PENDING;
+        return answered_ ? RFID_ANSWER_ATQA : RFID_ANSWER_NONE;
+    }
+    void burst(bool) override {}
+    bool selectAny(TagUid* uid, uint8_t* sak) override {
+        for (uint8_t i = 0; i < count; ++i) {
+            if (ready_[i]) { active = i; *uid = uids[i]; *sak = 0x00; clearReady(); return true; }
+        }
+        return false;
+    }
+    bool select(const TagUid& uid, uint8_t) override {
+        for (uint8_t i = 0; i < count; ++i) {
+            if (ready_[i] && uids[i] == uid) { active = i; clearReady(); return true; }
+        }
+        clearReady();
+        return false;
+    }
+    bool requestAgain() override { return wake(false); }
+    bool readUser(RfidTag* tag) override {
+        memcpy(tag->user, kSpool, sizeof(tag->user));
+        tag->source = 1;
+        return true;
+    }
+    void halt(bool) override {
+        if (active >= 0) halted[active] = true;
+        active = -1;
+    }
+
+private:
+    bool answered_ = false;
+    bool ready_[4] = {};
+
+    bool wake(bool wakeup) {
+        bool any = false;
+        for (uint8_t i = 0; i < count; ++i) {
+            ready_[i] = inField[i] && (!halted[i] || wakeup);
+            any |= ready_[i];
+        }
+        return any;
+    }
+    void clearReady() { memset(ready_, 0, sizeof(ready_)); }
+};
+
+// What main.cpp does with an ARRIVED / REMOVED tag, minus the WebSocket
+// broadcast: decode, net weight, decimal UID for the log and JSON, compare
+// with the current UID
+static uint32_t consume(const RfidTag& tag, TagUid& current) {
+    TigerTagInfo info;
+    int32_t net = 0;
+    if (tag.hasUser && tigertagDecode(tag.user, sizeof(tag.user), &info)) {
+        tigertagNetGrams(info, 1012.0f, &net);
+    }
+    TagUidDec dec(tag.uid);
+    TagUidHex hex(tag.uid);
+    uint32_t h = tag.uid.hash();
+    if (tag.uid != current) current = tag.uid;
+    return (uint32_t)net + (uint8_t)dec.str[0] + (uint8_t)hex.str[0] + h;
+}
+
+void setUp() { gAllocs = 0; }
+void tearDown() {}
+
+void test_counter_works() {
+    void* p = ::operator new(sizeof(int));     // not a new-expression: cannot be elided
+    ::operator delete(p);
+    TEST_ASSERT_EQUAL(1, gAllocs);
+}
+
+void test_uid_formatting() {
+    const uint8_t b[7] = { 0x04, 0xA1, 0xB2, 0xC3, 0xD4, 0xE5, 0xF6 };
+    gAllocs = 0;
+    TagUid u(b, sizeof(b));
+    char dec[TAG_UID_DEC_LEN], hex[TAG_UID_HEX_LEN];
+    TEST_ASSERT_TRUE(u.toDec(dec, sizeof(dec)) > 0);
+    TEST_ASSERT_EQUAL(14, u.toHex(hex, sizeof(hex)));
+    TEST_ASSERT_EQUAL_STRING("04A1B2C3D4E5F6", hex);
+    TagUid copy = u;
+    TEST_ASSERT_TRUE(copy == u);
+    TEST_ASSERT_EQUAL_UINT32(u.hash(), copy.hash());
+    TEST_ASSERT_EQUAL_STRING(dec, TagUidDec(copy).str);
+    TEST_ASSERT_EQUAL(0, gAllocs);
+}
+
+void test_read_path() {
+    static RfidScanner s;                       // built before counting, as the firmware's static
+    static ListPcd pcd;
+    const uint8_t b[3][7] = {
+        { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 },
+        { 0x04, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC },
+        { 0x04, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 },
+    };
+    for (uint8_t i = 0; i < 3; ++i) pcd.uids[i] = TagUid(b[i], 7);
+    pcd.count = 3;
+    TagUid current;
+    s.begin(0);
+
+    gAllocs = 0;
+    uint32_t sink = 0;
+    uint8_t arrived = 0, removed = 0;
+    for (uint32_t now = 0; now < 30000; ++now) {
+        if (now == 1000) pcd.inField[0] = true;
+        if (now == 5000) { pcd.inField[1] = pcd.inField[2] = true; }
+        if (now == 15000) { pcd.inField[1] = false; pcd.halted[1] = false; }
+        RfidTag tag;
+        switch (s.poll(now, pcd, &tag)) {
+            case RFID_EVT_ARRIVED: arrived++; sink += consume(tag, current); break;
+            case RFID_EVT_REMOVED: removed++; sink += consume(tag, current); break;
+            default: break;
+        }
+        if (const RfidTag* t = s.tagAt(0)) sink += t->uid.len;
+    }
+    TEST_ASSERT_EQUAL(3, arrived);
+    TEST_ASSERT_EQUAL(1, removed);
+    TEST_ASSERT_TRUE(sink != 0);
+    TEST_ASSERT_EQUAL(0, gAllocs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_works);
+    RUN_TEST(test_uid_formatting);
+    RUN_TEST(test_read_path);
+    return UNITY_END();
+}
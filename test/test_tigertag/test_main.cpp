@@ -0,0 +1,167 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte du décodeur TigerTag (dumps de pages 4..13)
+ */
+
+#include <unity.h>
+
+#include <string.h>
+
+#include "tigertag.h"
+
+// 🔎 Dumps as fastReadPages() returns them: pages 4..13, four bytes per page
+static const uint8_t kBlank[TIGERTAG_BYTES] = { 0 };
+
+// PLA, 1000 g expressed in grams, RGBA FF6600FF, nozzle 190-220 °C,
+// drying 50 °C / 4 h, empty spool 250 g
+static const uint8_t kGrams[TIGERTAG_BYTES] = {
+    0xBC, 0x0F, 0xCB, 0x97,     // 4  format
+    0x00, 0x01, 0x23, 0x45,     // 5  product
+    0x00, 0x26, 0x68, 0x00,     // 6  material, aspect 1, aspect 2
+    0x8E, 0x38, 0x00, 0x2A,     // 7  type, diameter, brand
+    0xFF, 0x66, 0x00, 0xFF,     // 8  colour
+    0x00, 0x03, 0xE8, 0x01,     // 9  1000, unit g
+    0x00, 0xBE, 0x00, 0xDC,     // 10 nozzle 190 / 220
+    0x32, 0x04, 0x00, 0x00,     // 11 dry 50 °C, 4 h
+    0x65, 0x4F, 0x2A, 0x00,     // 12 timestamp
+    0x00, 0xFA, 0x00, 0x00,     // 13 tare 250 g
+};
+
+// PETG, 2 kg expressed in kilograms, no tare on the tag
+static const uint8_t kKilograms[TIGERTAG_BYTES] = {
+    0xBC, 0x0F, 0xCB, 0x97,
+    0x00, 0x01, 0x67, 0x89,
+    0x00, 0x3C, 0x00, 0x00,
+    0x8E, 0x38, 0x00, 0x11,
+    0x20, 0x20, 0x20, 0xFF,
+    0x00, 0x00, 0x02, 0x02,     // 2, unit kg
+    0x00, 0xE6, 0x00, 0xFA,
+    0x41, 0x06, 0x00, 0x00,
+    0x65, 0x4F, 0x2A, 0x00,
+    0x00, 0x00, 0x00, 0x00,     // tare not set
+};
+
+// Nominal weight far beyond any spool: 25 kg
+static const uint8_t kOversize[TIGERTAG_BYTES] = {
+    0xBC, 0x0F, 0xCB, 0x97,
+    0x00, 0x00, 0x00, 0x01,
+    0x00, 0x26, 0x00, 0x00,
+    0x8E, 0x38, 0x00, 0x2A,
+    0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x00, 0x19, 0x02,     // 25, unit kg
+    0x00, 0xBE, 0x00, 0xDC,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0xFA, 0x00, 0x00,
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_blank() {
+    TigerTagInfo info;
+    TEST_ASSERT_FALSE(tigertagDecode(kBlank, sizeof(kBlank), &info));
+    TEST_ASSERT_FALSE(info.valid);
+
+    uint8_t erased[TIGERTAG_BYTES];
+    memset(erased, 0xFF, sizeof(erased));
+    TEST_ASSERT_FALSE(tigertagDecode(erased, sizeof(erased), &info));
+    TEST_ASSERT_FALSE(tigertagDecode(nullptr, TIGERTAG_BYTES, &info));
+}
+
+void test_grams() {
+    TigerTagInfo info;
+    TEST_ASSERT_TRUE(tigertagDecode(kGrams, sizeof(kGrams), &info));
+    TEST_ASSERT_TRUE(info.valid);
+    TEST_ASSERT_EQUAL_HEX32(0xBC0FCB97, info.formatId);
+    TEST_ASSERT_EQUAL_HEX32(0x00012345, info.productId);
+    TEST_ASSERT_EQUAL(0x26, info.materialId);
+    TEST_ASSERT_EQUAL(0x68, info.aspect1);
+    TEST_ASSERT_EQUAL(0x8E, info.typeId);
+    TEST_ASSERT_EQUAL(0x38, info.diameterId);
+    TEST_ASSERT_EQUAL(0x2A, info.brandId);
+    TEST_ASSERT_EQUAL_HEX32(0xFF6600FF, info.colorRgba);
+    TEST_ASSERT_EQUAL_UINT32(1000, info.nominalG);
+    TEST_ASSERT_EQUAL(190, info.nozzleMinC);
+    TEST_ASSERT_EQUAL(220, info.nozzleMaxC);
+    TEST_ASSERT_EQUAL(50, info.dryTempC);
+    TEST_ASSERT_EQUAL(4, info.dryHours);
+    TEST_ASSERT_EQUAL_HEX32(0x654F2A00, info.timestamp);
+    TEST_ASSERT_EQUAL(250, info.tareG);
+
+    int32_t net = -1;
+    TEST_ASSERT_TRUE(tigertagNetGrams(info, 1012.6f, &net));
+    TEST_ASSERT_EQUAL_INT32(763, net);
+    TEST_ASSERT_TRUE(tigertagNetGrams(info, 240.0f, &net));     // scale noise on an empty spool
+    TEST_ASSERT_EQUAL_INT32(0, net);
+}
+
+void test_kilograms() {
+    TigerTagInfo info;
+    TEST_ASSERT_TRUE(tigertagDecode(kKilograms, sizeof(kKilograms), &info));
+    TEST_ASSERT_EQUAL_UINT32(2000, info.nominalG);
+    TEST_ASSERT_EQUAL(0, info.tareG);
+
+    int32_t net = 1234;
+    TEST_ASSERT_FALSE(tigertagNetGrams(info, 1500.0f, &net));    // no tare: nothing to subtract
+    TEST_ASSERT_EQUAL_INT32(1234, net);
+
+    uint8_t unknownUnit[TIGERTAG_BYTES];
+    memcpy(unknownUnit, kKilograms, sizeof(unknownUnit));
+    unknownUnit[(9 - TIGERTAG_FIRST_PAGE) * 4 + 3] = 3;           // length-based
+    TEST_ASSERT_TRUE(tigertagDecode(unknownUnit, sizeof(unknownUnit), &info));
+    TEST_ASSERT_EQUAL_UINT32(0, info.nominalG);
+}
+
+void test_truncated() {
+    TigerTagInfo info;
+    for (size_t len = 0; len < TIGERTAG_BYTES; ++len) {
+        TEST_ASSERT_FALSE(tigertagDecode(kGrams, len, &info));
+        TEST_ASSERT_FALSE(info.valid);
+    }
+}
+
+void test_oversize() {
+    TigerTagInfo info;
+    TEST_ASSERT_FALSE(tigertagDecode(kOversize, sizeof(kOversize), &info));
+    TEST_ASSERT_FALSE(info.valid);
+
+    uint8_t heavyTare[TIGERTAG_BYTES];
+    memcpy(heavyTare, kGrams, sizeof(heavyTare));
+    heavyTare[(13 - TIGERTAG_FIRST_PAGE) * 4]     = 0xFF;         // 65535 g
+    heavyTare[(13 - TIGERTAG_FIRST_PAGE) * 4 + 1] = 0xFF;
+    TEST_ASSERT_FALSE(tigertagDecode(heavyTare, sizeof(heavyTare), &info));
+}
+
+void test_apportion() {
+    TigerTagInfo infos[2];
+    TEST_ASSERT_TRUE(tigertagDecode(kGrams, sizeof(kGrams), &infos[0]));
+    TEST_ASSERT_TRUE(tigertagDecode(kGrams, sizeof(kGrams), &infos[1]));
+    infos[1].nominalG = 3000;
+
+    int32_t net[2] = { -1, -1 };
+    TEST_ASSERT_TRUE(tigertagApportion(infos, 2, 2500.0f, net));  // 2000 g left, split 1:3
+    TEST_ASSERT_EQUAL_INT32(500, net[0]);
+    TEST_ASSERT_EQUAL_INT32(1500, net[1]);
+
+    TEST_ASSERT_TRUE(tigertagApportion(infos, 2, 100.0f, net));   // less than both tares
+    TEST_ASSERT_EQUAL_INT32(0, net[0]);
+    TEST_ASSERT_EQUAL_INT32(0, net[1]);
+
+    TEST_ASSERT_TRUE(tigertagDecode(kKilograms, sizeof(kKilograms), &infos[1]));
+    net[0] = net[1] = 42;
+    TEST_ASSERT_FALSE(tigertagApportion(infos, 2, 2500.0f, net)); // one tag has no tare
+    TEST_ASSERT_EQUAL_INT32(42, net[0]);
+    TEST_ASSERT_FALSE(tigertagApportion(infos, 0, 2500.0f, net));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_blank);
+    RUN_TEST(test_grams);
+    RUN_TEST(test_kilograms);
+    RUN_TEST(test_truncated);
+    RUN_TEST(test_oversize);
+    RUN_TEST(test_apportion);
+    return UNITY_END();
+}
@@ -0,0 +1,255 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de HistoryStore (paliers, anneaux, min/max, LTTB)
+ */
+
+#include <unity.h>
+
+#include <math.h>
+#include <string.h>
+
+#include "history_store.h"
+
+static HistoryStore* gStore;
+
+static uint32_t gRng;
+static uint32_t rnd() {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+void setUp() {
+    gRng = 0xA54FF53Au;
+    gStore = new HistoryStore();
+}
+void tearDown() { delete gStore; }
+
+// loop() feeds about 10 filtered samples per second
+static void feed(uint32_t fromS, uint32_t toS, float (*f)(uint32_t ms)) {
+    for (uint32_t ms = fromS * 1000; ms < toS * 1000; ms += 100) gStore->addSample(f(ms), ms / 1000);
+}
+
+static float ramp(uint32_t ms) { return ms / 1000.0f; }
+static float flat(uint32_t) { return 500.0f; }
+static float noisy(uint32_t) { return 500.0f + (float)(rnd() % 21) - 10.0f; }
+
+static uint32_t count(uint8_t level) {
+    uint32_t oldest, head;
+    gStore->bounds(level, oldest, head);
+    return head - oldest;
+}
+
+static HistoryBucket bucketAt(uint8_t level, uint32_t idx) {
+    HistoryBucket b = {};
+    TEST_ASSERT_TRUE(gStore->readBucket(level, idx, b));
+    return b;
+}
+
+void test_bucket_committed_after_period() {
+    for (uint32_t ms = 0; ms < 1000; ms += 100) gStore->addSample(10.0f + ms / 100, 0);
+    TEST_ASSERT_EQUAL(0, count(0));                     // period still open
+    gStore->addSample(NAN, 1);                          // ignored, does not close it
+    TEST_ASSERT_EQUAL(0, count(0));
+    gStore->addSample(50.0f, 1);
+    TEST_ASSERT_EQUAL(1, count(0));
+    HistoryBucket b = bucketAt(0, 0);
+    TEST_ASSERT_EQUAL(0, b.t);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 14.5f, b.mean);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, b.min);
+    TEST_ASSERT_EQUAL_FLOAT(19.0f, b.max);
+}
+
+void test_tier_rollover() {
+    // A coarser bucket closes when the finer tier commits a bucket of the
+    // next period: minute 1 (60..119 s) needs the 120 s bucket, which needs
+    // a sample at 121 s
+    feed(0, 122, ramp);
+    TEST_ASSERT_EQUAL(121, count(0));                   // 0..120 (121 still open)
+    HistoryBucket b = bucketAt(0, 42);
+    TEST_ASSERT_EQUAL(42, b.t);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 42.45f, b.mean);
+    // 1 min tier: the first two minutes, each the mean of its 60 seconds
+    TEST_ASSERT_EQUAL(2, count(1));
+    b = bucketAt(1, 1);
+    TEST_ASSERT_EQUAL(60, b.t);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, 89.95f, b.mean);
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, b.min);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 119.9f, b.max);
+    // 10 min tier: nothing closed yet
+    TEST_ASSERT_EQUAL(0, count(2));
+
+    feed(122, 1262, ramp);
+    TEST_ASSERT_EQUAL(2, count(2));
+    b = bucketAt(2, 1);
+    TEST_ASSERT_EQUAL(600, b.t);
+    TEST_ASSERT_EQUAL_FLOAT(600.0f, b.min);
+    TEST_ASSERT_FLOAT_WITHIN(1e-2f, 1199.9f, b.max);
+    TEST_ASSERT_EQUAL(0, HistoryStore::tierStep(0) - 1);
+    TEST_ASSERT_EQUAL_STRING("10m", HistoryStore::tierName(2));
+}
+
+void test_gap_skips_periods() {
+    feed(0, 3, flat);
+    feed(10, 12, flat);                                 // scale idle or busy for 7 s
+    TEST_ASSERT_EQUAL(4, count(0));                     // 0, 1, 2, 10 (11 open)
+    TEST_ASSERT_EQUAL(10, bucketAt(0, 3).t);
+    TEST_ASSERT_EQUAL(3, gStore->lowerBound(0, 3));     // first bucket at or after 3 s is 10 s
+}
+
+void test_ring_wraparound() {
+    feed(0, 1000, flat);
+    // 1 s tier keeps the last HISTORY_T0_SLOTS seconds
+    uint32_t oldest, head;
+    gStore->bounds(0, oldest, head);
+    TEST_ASSERT_EQUAL(999, head);
+    TEST_ASSERT_EQUAL(999 - HISTORY_T0_SLOTS, oldest);
+    HistoryBucket b;
+    TEST_ASSERT_FALSE(gStore->readBucket(0, oldest - 1, b));   // overwritten
+    TEST_ASSERT_FALSE(gStore->readBucket(0, head, b));         // not written yet
+    TEST_ASSERT_EQUAL(oldest, bucketAt(0, oldest).t);
+    TEST_ASSERT_EQUAL(998, bucketAt(0, head - 1).t);
+
+    // Tier choice follows what each ring still holds
+    TEST_ASSERT_EQUAL(0, gStore->pickTier(oldest));
+    TEST_ASSERT_EQUAL(1, gStore->pickTier(oldest - 1));        // 1 min tier has not wrapped
+    TEST_ASSERT_EQUAL(oldest, gStore->lowerBound(0, 0));
+    TEST_ASSERT_EQUAL(head, gStore->lowerBound(0, 5000));
+
+    // Past the 1 min ring too (6 h): the 10 min tier answers
+    feed(1000, 1000 + HISTORY_T1_SLOTS * 60 + 120, flat);
+    TEST_ASSERT_EQUAL(HISTORY_T1_SLOTS, count(1));
+    TEST_ASSERT_EQUAL(2, gStore->pickTier(0));
+    TEST_ASSERT_EQUAL(1, gStore->pickTier(1000 + 600));
+}
+
+static uint32_t collect(HistoryQuery& q, HistoryBucket* out, uint32_t max) {
+    uint32_t n = 0;
+    HistoryBucket b;
+    while (historyQueryNext(*gStore, q, b)) {
+        TEST_ASSERT_TRUE(n < max);
+        out[n++] = b;
+    }
+    return n;
+}
+
+void test_raw_when_range_fits() {
+    feed(0, 101, ramp);
+    HistoryQuery q;
+    historyQueryBegin(*gStore, q, 10, 29, 50, HISTORY_LTTB, 100);
+    TEST_ASSERT_FALSE(q.decimate);
+    static HistoryBucket out[HISTORY_MAX_POINTS];
+    TEST_ASSERT_EQUAL(20, collect(q, out, HISTORY_MAX_POINTS));
+    TEST_ASSERT_EQUAL(10, out[0].t);
+    TEST_ASSERT_EQUAL(29, out[19].t);
+}
+
+void test_lttb_point_count_and_ends() {
+    feed(0, HISTORY_T0_SLOTS + 1, noisy);
+    static HistoryBucket out[HISTORY_MAX_POINTS];
+    const uint16_t sizes[] = { 3, 7, 50, 123, 299 };
+    for (uint16_t points : sizes) {
+        HistoryQuery q;
+        historyQueryBegin(*gStore, q, 0, HISTORY_T0_SLOTS, points, HISTORY_LTTB, HISTORY_T0_SLOTS);
+        TEST_ASSERT_EQUAL(HISTORY_T0_SLOTS, q.n);
+        TEST_ASSERT_TRUE(q.decimate);
+        uint32_t n = collect(q, out, HISTORY_MAX_POINTS);
+        TEST_ASSERT_EQUAL(points, n);
+        TEST_ASSERT_EQUAL(0, out[0].t);
+        TEST_ASSERT_EQUAL(HISTORY_T0_SLOTS - 1, out[n - 1].t);
+        for (uint32_t i = 1; i < n; ++i) TEST_ASSERT_TRUE(out[i].t > out[i - 1].t);   // real buckets, in order
+    }
+
+    // Fewer than 3 points: LTTB has no middle, the envelope is used
+    HistoryQuery q;
+    historyQueryBegin(*gStore, q, 0, HISTORY_T0_SLOTS, 2, HISTORY_LTTB, HISTORY_T0_SLOTS);
+    TEST_ASSERT_EQUAL(HISTORY_MINMAX, q.mode);
+    TEST_ASSERT_EQUAL(2, collect(q, out, HISTORY_MAX_POINTS));
+}
+
+void test_lttb_keeps_a_peak() {
+    // One-second spike in a flat line: the triangle through it is the largest
+    for (uint32_t s = 0; s <= 200; ++s) gStore->addSample(s == 137 ? 900.0f : 500.0f, s);
+    HistoryQuery q;
+    historyQueryBegin(*gStore, q, 0, 199, 20, HISTORY_LTTB, 200);
+    static HistoryBucket out[HISTORY_MAX_POINTS];
+    uint32_t n = collect(q, out, HISTORY_MAX_POINTS);
+    bool found = false;
+    for (uint32_t i = 0; i < n; ++i) found |= out[i].t == 137;
+    TEST_ASSERT_TRUE(found);
+}
+
+void test_minmax_preserves_spikes() {
+    // 100 ms spike and dip inside otherwise flat seconds
+    for (uint32_t ms = 0; ms < 300000; ms += 100) {
+        float g = 500.0f;
+        if (ms == 123400) g = 1500.0f;
+        if (ms == 234500) g = -40.0f;
+        gStore->addSample(g, ms / 1000);
+    }
+    gStore->addSample(500.0f, 300);
+    static HistoryBucket out[HISTORY_MAX_POINTS];
+    const uint16_t sizes[] = { 2, 10, 37, 299 };
+    for (uint16_t points : sizes) {
+        HistoryQuery q;
+        historyQueryBegin(*gStore, q, 0, 299, points, HISTORY_MINMAX, 300);
+        uint32_t n = collect(q, out, HISTORY_MAX_POINTS);
+        TEST_ASSERT_EQUAL(points, n);
+        float hi = -1e9f, lo = 1e9f;
+        for (uint32_t i = 0; i < n; ++i) {
+            if (out[i].max > hi) hi = out[i].max;
+            if (out[i].min < lo) lo = out[i].min;
+            TEST_ASSERT_TRUE(out[i].min <= out[i].mean && out[i].mean <= out[i].max);
+        }
+        TEST_ASSERT_EQUAL_FLOAT(1500.0f, hi);
+        TEST_ASSERT_EQUAL_FLOAT(-40.0f, lo);
+    }
+
+    // The spike also survives the roll-up into the 1 min and 10 min tiers
+    feed(301, 1201, flat);
+    TEST_ASSERT_EQUAL_FLOAT(1500.0f, bucketAt(1, 2).max);
+    TEST_ASSERT_EQUAL_FLOAT(-40.0f, bucketAt(1, 3).min);
+    TEST_ASSERT_EQUAL_FLOAT(1500.0f, bucketAt(2, 0).max);
+    TEST_ASSERT_EQUAL_FLOAT(-40.0f, bucketAt(2, 0).min);
+}
+
+void test_render_json() {
+    feed(0, 61, ramp);
+    HistoryQuery q;
+    historyQueryBegin(*gStore, q, 0, 59, 5, HISTORY_MINMAX, 60);
+    static char json[4096];
+    size_t len = 0;
+    while (historyQueryRender(*gStore, q)) {
+        TEST_ASSERT_TRUE(q.outLen < sizeof(q.out));
+        TEST_ASSERT_TRUE(len + q.outLen < sizeof(json));
+        memcpy(json + len, q.out, q.outLen);
+        len += q.outLen;
+    }
+    json[len] = '\0';
+    TEST_ASSERT_EQUAL_STRING_LEN("{\"tier\":\"1s\",\"step\":1,\"now\":60,\"from\":0,\"to\":59,\"mode\":\"minmax\",\"points\":[[0,",
+                                 json, 77);
+    TEST_ASSERT_NOT_NULL(strstr(json, ",[48,54.0,48.0,59.9]]"));     // group of 12 s: envelope + mean
+    TEST_ASSERT_EQUAL_STRING("],\"count\":5}", json + len - 12);
+
+    // Empty range
+    historyQueryBegin(*gStore, q, 5000, 6000, 100, HISTORY_LTTB, 60);
+    len = 0;
+    while (historyQueryRender(*gStore, q)) { memcpy(json + len, q.out, q.outLen); len += q.outLen; }
+    json[len] = '\0';
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"mode\":\"raw\",\"points\":[],\"count\":0}"));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_committed_after_period);
+    RUN_TEST(test_tier_rollover);
+    RUN_TEST(test_gap_skips_periods);
+    RUN_TEST(test_ring_wraparound);
+    RUN_TEST(test_raw_when_range_fits);
+    RUN_TEST(test_lttb_point_count_and_ends);
+    RUN_TEST(test_lttb_keeps_a_peak);
+    RUN_TEST(test_minmax_preserves_spikes);
+    RUN_TEST(test_render_json);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+/*
+ * @file test_main.cpp
+ * @brief TigerTagScale - Tests hôte de WsClientTable (stress avec clients simulés)
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ws_clients.h"
+
+#define FIELDS      20          // one bit per status field
+#define QUEUE_CAP   4           // frames a simulated client can hold before it counts as slow
+
+static uint32_t gRng;
+static uint32_t rnd() {
+    gRng ^= gRng << 13;
+    gRng ^= gRng >> 17;
+    gRng ^= gRng << 5;
+    return gRng;
+}
+
+void setUp() { gRng = 0x9E3779B9u; }
+void tearDown() {}
+
+void test_track_limits() {
+    WsClientTable t;
+    for (uint32_t id = 1; id <= WS_MAX_TRACKED_CLIENTS; ++id) TEST_ASSERT_TRUE(t.track(id));
+    TEST_ASSERT_TRUE(t.track(3));                       // already tracked
+    TEST_ASSERT_FALSE(t.track(100));
+    t.untrack(3);
+    TEST_ASSERT_TRUE(t.track(100));
+    uint32_t ids[WS_MAX_TRACKED_CLIENTS];
+    TEST_ASSERT_EQUAL(WS_MAX_TRACKED_CLIENTS, t.ids(ids));
+    TEST_ASSERT_EQUAL(WS_SEND_NONE, t.plan(3, 1, false).action);   // unknown client
+}
+
+void test_plan_coalesces() {
+    WsClientTable t;
+    t.track(7);
+    TEST_ASSERT_EQUAL(WS_SEND_SHARED, t.plan(7, 0x1, false).action);
+    TEST_ASSERT_EQUAL(WS_SEND_NONE, t.plan(7, 0, false).action);
+    TEST_ASSERT_EQUAL(WS_SEND_COALESCED, t.plan(7, 0x1, true).action);
+    TEST_ASSERT_EQUAL(WS_SEND_NONE, t.plan(7, 0, true).action);
+    TEST_ASSERT_EQUAL(WS_SEND_COALESCED, t.plan(7, 0x4, true).action);
+    TEST_ASSERT_EQUAL_HEX32(0x5, t.pending(7));
+    WsSendPlan p = t.plan(7, 0x8, false);
+    TEST_ASSERT_EQUAL(WS_SEND_CATCHUP, p.action);
+    TEST_ASSERT_EQUAL_HEX32(0xD, p.mask);
+    TEST_ASSERT_EQUAL_HEX32(0, t.pending(7));
+    t.plan(7, 0x2, true);
+    t.untrack(7);
+    t.track(7);                                          // reconnect: starts clean
+    TEST_ASSERT_EQUAL_HEX32(0, t.pending(7));
+}
+
+// Simulated browser: a FIFO of frames it has not read yet, and the field
+// versions it has applied
+struct Frame {
+    uint32_t mask;
+    uint32_t versions[FIELDS];
+};
+
+struct SimClient {
+    bool     connected;
+    uint32_t id;
+    uint8_t  drainPerTick;      // 0 = stalled (tab in background, bad Wi-Fi)
+    Frame    queue[QUEUE_CAP];
+    uint8_t  head, len, maxLen;
+    uint32_t view[FIELDS];
+    uint32_t frames;
+};
+
+static uint32_t gVersions[FIELDS];
+
+static void pushFrame(SimClient& c, uint32_t mask) {
+    TEST_ASSERT_TRUE_MESSAGE(c.len < QUEUE_CAP, "frame queued to a slow client");
+    Frame& f = c.queue[(c.head + c.len) % QUEUE_CAP];
+    f.mask = mask;
+    memcpy(f.versions, gVersions, sizeof(gVersions));
+    c.len++;
+    if (c.len > c.maxLen) c.maxLen = c.len;
+    c.frames++;
+}
+
+static void drain(SimClient& c, uint8_t n) {
+    while (n-- && c.len) {
+        const Frame& f = c.queue[c.head];
+        for (int b = 0; b < FIELDS; ++b) {
+            if (f.mask & (1u << b)) c.view[b] = f.versions[b];
+        }
+        c.head = (c.head + 1) % QUEUE_CAP;
+        c.len--;
+    }
+}
+
+static void connectClient(WsClientTable& t, SimClient& c, uint32_t id) {
+    memset(&c, 0, sizeof(c));
+    c.id = id;
+    c.connected = t.track(id);
+    if (c.connected) memcpy(c.view, gVersions, sizeof(gVersions));   // full snapshot on connect
+    static const uint8_t kRates[] = { 0, 1, 1, 2, 4 };
+    c.drainPerTick = kRates[rnd() % 5];
+}
+
+// 32 simulated clients compete for the table, with stalled, slow and fast
+// readers, reconnections and a field change on most ticks. No client may be
+// sent a frame while its queue is full, and once updates stop and everyone
+// drains, every connected client must hold the latest value of every field.
+void test_stress_many_clients() {
+    const int kClients = 32;
+    const int kTicks = 20000;
+    static SimClient clients[kClients];
+    WsClientTable t;
+    memset(gVersions, 0, sizeof(gVersions));
+    uint32_t nextId = 1;
+    int rejected = 0, deltas = 0;
+    uint32_t coalesced = 0, catchups = 0;
+
+    for (int i = 0; i < kClients; ++i) {
+        connectClient(t, clients[i], nextId++);
+        if (!clients[i].connected) rejected++;
+    }
+    TEST_ASSERT_EQUAL(kClients - WS_MAX_TRACKED_CLIENTS, rejected);
+
+    for (int tick = 0; tick < kTicks + 200; ++tick) {
+        bool quiesce = tick >= kTicks;
+        uint32_t changed = 0;
+        if (!quiesce && rnd() % 4) {
+            changed = (1u << (rnd() % FIELDS)) | (rnd() % 3 ? 0 : 1u << (rnd() % FIELDS));
+            for (int b = 0; b < FIELDS; ++b) if (changed & (1u << b)) gVersions[b]++;
+            deltas++;
+        }
+        for (int i = 0; i < kClients; ++i) {
+            SimClient& c = clients[i];
+            if (!c.connected) continue;
+            WsSendPlan p = t.plan(c.id, changed, c.len >= QUEUE_CAP);
+            if (p.action == WS_SEND_SHARED) pushFrame(c, changed);
+            else if (p.action == WS_SEND_CATCHUP) { pushFrame(c, p.mask); catchups++; }
+            else if (p.action == WS_SEND_COALESCED) coalesced++;
+            // Bursty reader: 0..2x its mean rate each tick
+            drain(c, quiesce ? QUEUE_CAP : rnd() % (c.drainPerTick * 2 + 1));
+        }
+        // Churn: a client leaves, a new one tries to take a slot
+        if (!quiesce && rnd() % 50 == 0) {
+            SimClient& c = clients[rnd() % kClients];
+            if (c.connected) t.untrack(c.id);
+            connectClient(t, c, nextId++);
+        }
+        // Stalled readers wake up now and then
+        if (!quiesce && rnd() % 200 == 0) clients[rnd() % kClients].drainPerTick = 1 + rnd() % 3;
+    }
+
+    int connected = 0;
+    for (int i = 0; i < kClients; ++i) {
+        const SimClient& c = clients[i];
+        if (!c.connected) continue;
+        connected++;
+        TEST_ASSERT_LESS_OR_EQUAL(QUEUE_CAP, c.maxLen);
+        TEST_ASSERT_EQUAL_HEX32(0, t.pending(c.id));
+        TEST_ASSERT_EQUAL_UINT32_ARRAY(gVersions, c.view, FIELDS);
+    }
+    TEST_ASSERT_EQUAL(WS_MAX_TRACKED_CLIENTS, connected);
+    TEST_ASSERT_GREATER_THAN(0, coalesced);
+    TEST_ASSERT_GREATER_THAN(0, catchups);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%d deltas, %u coalesced, %u catch-up frames, %u ids",
+             deltas, (unsigned)coalesced, (unsigned)catchups, (unsigned)(nextId - 1));
+    TEST_MESSAGE(msg);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_track_limits);
+    RUN_TEST(test_plan_coalesces);
+    RUN_TEST(test_stress_many_clients);
+    return UNITY_END();
+}
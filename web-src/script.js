@@ -50,6 +50,10 @@ const translations = {
         reconfigWifi: 'Reconfigurer Wi‑Fi',
         factoryReset: 'Réinitialisation',
         uptime: 'Durée de fonctionnement',
+        liveChart: 'Graphique temps réel',
+        streamRate: 'Débit',
+        streamStart: 'Démarrer',
+        streamStop: 'Arrêter',
         // Calibration wizard
         step1Title: 'Step 1',
         step1Instruction: 'Laissez la balance vide puis appuyez sur le bouton',
@@ -120,6 +124,10 @@ const translations = {
         reconfigWifi: 'Reconfigure Wi‑Fi',
         factoryReset: 'Factory Reset',
         uptime: 'Uptime',
+        liveChart: 'Live chart',
+        streamRate: 'Rate',
+        streamStart: 'Start',
+        streamStop: 'Stop',
         // Calibration wizard
         step1Title: 'Step 1',
         step1Instruction: 'Leave the scale empty then press the button',
@@ -221,6 +229,8 @@ let currentWeight = null;
 let currentUid = null;
 let calFactor = null;
 let apiKey = '';
+let apiValid = false;
+let apiDisplayName = '';
 let cloudStatus = 'unknown';
 let apiStatus = 'none';
 
@@ -339,9 +349,10 @@ function updateApiKey() {
         body: JSON.stringify({ key: key })
     })
     .then(r => r.ok ? r.json() : Promise.reject(r.status))
+    .then(res => waitForJob(res.job))
     .then(res => {
-        const ok = !!res.success;
-        const name = (res.displayName || '').trim();
+        const ok = !!res.ok;
+        const name = (res.detail || '').trim();
         if (ok) {
             apiKey = key;
             setApiStatus('valid', name);
@@ -385,6 +396,52 @@ function deleteApiKey() {
       .finally(() => { if (delBtn) { delBtn.disabled = false; delBtn.textContent = t('delete'); } });
 }
 
+// ========== DEFERRED JOBS ==========
+// Slow actions answer 202 {"job":N}; the outcome arrives on the status socket
+// as {"type":"job","id":N,"state":"done"|"failed"}. Poll /api/job while the
+// socket is down.
+const pendingJobs = new Map();
+const finishedJobs = new Map(); // results that beat the 202 to the browser
+
+function settleJob(msg) {
+    if (msg.state !== 'done' && msg.state !== 'failed') return;
+    const job = pendingJobs.get(msg.id);
+    if (!job) {
+        finishedJobs.set(msg.id, msg);
+        if (finishedJobs.size > 8) finishedJobs.delete(finishedJobs.keys().next().value);
+        return;
+    }
+    pendingJobs.delete(msg.id);
+    clearInterval(job.poll);
+    clearTimeout(job.timer);
+    job.resolve(msg);
+}
+
+function waitForJob(id) {
+    if (!id) return Promise.reject('no job');
+    if (finishedJobs.has(id)) {
+        const msg = finishedJobs.get(id);
+        finishedJobs.delete(id);
+        return Promise.resolve(msg);
+    }
+    return new Promise((resolve, reject) => {
+        const job = { resolve };
+        job.poll = setInterval(() => {
+            if (statusSocket && statusSocket.readyState === WebSocket.OPEN) return;
+            fetch('/api/job?id=' + id, { cache: 'no-store' })
+                .then(r => r.ok ? r.json() : null)
+                .then(msg => { if (msg) settleJob(msg); })
+                .catch(() => {});
+        }, 1000);
+        job.timer = setTimeout(() => {
+            pendingJobs.delete(id);
+            clearInterval(job.poll);
+            reject('timeout');
+        }, 20000);
+        pendingJobs.set(id, job);
+    });
+}
+
 // ========== API KEY VISIBILITY TOGGLE ==========
 function toggleApiKeyVisibility() {
     const input = document.getElementById('newApiKey');
@@ -773,6 +830,15 @@ document.addEventListener('DOMContentLoaded', function() {
 });
 
 // ========== STATUS MANAGEMENT ==========
+let uptimeBaseSecs = null;
+let uptimeBaseAt = 0;
+
+function tickUptime() {
+    if (uptimeBaseSecs === null) return;
+    const secs = uptimeBaseSecs + (Date.now() - uptimeBaseAt) / 1000;
+    setTextIfChanged(document.getElementById('uptime'), formatHMS(secs));
+}
+
 function applyStatusSnapshot(s) {
     if (!s || typeof s !== 'object') return;
     
@@ -798,16 +864,18 @@ function applyStatusSnapshot(s) {
     
     // API Key
     const apiInput = document.getElementById('newApiKey');
-    if (apiInput && typeof s.apiKey === 'string' && apiKey !== s.apiKey) {
+    if (typeof s.apiKey === 'string' && apiKey !== s.apiKey) {
         apiKey = s.apiKey;
-        if (apiInput.value !== apiKey) apiInput.value = apiKey;
+        if (apiInput && apiInput.value !== apiKey) apiInput.value = apiKey;
     }
     
-    // API Status
-    if (typeof s.apiKey === 'string') {
-        const hasKey = s.apiKey.trim().length > 0;
-        const state = hasKey ? (s.apiValid ? 'valid' : 'invalid') : 'none';
-        setApiStatus(state, s.displayName || '');
+    // API Status (WebSocket deltas may carry only one of the three keys)
+    if (typeof s.apiKey === 'string' || typeof s.apiValid !== 'undefined' || typeof s.displayName === 'string') {
+        if (typeof s.apiValid !== 'undefined') apiValid = !!s.apiValid;
+        if (typeof s.displayName === 'string') apiDisplayName = s.displayName;
+        const hasKey = apiKey.trim().length > 0;
+        const state = hasKey ? (apiValid ? 'valid' : 'invalid') : 'none';
+        setApiStatus(state, apiDisplayName);
     }
     
     // Calibration factor
@@ -818,11 +886,12 @@ function applyStatusSnapshot(s) {
         calFactor = n;
     }
     
-    // Uptime
+    // Uptime (the WebSocket only refreshes it on keepalives; tickUptime() fills the gaps)
     if (typeof s.uptime_s !== 'undefined' || typeof s.uptime_ms !== 'undefined') {
         let secs = (typeof s.uptime_s !== 'undefined') ? Number(s.uptime_s) : Number(s.uptime_ms) / 1000;
-        const upEl = document.getElementById('uptime');
-        setTextIfChanged(upEl, formatHMS(secs));
+        uptimeBaseSecs = secs;
+        uptimeBaseAt = Date.now();
+        tickUptime();
     }
     
     // Send to cloud status
@@ -851,6 +920,203 @@ function pollStatus() {
     .catch(() => {});
 }
 
+// ========== LIVE STATUS (WebSocket first, HTTP polling as fallback) ==========
+// The firmware sends a full snapshot on connect, then only the changed fields.
+let statusSocket = null;
+let pollTimer = null;
+let wsRetryMs = 1000;
+
+function startPolling() {
+    if (pollTimer) return;
+    pollStatus();
+    pollTimer = setInterval(pollStatus, 1000);
+}
+
+function stopPolling() {
+    if (!pollTimer) return;
+    clearInterval(pollTimer);
+    pollTimer = null;
+}
+
+function handleSocketMessage(ev) {
+    let msg;
+    try { msg = JSON.parse(ev.data); } catch (_) { return; }
+    if (!msg || typeof msg !== 'object') return;
+    if (msg.type === 'apiStatus') {
+        applyStatusSnapshot({ apiValid: !!msg.valid, displayName: msg.displayName || apiDisplayName });
+        return;
+    }
+    if (msg.type === 'job') { settleJob(msg); return; }
+    if (msg.type) return; // request/response messages handled elsewhere
+    applyStatusSnapshot(msg);
+}
+
+function connectStatusSocket() {
+    if (!('WebSocket' in window)) { startPolling(); return; }
+    const proto = location.protocol === 'https:' ? 'wss://' : 'ws://';
+    let sock;
+    try { sock = new WebSocket(proto + location.host + '/ws'); }
+    catch (_) { startPolling(); return; }
+    statusSocket = sock;
+
+    // If the socket does not open quickly, keep the UI alive over HTTP meanwhile
+    const openTimeout = setTimeout(startPolling, 3000);
+
+    sock.onopen = () => {
+        clearTimeout(openTimeout);
+        wsRetryMs = 1000;
+        stopPolling();
+    };
+    sock.onmessage = handleSocketMessage;
+    sock.onclose = () => {
+        clearTimeout(openTimeout);
+        if (statusSocket === sock) statusSocket = null;
+        startPolling();
+        setTimeout(connectStatusSocket, wsRetryMs);
+        wsRetryMs = Math.min(wsRetryMs * 2, 30000);
+    };
+    sock.onerror = () => sock.close();
+}
+
+// ========== LIVE CHART (binary /ws/stream) ==========
+// Frame: 8-byte header (version, count, sampleSize, firstSeq) then `count`
+// samples of `sampleSize` bytes (t_us u32, raw i32, filtered f32, flags u8).
+const CHART_WINDOW_US = 10e6;
+const CHART_CAPACITY = 2048;
+const STREAM_FLAG_GAP = 8;
+const chartT = new Uint32Array(CHART_CAPACITY);
+const chartW = new Float32Array(CHART_CAPACITY);
+const chartF = new Uint8Array(CHART_CAPACITY);
+let chartHead = 0;
+let chartLen = 0;
+let chartDirty = false;
+let streamSocket = null;
+let streamExpectSeq = null;
+let streamFrames = 0;
+let streamSamples = 0;
+let streamRateAt = 0;
+
+function onStreamFrame(ev) {
+    if (!(ev.data instanceof ArrayBuffer) || ev.data.byteLength < 8) return;
+    const dv = new DataView(ev.data);
+    if (dv.getUint8(0) !== 1) return;
+    const count = dv.getUint8(1);
+    const size = dv.getUint16(2, true);
+    const seq = dv.getUint32(4, true);
+    if (size < 13 || 8 + count * size > ev.data.byteLength) return;
+    const lost = streamExpectSeq !== null && seq !== streamExpectSeq;
+    streamExpectSeq = (seq + count) >>> 0;
+
+    for (let i = 0; i < count; i++) {
+        const o = 8 + i * size;
+        chartT[chartHead] = dv.getUint32(o, true);
+        chartW[chartHead] = dv.getFloat32(o + 8, true);
+        chartF[chartHead] = dv.getUint8(o + 12) | (lost && i === 0 ? STREAM_FLAG_GAP : 0);
+        chartHead = (chartHead + 1) % CHART_CAPACITY;
+        if (chartLen < CHART_CAPACITY) chartLen++;
+    }
+    streamFrames++;
+    streamSamples += count;
+    if (!chartDirty) {
+        chartDirty = true;
+        requestAnimationFrame(drawChart);
+    }
+}
+
+// One min/max pair per pixel column: cost is bounded by the canvas width,
+// not by the sample rate.
+function drawChart() {
+    chartDirty = false;
+    const canvas = document.getElementById('liveChart');
+    if (!canvas || chartLen === 0) return;
+    const ctx = canvas.getContext('2d');
+    const w = canvas.width, h = canvas.height;
+    const last = (chartHead + CHART_CAPACITY - 1) % CHART_CAPACITY;
+    const tEnd = chartT[last];
+    const colMin = new Float32Array(w).fill(Infinity);
+    const colMax = new Float32Array(w).fill(-Infinity);
+    const colGap = new Uint8Array(w);
+    let lo = Infinity, hi = -Infinity;
+
+    for (let n = 0; n < chartLen; n++) {
+        const i = (last + CHART_CAPACITY - n) % CHART_CAPACITY;
+        const age = (tEnd - chartT[i]) >>> 0; // micros() wraps every ~71 min
+        if (age > CHART_WINDOW_US) break;
+        const x = Math.min(w - 1, Math.floor((1 - age / CHART_WINDOW_US) * (w - 1)));
+        const v = chartW[i];
+        if (v < colMin[x]) colMin[x] = v;
+        if (v > colMax[x]) colMax[x] = v;
+        if (chartF[i] & STREAM_FLAG_GAP) colGap[x] = 1;
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+    }
+    if (hi - lo < 2) { const mid = (hi + lo) / 2; lo = mid - 1; hi = mid + 1; }
+    const pad = (hi - lo) * 0.1;
+    lo -= pad; hi += pad;
+    const y = v => h - ((v - lo) / (hi - lo)) * h;
+
+    ctx.clearRect(0, 0, w, h);
+    ctx.fillStyle = '#fc8181';
+    for (let x = 0; x < w; x++) if (colGap[x]) ctx.fillRect(x, 0, 1, h);
+    ctx.strokeStyle = '#667eea';
+    ctx.beginPath();
+    for (let x = 0; x < w; x++) {
+        if (colMin[x] === Infinity) continue;
+        ctx.moveTo(x + 0.5, y(colMax[x]));
+        ctx.lineTo(x + 0.5, y(colMin[x]) + 1);
+    }
+    ctx.stroke();
+    ctx.fillStyle = '#718096';
+    ctx.font = '11px sans-serif';
+    ctx.fillText(hi.toFixed(1) + ' g', 4, 12);
+    ctx.fillText(lo.toFixed(1) + ' g', 4, h - 4);
+}
+
+function updateStreamRate() {
+    const now = performance.now();
+    if (!streamSocket) return;
+    const secs = (now - streamRateAt) / 1000;
+    if (secs <= 0) return;
+    setTextIfChanged(document.getElementById('streamRate'),
+        (streamSamples / secs).toFixed(0) + ' Hz · ' + (streamFrames / secs).toFixed(1) + ' fps');
+    streamFrames = 0;
+    streamSamples = 0;
+    streamRateAt = now;
+}
+
+function setStreamButton(running) {
+    const btn = document.getElementById('streamBtn');
+    if (!btn) return;
+    btn.dataset.i18n = running ? 'streamStop' : 'streamStart';
+    btn.textContent = t(btn.dataset.i18n);
+}
+
+function toggleLiveStream() {
+    if (streamSocket) {
+        const sock = streamSocket;
+        streamSocket = null;
+        sock.close();
+        setStreamButton(false);
+        setTextIfChanged(document.getElementById('streamRate'), '--');
+        return;
+    }
+    const proto = location.protocol === 'https:' ? 'wss://' : 'ws://';
+    const sock = new WebSocket(proto + location.host + '/ws/stream');
+    sock.binaryType = 'arraybuffer';
+    sock.onmessage = onStreamFrame;
+    sock.onclose = () => {
+        if (streamSocket !== sock) return;
+        streamSocket = null;
+        setStreamButton(false);
+    };
+    streamSocket = sock;
+    streamExpectSeq = null;
+    streamFrames = 0;
+    streamSamples = 0;
+    streamRateAt = performance.now();
+    setStreamButton(true);
+}
+
 // ========== INITIALIZATION ==========
 window.onload = () => {
     // Set language
@@ -859,9 +1125,10 @@ window.onload = () => {
     // Initial weight display
     setTextIfChanged(weightEl, '…');
     
-    // Start polling
-    pollStatus();
-    setInterval(pollStatus, 1000);
+    // Live status over WebSocket (falls back to polling /api/status)
+    connectStatusSocket();
+    setInterval(tickUptime, 1000);
+    setInterval(updateStreamRate, 1000);
     
     // Register Service Worker for PWA
     if ('serviceWorker' in navigator) {
@@ -1,63 +1,91 @@
-const CACHE_NAME = 'tigertag-scale-v1';
-const urlsToCache = [
-  '/',
-  '/index.html',
-  '/favicon.png',
-  '/favicon.ico',
-  '/manifest.json'
-];
-
-// Install Service Worker
+// Service worker TigerTag Scale : coquille de l'application servie depuis le cache
+//
+// scripts/build_web.py remplace CACHE_VERSION et PRECACHE_URLS à chaque build
+// (hash du contenu + noms hashés des CSS/JS) : une nouvelle UI = un nouveau
+// sw.js = un nouveau cache, l'ancien est supprimé à l'activation.
+const CACHE_VERSION = 'dev';
+// The shell: the install fails (and is retried later) unless all of it is fetched
+const PRECACHE_URLS = ['/'];
+// Icons, manifest: cached when available, never a reason to fail the install
+const PRECACHE_OPTIONAL = ['/manifest.json', '/favicon.png'];
+const CACHE_NAME = 'tigertag-scale-' + CACHE_VERSION;
+const CACHE_PREFIX = 'tigertag-scale-';
+
+// Noms produits par build_web.py : "script.1a2b3c4d.js" ne change jamais de contenu
+const HASHED_URL = /\.[0-9a-f]{8}\.[a-z0-9]+$/;
+
+// Install: precache the app shell (bypass the HTTP cache to get this build's files)
 self.addEventListener('install', event => {
   event.waitUntil(
     caches.open(CACHE_NAME)
-      .then(cache => cache.addAll(urlsToCache))
-      .catch(err => console.log('Cache failed:', err))
+      .then(cache => cache.addAll(PRECACHE_URLS.map(url => new Request(url, { cache: 'reload' })))
+        .then(() => Promise.all(PRECACHE_OPTIONAL.map(url =>
+          cache.add(new Request(url, { cache: 'reload' })).catch(err => console.log('Precache skipped:', url, err))))))
+      .then(() => self.skipWaiting())
+      .catch(err => {
+        // Fail the install: the previous worker stays active and the browser retries later
+        console.log('Precache failed:', err);
+        throw err;
+      })
   );
-  self.skipWaiting();
 });
 
-// Activate Service Worker
+// Activate: drop the caches of previous builds, take control of open pages
 self.addEventListener('activate', event => {
   event.waitUntil(
-    caches.keys().then(cacheNames => {
-      return Promise.all(
-        cacheNames.map(cacheName => {
-          if (cacheName !== CACHE_NAME) {
-            return caches.delete(cacheName);
-          }
-        })
-      );
-    })
+    caches.keys()
+      .then(names => Promise.all(
+        names
+          .filter(name => name.startsWith(CACHE_PREFIX) && name !== CACHE_NAME)
+          .map(name => caches.delete(name))
+      ))
+      .then(() => self.clients.claim())
   );
-  self.clients.claim();
 });
 
-// Fetch strategy: Network first, fallback to cache
+function isNetworkOnly(url) {
+  return url.pathname.startsWith('/api/') ||
+         url.pathname.startsWith('/ws') ||
+         url.pathname.startsWith('/apikeydelete') ||
+         url.pathname === '/metrics';
+}
+
+// Only the UI itself is answered with the cached shell; other pages opened
+// in a tab (/metrics, plain-text endpoints, 404s) must reach the device
+function isShellNavigation(request, url) {
+  return request.mode === 'navigate' && (url.pathname === '/' || url.pathname === '/index.html');
+}
+
+function putIfOk(request, response) {
+  if (!response || !response.ok || response.type !== 'basic') return response;
+  const copy = response.clone();
+  caches.open(CACHE_NAME).then(cache => cache.put(request, copy));
+  return response;
+}
+
+// Fetch strategy: cache first, revalidate in the background
 self.addEventListener('fetch', event => {
-  // Skip API calls - always fetch from network
-  if (event.request.url.includes('/api/') || 
-      event.request.url.includes('/apikeydelete')) {
-    return;
-  }
-  
+  const request = event.request;
+  if (request.method !== 'GET') return;
+
+  const url = new URL(request.url);
+  // Other origins (TigerTag cloud) and live data always go to the network
+  if (url.origin !== self.location.origin || isNetworkOnly(url)) return;
+
+  const shell = isShellNavigation(request, url);
+  if (request.mode === 'navigate' && !shell) return;
+  const key = shell ? '/' : request;
+
   event.respondWith(
-    fetch(event.request)
-      .then(response => {
-        // Clone the response
-        const responseToCache = response.clone();
-        
-        // Cache the fetched response
-        caches.open(CACHE_NAME)
-          .then(cache => {
-            cache.put(event.request, responseToCache);
-          });
-        
-        return response;
-      })
-      .catch(() => {
-        // If network fails, try cache
-        return caches.match(event.request);
-      })
+    caches.match(key, { ignoreSearch: shell }).then(cached => {
+      const refresh = () => fetch(request).then(response => putIfOk(key, response));
+
+      if (!cached) return refresh();
+      // Hashed files are immutable: nothing to revalidate
+      if (!HASHED_URL.test(url.pathname)) {
+        event.waitUntil(refresh().catch(() => {}));
+      }
+      return cached;
+    })
   );
-});
\ No newline at end of file
+});